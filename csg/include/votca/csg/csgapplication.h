@@ -18,8 +18,15 @@
 #ifndef VOTCA_CSG_CSGAPPLICATION_H
 #define VOTCA_CSG_CSGAPPLICATION_H
 
-// VOTCA includes
+// Standard includes
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <thread>
+
+// VOTCA includes
 #include <votca/tools/application.h>
 #include <votca/tools/mutex.h>
 #include <votca/tools/thread.h>
@@ -36,7 +43,7 @@ namespace csg {
 class CsgApplication : public tools::Application {
  public:
   CsgApplication() = default;
-  ~CsgApplication() override = default;
+  ~CsgApplication() override;
 
   void Initialize() override;
   bool EvaluateOptions() override;
@@ -119,6 +126,17 @@ class CsgApplication : public tools::Application {
     std::unique_ptr<TopologyMap> map_;
     Index id_ = -1;
 
+    /// own reader of the trajectory if the frames are partitioned between
+    /// the workers, the master uses the reader of the application
+    std::unique_ptr<TrajectoryReader> traj_reader_;
+    /// next frame of the partition, the partition ends at frame_end_
+    Index frame_ = 0;
+    Index frame_end_ = 0;
+    Index frame_stride_ = 1;
+    bool reader_started_ = false;
+    /// reading failed, the frame only takes its turn in the ordered merge
+    bool skip_merge_ = false;
+
     void Run(void) override;
 
     void setApplication(CsgApplication *app) { app_ = app; }
@@ -129,9 +147,17 @@ class CsgApplication : public tools::Application {
   };
 
   /**
-   * \brief Gets frames from TrajectoryReader in an ordered way and, if
+   * \brief Gets frames from the read-ahead queue in an ordered way and, if
    * successful, calls Worker::EvalConfiguration for that frame.
    *
+   * In threaded runs the frames are decoded by a separate reader thread into
+   * a bounded pool of at most four topologies, a worker only copies the frame
+   * data into its own topology, so parsing and analysis overlap. If the
+   * trajectory reader is seekable and --partition-frames is given, every
+   * worker instead reads its own partition of the frames with its own reader
+   * and no input lock is needed.
+   * Without threads the master reads the frames itself.
+   *
    * @param worker
    * @return True if frames left for calculation, else False
    */
@@ -157,14 +183,56 @@ class CsgApplication : public tools::Application {
   Index nframes_;
   bool is_first_frame_;
   Index nthreads_;
-  tools::Mutex nframesMutex_;
-  tools::Mutex traj_readerMutex_;
 
   /// \brief stores Mutexes used to impose order for input
   std::vector<std::unique_ptr<tools::Mutex>> threadsMutexesIn_;
   /// \brief stores Mutexes used to impose order for output
   std::vector<std::unique_ptr<tools::Mutex>> threadsMutexesOut_;
   std::unique_ptr<TrajectoryReader> traj_reader_;
+
+  /// \brief reads up to nframes frames (-1 for all) into the frame pool
+  void ReadFrames(Index nframes);
+  /// \brief blocks until a frame was read, returns its slot in the pool or
+  /// -1 if the trajectory is exhausted
+  Index PopFrame();
+  /// \brief hands a slot back to the reader
+  void ReleaseFrame(Index slot);
+  /// \brief stops and joins the reader thread
+  void StopReading();
+  /// \brief reads the next frame into the topology of the master if there
+  /// is no read-ahead thread
+  bool ReadNextFrame(Worker *worker);
+
+  /// \brief assigns the frames from first on to the workers, if threads are
+  /// synchronized round robin like the ordered input, else in contiguous
+  /// blocks
+  void PartitionFrames(Index first);
+  /// \brief reads the next frame of the partition of worker, returns false
+  /// if the partition is done. After reading failed in any worker, the
+  /// remaining frames are marked as skipped if threads are synchronized, else
+  /// false is returned
+  bool ReadPartitionFrame(Worker *worker);
+
+  /// every worker reads its own frames, no read-ahead thread
+  bool partitioned_ = false;
+  /// frames are decoded by the reader thread into the frame pool
+  bool read_ahead_ = false;
+  /// frames the master still has to read without read-ahead, -1 for all
+  Index frames_to_read_ = -1;
+
+  /// topologies the reader thread decodes frames into, each slot is a
+  /// complete copy of the topology (read with the topology reader), so the
+  /// pool is capped independently of the number of workers
+  std::vector<std::unique_ptr<Topology>> frame_pool_;
+  static constexpr Index max_frame_pool_size_ = 4;
+  std::deque<Index> free_frames_;
+  std::deque<Index> ready_frames_;
+  bool reading_done_ = false;
+  std::mutex frames_mutex_;
+  std::condition_variable frame_free_;
+  std::condition_variable frame_ready_;
+  std::exception_ptr reader_error_;
+  std::thread reader_thread_;
 };
 
 inline void CsgApplication::AddObserver(CGObserver *observer) {
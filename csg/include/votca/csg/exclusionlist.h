@@ -22,6 +22,7 @@
 #include <iostream>
 #include <list>
 #include <map>
+#include <vector>
 
 // Local VOTCA includes
 #include "bead.h"
@@ -64,6 +65,16 @@ class ExclusionList {
 
   bool IsExcluded(Bead *bead1, Bead *bead2) const;
 
+  /**
+   * \brief build the query index used by IsExcluded
+   *
+   * Stores the excluded partners with higher id of every bead as sorted ids
+   * in a CSR layout. The leading run of consecutive ids (the neighbours along
+   * a chain) is checked with a single comparison. Any later modification of
+   * the list invalidates the index until it is rebuilt.
+   */
+  void BuildIndex();
+
   template <typename iterable>
   void InsertExclusion(Bead *bead, iterable &excluded);
 
@@ -75,6 +86,13 @@ class ExclusionList {
   std::list<exclusion_t *> exclusions_;
   std::map<Bead *, exclusion_t *> excl_by_bead_;
 
+  bool index_valid_ = false;
+  /// length of the run id+1, id+2, ... at the start of the exclusions of id
+  std::vector<Index> run_;
+  /// exclusions of id are excl_ids_[excl_begin_[id]...excl_begin_[id+1]]
+  std::vector<Index> excl_begin_;
+  std::vector<Index> excl_ids_;
+
   friend std::ostream &operator<<(std::ostream &out, ExclusionList &exl);
 };
 
@@ -123,6 +141,7 @@ inline void ExclusionList::InsertExclusion(Bead *beadA, iterable &l) {
       excl_by_bead_[bead1] = e;
     }
     e->exclude_.push_back(bead2);
+    index_valid_ = false;
   }
 }
 
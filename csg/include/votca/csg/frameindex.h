@@ -0,0 +1,79 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef VOTCA_CSG_FRAMEINDEX_H
+#define VOTCA_CSG_FRAMEINDEX_H
+
+// Standard includes
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+// VOTCA includes
+#include <votca/tools/types.h>
+
+namespace votca {
+namespace csg {
+
+/**
+ * \brief byte offsets of the frames in a text trajectory
+ *
+ * The offsets are found once by a format specific scan function. On request
+ * they are stored in a sidecar file next to the trajectory (trajectory name +
+ * ".offsets"), an existing sidecar is always used. The sidecar records size
+ * and modification time of the trajectory and the format, an outdated
+ * sidecar is ignored. If the sidecar can not be written the index is only
+ * kept in memory.
+ */
+class FrameIndex {
+ public:
+  /// appends the offset of every frame start in the stream to offsets
+  using ScanFunction =
+      std::function<void(std::istream &, std::vector<std::int64_t> &)>;
+
+  /// load the sidecar of file or build the index with scan, save_sidecar
+  /// writes a newly built index to the sidecar
+  void Build(const std::string &file, const std::string &format,
+             const ScanFunction &scan, bool save_sidecar);
+
+  bool empty() const { return offsets_.empty(); }
+  Index size() const { return Index(offsets_.size()); }
+  std::int64_t Offset(Index frame) const { return offsets_[frame]; }
+
+  static std::string SidecarName(const std::string &file) {
+    return file + ".offsets";
+  }
+
+  /// reads the next line and adds its length including the newline to offset
+  static bool SkipLine(std::istream &in, std::string &line,
+                       std::int64_t &offset);
+
+ private:
+  bool Load(const std::string &sidecar, const std::string &format,
+            std::int64_t file_size, std::int64_t file_time);
+  void Save(const std::string &sidecar, const std::string &format,
+            std::int64_t file_size, std::int64_t file_time) const;
+
+  std::vector<std::int64_t> offsets_;
+};
+
+}  // namespace csg
+}  // namespace votca
+
+#endif  // VOTCA_CSG_FRAMEINDEX_H
@@ -18,6 +18,13 @@
 #ifndef VOTCA_CSG_NBLIST_H
 #define VOTCA_CSG_NBLIST_H
 
+// Standard includes
+#include <functional>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 // Local VOTCA includes
 #include "beadlist.h"
 #include "beadpair.h"
@@ -36,6 +43,13 @@ namespace TOOLS = votca::tools;
  * get every pair listed once, the SetMatchFunction can be used and always
  * return that the pair is not stored.
  *
+ * If a skin is set, the list works as a Verlet list: all pairs within
+ * cutoff + skin are kept as candidates and reused in later calls to Generate
+ * until a bead moved more than half the skin. A changing box (NPT) uses up
+ * part of the skin, the candidates are only rebuilt once the deformation and
+ * the displacements together exceed it. Generate does not clear
+ * previously found pairs, so a list reused over several frames has to be
+ * cleared with Cleanup() before each call.
  */
 class NBList : public PairList<Bead *, BeadPair> {
  public:
@@ -46,15 +60,26 @@ class NBList : public PairList<Bead *, BeadPair> {
   virtual void Generate(BeadList &list1, BeadList &list2,
                         bool do_exclusions = true);
   /// Generate the neighbour list based on a single bead list
-  virtual void Generate(BeadList &list, bool do_exclusions = true) {
-    Generate(list, list, do_exclusions);
-  }
+  virtual void Generate(BeadList &list, bool do_exclusions = true);
 
   /// set the cutoff for the neighbour search
-  void setCutoff(double cutoff) { cutoff_ = cutoff; }
+  void setCutoff(double cutoff) {
+    cutoff_ = cutoff;
+    ref_beads_.clear();
+  }
   /// get the cutoff for the neighbour search
   double getCutoff() const { return cutoff_; }
 
+  /// set the Verlet skin, 0 disables the reuse of candidate pairs
+  void setSkin(double skin) {
+    skin_ = skin;
+    ref_beads_.clear();
+  }
+  /// get the Verlet skin
+  double getSkin() const { return skin_; }
+  /// number of times the Verlet candidate list was built
+  Index getRebuildCount() const { return rebuilds_; }
+
   /**
    *  \brief match function for class member functions
    *
@@ -63,11 +88,8 @@ class NBList : public PairList<Bead *, BeadPair> {
    * two beads and the distance vector as argument. If a pair should be added,
    * the function should return true, otherwise false.
    *
-   * This function can also be used, in a situation where each pair needs only
-   * to be processed once, but the total number of pairs is to big to be stored
-   * in memory, e.g. to calculate rdf for huge systems. In this case, set a
-   * match function which always returns false (->no pair is added), and do
-   * the processing in the match function.
+   * If each pair needs only to be processed once, e.g. to calculate the rdf
+   * of huge systems, use ForEachPair instead.
    */
   template <typename T>
   void SetMatchFunction(T *object,
@@ -87,20 +109,143 @@ class NBList : public PairList<Bead *, BeadPair> {
   template <typename pair_type>
   void setPairType();
 
+  /**
+   * \brief visit all pairs without storing them
+   *
+   * Calls visitor(bead1, bead2, r, dist) for every pair within the cutoff,
+   * the match function is not used. No pairs are created or stored, so the
+   * memory stays constant also for huge systems. The search collects the
+   * pairs in a small buffer of fixed size, which is handed over to a loop
+   * over the buffer compiled for the visitor, so the visitor is inlined and
+   * the indirect call is paid once per buffer instead of once per pair.
+   * Like Generate, overlapping lists visit a pair of beads found in both
+   * lists only once.
+   */
+  template <typename Visitor>
+  void ForEachPair(BeadList &list1, BeadList &list2, Visitor &&visitor,
+                   bool do_exclusions = true);
+  /// \brief visit all pairs of a single bead list without storing them
+  template <typename Visitor>
+  void ForEachPair(BeadList &list, Visitor &&visitor,
+                   bool do_exclusions = true);
+
  protected:
   /// cutoff
   double cutoff_;
   /// take into account exclusions from topolgoy
   bool do_exclusions_;
 
-  /// policy function to create new bead types
+  /// search all pairs of list1 and list2 closer than radius and pass them
+  /// to ProcessPair
+  virtual void Search(BeadList &list1, BeadList &list2, double radius);
+  /// search all pairs of list closer than radius and pass them to ProcessPair
+  virtual void Search(BeadList &list, double radius) {
+    Search(list, list, radius);
+  }
+
+  /// apply exclusions and either store the pair as Verlet candidate or
+  /// accept it
+  void ProcessPair(const Topology &top, Bead *bead1, Bead *bead2,
+                   const Eigen::Vector3d &r, double dist);
+  /// store the pair as Verlet candidate or accept it, exclusions have
+  /// already been applied
+  void StorePair(Bead *bead1, Bead *bead2, const Eigen::Vector3d &r,
+                 double dist) {
+    if (collect_candidates_) {
+      candidates_.emplace_back(bead1, bead2);
+      return;
+    }
+    AcceptPair(bead1, bead2, r, dist);
+  }
+  /// pass the pair to the visitor or store it if the match function agrees
+  void AcceptPair(Bead *bead1, Bead *bead2, const Eigen::Vector3d &r,
+                  double dist) {
+    if (pair_visitor_ != nullptr) {
+      if (!FirstVisit(bead1, bead2)) {
+        return;
+      }
+      visit_buffer_.push_back({bead1, bead2, r, dist});
+      if (Index(visit_buffer_.size()) == visit_buffer_size_) {
+        FlushVisitor();
+      }
+    } else if ((*match_function_)(bead1, bead2, r, dist)) {
+      InsertPair(pair_creator_(arena_, bead1, bead2, r));
+    }
+  }
+
+  struct visited_pair_t {
+    Bead *bead1_;
+    Bead *bead2_;
+    Eigen::Vector3d r_;
+    double dist_;
+  };
+  static constexpr Index visit_buffer_size_ = 1024;
+  std::vector<visited_pair_t> visit_buffer_;
+
+  using pair_visitor_t = void (*)(void *, const visited_pair_t *, Index);
+  /// type erased visitor of ForEachPair, nullptr while generating a list
+  pair_visitor_t pair_visitor_ = nullptr;
+  void *visitor_context_ = nullptr;
+
+  void FlushVisitor() {
+    pair_visitor_(visitor_context_, visit_buffer_.data(),
+                  Index(visit_buffer_.size()));
+    visit_buffer_.clear();
+  }
+
+  /// runs search with the visitor set and resets it also if search throws
+  template <typename Visitor, typename SearchFunction>
+  void VisitPairs(Visitor &visitor, SearchFunction &&search);
+  void ResetVisitor();
+
+  /// hash of a pair of beads, used to drop the pairs overlapping lists yield
+  /// twice
+  struct bead_pair_hash {
+    std::size_t operator()(const std::pair<Bead *, Bead *> &p) const {
+      std::size_t h1 = std::hash<Bead *>()(p.first);
+      std::size_t h2 = std::hash<Bead *>()(p.second);
+      return h1 ^ (h2 + 0x9e3779b97f4a7c15ULL + (h1 << 6) + (h1 >> 2));
+    }
+  };
+  /// beads in both lists of ForEachPair, only their pairs can be found twice
+  std::unordered_set<Bead *> shared_beads_;
+  std::unordered_set<std::pair<Bead *, Bead *>, bead_pair_hash> visited_shared_;
+  void FindSharedBeads(BeadList &list1, BeadList &list2);
+  bool FirstVisit(Bead *bead1, Bead *bead2) {
+    if (shared_beads_.empty() || shared_beads_.count(bead1) == 0 ||
+        shared_beads_.count(bead2) == 0) {
+      return true;
+    }
+    return visited_shared_.insert(std::minmax(bead1, bead2)).second;
+  }
+
+  /// Verlet skin
+  double skin_ = 0.0;
+  /// true while the search collects Verlet candidates
+  bool collect_candidates_ = false;
+  std::vector<std::pair<Bead *, Bead *>> candidates_;
+  /// beads, positions and box the candidates were built for
+  std::vector<Bead *> ref_beads_;
+  std::vector<Eigen::Vector3d> ref_pos_;
+  Eigen::Matrix3d ref_box_;
+  bool ref_exclusions_ = false;
+  Index rebuilds_ = 0;
+
+  void GenerateVerlet(BeadList &list1, BeadList &list2);
+  void RemoveDuplicateCandidates();
+  bool CandidatesOutdated(const Topology &top, BeadList &list1,
+                          BeadList &list2) const;
+
+  /// policy function to create new bead types, they are owned by the arena
   template <typename pair_type>
-  static BeadPair *beadpair_create_policy(Bead *bead1, Bead *bead2,
+  static BeadPair *beadpair_create_policy(PairArena &arena, Bead *bead1,
+                                          Bead *bead2,
                                           const Eigen::Vector3d &r) {
-    return dynamic_cast<BeadPair *>(new pair_type(bead1, bead2, r));
+    return arena.Create<pair_type>(bead1, bead2, r);
   }
 
-  using pair_creator_t = BeadPair *(*)(Bead *, Bead *, const Eigen::Vector3d &);
+  using pair_creator_t = BeadPair *(*)(PairArena &, Bead *, Bead *,
+                                       const Eigen::Vector3d &);
   /// the current bead pair creator function
   pair_creator_t pair_creator_;
 
@@ -156,6 +301,43 @@ void NBList::setPairType() {
   pair_creator_ = NBList::beadpair_create_policy<pair_type>;
 }
 
+template <typename Visitor, typename SearchFunction>
+inline void NBList::VisitPairs(Visitor &visitor, SearchFunction &&search) {
+  pair_visitor_ = [](void *context, const visited_pair_t *pairs, Index n) {
+    Visitor &v = *static_cast<Visitor *>(context);
+    for (Index i = 0; i < n; ++i) {
+      v(pairs[i].bead1_, pairs[i].bead2_, pairs[i].r_, pairs[i].dist_);
+    }
+  };
+  visitor_context_ =
+      const_cast<void *>(static_cast<const void *>(std::addressof(visitor)));
+  visit_buffer_.clear();
+  visit_buffer_.reserve(visit_buffer_size_);
+  try {
+    search();
+    FlushVisitor();
+  } catch (...) {
+    ResetVisitor();
+    throw;
+  }
+  ResetVisitor();
+}
+
+template <typename Visitor>
+inline void NBList::ForEachPair(BeadList &list1, BeadList &list2,
+                                Visitor &&visitor, bool do_exclusions) {
+  if (&list1 != &list2) {
+    FindSharedBeads(list1, list2);
+  }
+  VisitPairs(visitor, [&]() { Generate(list1, list2, do_exclusions); });
+}
+
+template <typename Visitor>
+inline void NBList::ForEachPair(BeadList &list, Visitor &&visitor,
+                                bool do_exclusions) {
+  VisitPairs(visitor, [&]() { Generate(list, do_exclusions); });
+}
+
 template <typename T>
 inline void NBList::SetMatchFunction(T *object,
                                      bool (T::*fkt)(Bead *, Bead *,
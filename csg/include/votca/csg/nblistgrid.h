@@ -1,5 +1,5 @@
 /*
- * Copyright 2009-2019 The VOTCA Development Team (http://www.votca.org)
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -19,6 +19,8 @@
 #define VOTCA_CSG_NBLISTGRID_H
 
 // Standard includes
+#include <algorithm>
+#include <memory>
 #include <vector>
 
 // VOTCA includes
@@ -26,36 +28,132 @@
 
 // Local VOTCA includes
 #include "nblist.h"
-#include "votca/tools/NDimVector.h"
+#include "parallelfor.h"
 
 namespace votca {
 namespace csg {
 
+/**
+ * \brief Cell list based neighbour search
+ *
+ * The beads are binned into cells which are at least as large as the cutoff.
+ * Positions are stored cell-sorted in contiguous arrays (structure of arrays),
+ * so the distance kernel streams through memory instead of following bead
+ * pointers. For a single bead list only a half-shell of neighbouring cells is
+ * visited, hence every pair is tested exactly once. For orthorhombic boxes
+ * the minimum image convention is evaluated inline, triclinic boxes fall
+ * back to Topology::BCShortestConnection.
+ *
+ * With more than one thread the binning is split into chunks of the bead
+ * list and the search into slabs of consecutive cells. Each thread collects
+ * the pairs of its slab in its own buffer, the buffers are merged in slab
+ * order afterwards, so the resulting list is identical to the serial one.
+ * The match function is always called from the calling thread. The threads
+ * are started once and reused for every list. ForEachPair always searches
+ * in the calling thread, so the visited pairs are never buffered.
+ */
 class NBListGrid : public NBList {
  public:
-  void Generate(BeadList &list1, BeadList &list2,
-                bool do_exclusions = true) override;
-  void Generate(BeadList &list, bool do_exclusions = true) override;
+  /// number of threads used to build a single list
+  void setNumberOfThreads(Index nthreads) {
+    nthreads_ = std::max(nthreads, Index(1));
+    team_ = (nthreads_ > 1) ? std::make_unique<ThreadTeam>(nthreads_) : nullptr;
+  }
+  Index getNumberOfThreads() const { return nthreads_; }
 
  protected:
-  struct cell_t {
-    BeadList beads_;
-    std::vector<cell_t *> neighbours_;
-  };
+  void Search(BeadList &list1, BeadList &list2, double radius) override;
+  void Search(BeadList &list, double radius) override;
+
+  Index nthreads_ = 1;
+  std::unique_ptr<ThreadTeam> team_;
 
-  Eigen::Vector3d box_a_, box_b_, box_c_;
   Eigen::Vector3d norm_a_, norm_b_, norm_c_;
   Index box_Na_, box_Nb_, box_Nc_;
+  /// squared search radius
+  double radius2_;
+
+  /// true if the minimum image can be computed from the box diagonal
+  bool orthorhombic_ = false;
+  Eigen::Array3d box_diag_;
+  Eigen::Array3d inv_box_diag_;
+
+  /// unique neighbouring cells (excluding the cell itself) in CSR layout
+  std::vector<Index> neighbour_begin_;
+  std::vector<Index> neighbours_;
+
+  /// first entry of each cell in the cell-sorted arrays, size ncells+1
+  std::vector<Index> cell_begin_;
+  /// cell-sorted beads, their position in the input list and coordinates
+  std::vector<Bead *> beads_;
+  std::vector<Index> order_;
+  std::vector<double> x_, y_, z_;
+
+  /// scratch buffers for the distance kernel
+  struct scratch_t {
+    std::vector<double> dx_, dy_, dz_, dist2_;
+  };
+
+  struct found_pair_t {
+    Bead *bead1_;
+    Bead *bead2_;
+    Eigen::Vector3d r_;
+    double dist_;
+  };
+
+  /// per thread scratch and pair buffer, kept to reuse the memory
+  struct thread_data_t {
+    scratch_t scratch_;
+    std::vector<found_pair_t> pairs_;
+  };
+  std::vector<thread_data_t> thread_data_;
+
+  /// cell of every bead and per thread cell counts used for binning
+  std::vector<Index> cell_of_bead_;
+  std::vector<Index> thread_counts_;
+
+  void InitializeGrid(const Topology &top, double radius);
+
+  Index getCell(const Eigen::Vector3d &r) const;
+  Index getCell(Index a, Index b, Index c) const {
+    return a + box_Na_ * (b + box_Nb_ * c);
+  }
+  Index getNumberOfCells() const { return box_Na_ * box_Nb_ * box_Nc_; }
+
+  /// sort the beads of list into the cell arrays (stable counting sort)
+  void BinBeads(BeadList &list, Index nthreads);
+
+  /// the number of threads to use for n work items, a visitor streams the
+  /// pairs from the calling thread
+  Index getThreads(Index n) const {
+    if (pair_visitor_ != nullptr) {
+      return 1;
+    }
+    return std::min(nthreads_, std::max(n, Index(1)));
+  }
 
-  tools::NDimVector<cell_t, 3> grid_;
+  /// hand the buffered pairs of all threads over to StorePair
+  void MergePairs(Index nthreads, bool check_duplicates);
 
-  void InitializeGrid(const Eigen::Matrix3d &box);
+  /// compute connection vectors from pos to the cell entries [begin,end)
+  void CalcDistances(const Topology &top, const Eigen::Vector3d &pos,
+                     Index begin, Index end, scratch_t &scratch) const;
 
-  cell_t &getCell(const Eigen::Vector3d &r);
-  cell_t &getCell(const Index &a, const Index &b, const Index &c);
+  /// half-shell search of the cells [cell_begin, cell_end)
+  template <typename Sink>
+  void SearchCells(const Topology &top, Index cell_begin, Index cell_end,
+                   scratch_t &scratch, Sink &&sink) const;
 
-  void TestBead(const Topology &top, cell_t &cell, Bead *bead);
-  void TestCell(const Topology &top, cell_t &cell, Bead *bead);
+  /// test bead against the cell entries [begin, end), the bead is always
+  /// the second bead of the pair
+  template <typename Sink>
+  void TestRange(const Topology &top, Bead *bead, Index begin, Index end,
+                 scratch_t &scratch, Sink &&sink) const;
+  /// test the cell entry i against the entries [begin,end), the entry with
+  /// the lower position in the input list becomes the first bead of the pair
+  template <typename Sink>
+  void TestRangeOrdered(const Topology &top, Index i, Index begin, Index end,
+                        scratch_t &scratch, Sink &&sink) const;
 };
 
 }  // namespace csg
@@ -19,14 +19,27 @@
 #define VOTCA_CSG_NBLISTGRID_3BODY_H
 
 // Standard includes
+#include <algorithm>
+#include <memory>
 #include <vector>
 
 // Local VOTCA includes
 #include "nblist_3body.h"
+#include "parallelfor.h"
 
 namespace votca {
 namespace csg {
 
+/**
+ * \brief Cell list based 3body neighbour search
+ *
+ * With more than one thread the cells of the beads are computed in parallel
+ * and the central beads of list1 are split into contiguous chunks. Every
+ * thread collects the triples of its chunk in its own buffer, the buffers
+ * are handed to the match function in chunk order afterwards, so the
+ * resulting list is identical to the serial one. The threads are started
+ * once and reused for every list.
+ */
 class NBListGrid_3Body : public NBList_3Body {
  public:
   void Generate(BeadList &list1, BeadList &list2, BeadList &list3,
@@ -35,6 +48,13 @@ class NBListGrid_3Body : public NBList_3Body {
                 bool do_exclusions = true) override;
   void Generate(BeadList &list, bool do_exclusions = true) override;
 
+  /// number of threads used to build a single list
+  void setNumberOfThreads(Index nthreads) {
+    nthreads_ = std::max(nthreads, Index(1));
+    team_ = (nthreads_ > 1) ? std::make_unique<ThreadTeam>(nthreads_) : nullptr;
+  }
+  Index getNumberOfThreads() const { return nthreads_; }
+
  protected:
   struct cell_t {
     BeadList beads1_;
@@ -43,18 +63,47 @@ class NBListGrid_3Body : public NBList_3Body {
     std::vector<cell_t *> neighbours_;
   };
 
+  struct found_triple_t {
+    Bead *bead1_;
+    Bead *bead2_;
+    Bead *bead3_;
+    Eigen::Vector3d r12_, r13_, r23_;
+    double d12_, d13_, d23_;
+  };
+
   Eigen::Vector3d box_a_, box_b_, box_c_;
   Eigen::Vector3d norm_a_, norm_b_, norm_c_;
   Index box_Na_, box_Nb_, box_Nc_;
 
   std::vector<cell_t> grid_;
 
+  Index nthreads_ = 1;
+  std::unique_ptr<ThreadTeam> team_;
+  /// cells of the central beads (list1) and of the other lists
+  std::vector<Index> cell_of_bead1_;
+  std::vector<Index> cell_of_bead_;
+  /// per thread triple buffers, kept to reuse the memory
+  std::vector<std::vector<found_triple_t>> thread_triples_;
+
   void InitializeGrid(const Eigen::Matrix3d &box);
 
-  cell_t &getCell(const Eigen::Vector3d &r);
+  Index getCellIndex(const Eigen::Vector3d &r) const;
+  cell_t &getCell(const Eigen::Vector3d &r) { return grid_[getCellIndex(r)]; }
   cell_t &getCell(const Index &a, const Index &b, const Index &c);
 
-  void TestBead(const Topology &top, cell_t &cell, Bead *bead);
+  /// add the beads of list to the given bead list of their cells
+  void BinBeads(BeadList &list, std::vector<Index> &cells,
+                BeadList cell_t::*beads);
+
+  /// test all beads of list1 as central beads of a triple
+  void SearchTriples(const Topology &top, BeadList &list1);
+
+  /// apply match function and add the triple if it is new
+  void ProcessTriple(const found_triple_t &t);
+
+  template <typename Sink>
+  void TestBead(const Topology &top, const cell_t &cell, Bead *bead,
+                Sink &&sink) const;
 };
 
 inline NBListGrid_3Body::cell_t &NBListGrid_3Body::getCell(const Index &a,
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef VOTCA_CSG_PAIRARENA_H
+#define VOTCA_CSG_PAIRARENA_H
+
+// Standard includes
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace votca {
+namespace csg {
+
+/**
+ * \brief Block allocator for pair objects
+ *
+ * Objects are constructed consecutively in large memory blocks. Clear() does
+ * not free the blocks, they are reused for the next objects. Destructors are
+ * only recorded and called for types which are not trivially destructible,
+ * so clearing an arena of plain pairs is O(1).
+ */
+class PairArena {
+ public:
+  PairArena() = default;
+  ~PairArena() { Clear(); }
+
+  PairArena(const PairArena &) = delete;
+  PairArena &operator=(const PairArena &) = delete;
+
+  template <typename T, typename... Args>
+  T *Create(Args &&...args) {
+    void *mem = Allocate(sizeof(T), alignof(T));
+    T *obj = new (mem) T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      destructors_.emplace_back(obj,
+                                [](void *p) { static_cast<T *>(p)->~T(); });
+    }
+    return obj;
+  }
+
+  /// destroy all objects, the memory is kept for reuse
+  void Clear() {
+    for (auto &destructor : destructors_) {
+      destructor.second(destructor.first);
+    }
+    destructors_.clear();
+    block_ = 0;
+    offset_ = 0;
+  }
+
+ private:
+  struct block_t {
+    std::unique_ptr<char[]> data_;
+    std::size_t size_;
+  };
+
+  static constexpr std::size_t default_block_size_ = 1 << 16;
+
+  void *Allocate(std::size_t size, std::size_t alignment) {
+    while (true) {
+      if (block_ == blocks_.size()) {
+        std::size_t block_size =
+            std::max(default_block_size_, size + alignment);
+        blocks_.push_back({std::make_unique<char[]>(block_size), block_size});
+      }
+      block_t &block = blocks_[block_];
+      void *ptr = block.data_.get() + offset_;
+      std::size_t space = block.size_ - offset_;
+      if (std::align(alignment, size, ptr, space) != nullptr) {
+        offset_ = block.size_ - space + size;
+        return ptr;
+      }
+      // the object does not fit anymore, a reused block might be too small
+      // for very large objects, so it is replaced
+      if (offset_ == 0) {
+        std::size_t block_size = size + alignment;
+        block = {std::make_unique<char[]>(block_size), block_size};
+        continue;
+      }
+      block_++;
+      offset_ = 0;
+    }
+  }
+
+  std::vector<block_t> blocks_;
+  std::size_t block_ = 0;
+  std::size_t offset_ = 0;
+  std::vector<std::pair<void *, void (*)(void *)>> destructors_;
+};
+
+}  // namespace csg
+}  // namespace votca
+
+#endif  // VOTCA_CSG_PAIRARENA_H
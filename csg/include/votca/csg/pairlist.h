@@ -1,5 +1,5 @@
 /*
- * Copyright 2009-2019 The VOTCA Development Team (http://www.votca.org)
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -19,15 +19,30 @@
 #define VOTCA_CSG_PAIRLIST_H
 
 // Standard includes
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <vector>
 
 // VOTCA includes
 #include <votca/tools/types.h>
 
+// Local VOTCA includes
+#include "pairarena.h"
+
 namespace votca {
 namespace csg {
 
+/**
+ * \brief List of pairs with a hashed pair index
+ *
+ * The pairs are kept in a contiguous vector, FindPair uses an open addressing
+ * hash table keyed by the (unordered) pair of elements. Pairs are either
+ * heap allocated and handed over by AddPair or constructed in the arena by
+ * derived classes via InsertPair. Cleanup() only has to delete heap pairs,
+ * clearing the arena and the index does not depend on the number of pairs.
+ */
 template <typename element_type, typename pair_type>
 class PairList {
  public:
@@ -54,10 +69,15 @@ class PairList {
 
   void Cleanup();
 
-  pair_type *FindPair(element_type e1, element_type e2);
+  pair_type *FindPair(element_type e1, element_type e2) {
+    return Lookup(e1, e2);
+  }
 
-  const pair_type *FindPair(element_type e1, element_type e2) const;
+  const pair_type *FindPair(element_type e1, element_type e2) const {
+    return Lookup(e1, e2);
+  }
 
+  /// all partners of e1, built on demand and valid until the list changes
   partners *FindPartners(element_type e1);
 
   using element_t = element_type;
@@ -66,73 +86,166 @@ class PairList {
  protected:
   std::vector<pair_type *> pairs_;
 
-  std::map<element_type, std::map<element_type, pair_type *>> pair_map_;
+  /// storage for pairs created by derived classes
+  PairArena arena_;
+
+  /// register a pair without taking ownership (e.g. allocated in arena_)
+  void InsertPair(pair_type *p);
+
+ private:
+  struct slot_t {
+    element_type first_;
+    element_type second_;
+    pair_type *pair_;
+    /// slot is only valid if it matches the current generation
+    std::uint64_t generation_ = 0;
+  };
+
+  /// heap allocated pairs handed over by AddPair
+  std::vector<pair_type *> owned_;
+
+  std::vector<slot_t> slots_;
+  std::uint64_t generation_ = 1;
+  std::size_t used_slots_ = 0;
+
+  std::map<element_type, partners> partners_;
+  bool partners_valid_ = false;
+
+  static std::size_t Hash(element_type e1, element_type e2) {
+    std::size_t h1 = std::hash<element_type>()(e1);
+    std::size_t h2 = std::hash<element_type>()(e2);
+    // order independent combination, then mixed for pointer keys whose
+    // lower bits are mostly zero
+    std::uint64_t h =
+        std::uint64_t(h1 ^ h2) * 0x9E3779B97F4A7C15ULL + std::uint64_t(h1 + h2);
+    return std::size_t(h ^ (h >> 29));
+  }
+
+  bool Matches(const slot_t &slot, element_type e1, element_type e2) const {
+    return (slot.first_ == e1 && slot.second_ == e2) ||
+           (slot.first_ == e2 && slot.second_ == e1);
+  }
+
+  pair_type *Lookup(element_type e1, element_type e2) const;
+  void Insert(pair_type *p);
+  void Rehash(std::size_t capacity);
 };
 
 // this method takes ownership of p
 template <typename element_type, typename pair_type>
 inline void PairList<element_type, pair_type>::AddPair(pair_type *p) {
+  owned_.push_back(p);
+  InsertPair(p);
+}
+
+template <typename element_type, typename pair_type>
+inline void PairList<element_type, pair_type>::InsertPair(pair_type *p) {
   /// \todo be careful, same pair object is used, some values might change (e.g.
   /// sign of distance vector)
-  pair_map_[p->first()][p->second()] = p;
-  pair_map_[p->second()][p->first()] = p;
+  Insert(p);
   /// \todo check if unique
   pairs_.push_back(p);
+  partners_valid_ = false;
 }
 
 template <typename element_type, typename pair_type>
 inline void PairList<element_type, pair_type>::Cleanup() {
-  for (auto &pair : pairs_) {
+  for (auto &pair : owned_) {
     delete pair;
   }
+  owned_.clear();
+  arena_.Clear();
   pairs_.clear();
-  pair_map_.clear();
+  // invalidates all slots at once
+  generation_++;
+  used_slots_ = 0;
+  partners_.clear();
+  partners_valid_ = false;
 }
 
 template <typename element_type, typename pair_type>
-inline pair_type *PairList<element_type, pair_type>::FindPair(element_type e1,
-                                                              element_type e2) {
-  typename std::map<element_type, std::map<element_type, pair_type *>>::iterator
-      iter1;
-  iter1 = pair_map_.find(e1);
-  if (iter1 == pair_map_.end()) {
+inline pair_type *PairList<element_type, pair_type>::Lookup(
+    element_type e1, element_type e2) const {
+  if (used_slots_ == 0) {
     return nullptr;
   }
-
-  typename partners::iterator iter2;
-  iter2 = iter1->second.find(e2);
-  if (iter2 == iter1->second.end()) {
-    return nullptr;
+  std::size_t mask = slots_.size() - 1;
+  for (std::size_t i = Hash(e1, e2) & mask;; i = (i + 1) & mask) {
+    const slot_t &slot = slots_[i];
+    if (slot.generation_ != generation_) {
+      return nullptr;
+    }
+    if (Matches(slot, e1, e2)) {
+      return slot.pair_;
+    }
   }
-
-  return iter2->second;
 }
 
 template <typename element_type, typename pair_type>
-inline const pair_type *PairList<element_type, pair_type>::FindPair(
-    element_type e1, element_type e2) const {
-  typename std::map<element_type,
-                    std::map<element_type, pair_type *>>::const_iterator iter1;
-  iter1 = pair_map_.find(e1);
-  if (iter1 == pair_map_.end()) {
-    return nullptr;
+inline void PairList<element_type, pair_type>::Insert(pair_type *p) {
+  // keep the load factor below 1/2
+  if (2 * (used_slots_ + 1) > slots_.size()) {
+    Rehash(std::max<std::size_t>(64, 2 * slots_.size()));
   }
-
-  typename partners::const_iterator iter2;
-  iter2 = iter1->second.find(e2);
-  if (iter2 == iter1->second.end()) {
-    return nullptr;
+  element_type e1 = p->first();
+  element_type e2 = p->second();
+  std::size_t mask = slots_.size() - 1;
+  for (std::size_t i = Hash(e1, e2) & mask;; i = (i + 1) & mask) {
+    slot_t &slot = slots_[i];
+    if (slot.generation_ != generation_) {
+      slot.first_ = e1;
+      slot.second_ = e2;
+      slot.pair_ = p;
+      slot.generation_ = generation_;
+      used_slots_++;
+      return;
+    }
+    if (Matches(slot, e1, e2)) {
+      slot.pair_ = p;
+      return;
+    }
   }
+}
 
-  return iter2->second;
+template <typename element_type, typename pair_type>
+inline void PairList<element_type, pair_type>::Rehash(std::size_t capacity) {
+  std::vector<slot_t> old_slots(capacity);
+  std::swap(old_slots, slots_);
+  std::uint64_t old_generation = generation_;
+  generation_ = 1;
+  used_slots_ = 0;
+  std::size_t mask = slots_.size() - 1;
+  for (const slot_t &old : old_slots) {
+    if (old.generation_ != old_generation) {
+      continue;
+    }
+    for (std::size_t i = Hash(old.first_, old.second_) & mask;;
+         i = (i + 1) & mask) {
+      if (slots_[i].generation_ != generation_) {
+        slots_[i] = old;
+        slots_[i].generation_ = generation_;
+        used_slots_++;
+        break;
+      }
+    }
+  }
 }
 
 template <typename element_type, typename pair_type>
 typename PairList<element_type, pair_type>::partners *
     PairList<element_type, pair_type>::FindPartners(element_type e1) {
-  typename std::map<element_type, std::map<element_type, pair_type *>>::iterator
-      iter;
-  if ((iter = pair_map_.find(e1)) == pair_map_.end()) {
+  if (!partners_valid_) {
+    partners_.clear();
+    for (pair_type *p : pairs_) {
+      element_type first = p->first();
+      element_type second = p->second();
+      partners_[first][second] = p;
+      partners_[second][first] = p;
+    }
+    partners_valid_ = true;
+  }
+  typename std::map<element_type, partners>::iterator iter;
+  if ((iter = partners_.find(e1)) == partners_.end()) {
     return nullptr;
   }
   return &(iter->second);
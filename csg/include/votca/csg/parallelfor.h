@@ -0,0 +1,98 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef VOTCA_CSG_PARALLELFOR_H
+#define VOTCA_CSG_PARALLELFOR_H
+
+// Standard includes
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// VOTCA includes
+#include <votca/tools/types.h>
+
+namespace votca {
+namespace csg {
+
+/**
+ * \brief fixed set of threads which is reused for many parallel loops
+ *
+ * The threads are started once and wait for work between two calls of Run,
+ * so a neighbour list which is rebuilt every frame does not pay for starting
+ * and joining threads each time.
+ */
+class ThreadTeam {
+ public:
+  explicit ThreadTeam(Index nthreads);
+  ~ThreadTeam();
+  ThreadTeam(const ThreadTeam &) = delete;
+  ThreadTeam &operator=(const ThreadTeam &) = delete;
+
+  Index size() const { return Index(threads_.size()) + 1; }
+
+  /**
+   * \brief run fkt(thread) for thread = 0..nthreads-1 concurrently
+   *
+   * nthreads must not exceed size(). Thread 0 runs in the calling thread. An
+   * exception thrown by one of the threads is rethrown in the caller after
+   * all threads have finished.
+   */
+  void Run(Index nthreads, const std::function<void(Index)> &fkt);
+
+ private:
+  void Work(Index thread);
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  const std::function<void(Index)> *job_ = nullptr;
+  Index job_threads_ = 0;
+  Index pending_ = 0;
+  std::uint64_t generation_ = 0;
+  bool stop_ = false;
+  std::vector<std::exception_ptr> errors_;
+};
+
+/// runs fkt(thread) for thread = 0..nthreads-1 on team, serially if there is
+/// only one thread
+template <typename Function>
+void ParallelFor(ThreadTeam *team, Index nthreads, Function &&fkt) {
+  if (nthreads <= 1 || team == nullptr) {
+    for (Index thread = 0; thread < nthreads; ++thread) {
+      fkt(thread);
+    }
+    return;
+  }
+  team->Run(nthreads, fkt);
+}
+
+/// first index of the contiguous chunk of [0,n) handled by thread
+inline Index ChunkBegin(Index n, Index nthreads, Index thread) {
+  return (n / nthreads) * thread + std::min(thread, n % nthreads);
+}
+
+}  // namespace csg
+}  // namespace votca
+
+#endif  // VOTCA_CSG_PARALLELFOR_H
@@ -242,6 +242,13 @@ class Topology {
    */
   void CopyTopologyData(Topology *top);
 
+  /**
+   * \brief copy the frame data (box, time, step, bead positions, velocities
+   * and forces) of a topology with the same beads
+   * \param top topology to copy from
+   */
+  void CopyFrameData(const Topology &top);
+
   /**
    *  \brief rename all the molecules in range
    * \param range range string of type 1:2:10 = 1, 3, 5, 7, ...
@@ -46,7 +46,21 @@ class TrajectoryReader {
   /// read in the next frame
   virtual bool NextFrame(Topology &top) = 0;
 
+  /// true if the reader implements FrameCount and SeekFrame
+  virtual bool IsSeekable() const { return false; }
+  /// number of frames in the opened trajectory
+  virtual Index FrameCount() { return -1; }
+  /// position the reader such that the next call of FirstFrame or NextFrame
+  /// reads frame (counted from 0), returns false if there is no such frame
+  virtual bool SeekFrame(Index) { return false; }
+  /// seekable readers of text formats store the frame index they build next
+  /// to the trajectory, so later runs do not have to scan it again
+  void setSaveFrameIndex(bool save) { save_frame_index_ = save; }
+
   static void RegisterPlugins(void);
+
+ protected:
+  bool save_frame_index_ = false;
 };
 
 // important - singleton pattern, make sure factory is created before accessed
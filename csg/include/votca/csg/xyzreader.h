@@ -30,6 +30,7 @@
 #include <votca/tools/unitconverter.h>
 
 // Local VOTCA includes
+#include "frameindex.h"
 #include "topologyreader.h"
 #include "trajectoryreader.h"
 
@@ -60,6 +61,10 @@ class XYZReader : public TrajectoryReader, public TopologyReader {
   /// read in the next frame
   bool NextFrame(Topology &top) override;
 
+  bool IsSeekable() const override { return true; }
+  Index FrameCount() override;
+  bool SeekFrame(Index frame) override;
+
   template <class T>
   void ReadFile(T &container) {
     if (!ReadFrame<true, T>(container)) {
@@ -105,9 +110,16 @@ class XYZReader : public TrajectoryReader, public TopologyReader {
   template <bool topology, class T>
   bool ReadFrame(T &container);
 
+  /// offsets of the lines with the number of atoms
+  static void ScanFrames(std::istream &in, std::vector<std::int64_t> &offsets);
+
   std::ifstream fl_;
   std::string file_;
   Index line_;
+
+  FrameIndex frame_index_;
+  /// frame read by the next call of NextFrame
+  Index next_frame_ = 0;
 };
 
 template <bool topology, class T>
@@ -202,7 +202,7 @@ class IMCNBSearchHandler {
   Eigen::Vector3d boxc_;  // center of box
   bool do_vol_corr_;
 
-  bool FoundPair(Bead *b1, Bead *, const Eigen::Vector3d &, const double dist) {
+  void operator()(Bead *b1, Bead *, const Eigen::Vector3d &, double dist) {
 
     if (do_vol_corr_) {
       double dr = (b1->Pos() - boxc_).norm();
@@ -216,7 +216,6 @@ class IMCNBSearchHandler {
     } else {
       hist_->Process(dist);
     }
-    return false;
   }
 
   double SurfaceRatio(double dist, double r) {
@@ -282,13 +281,12 @@ void RDFCalculator::Worker::DoNonbonded(Topology *top) {
     IMCNBSearchHandler h(&(current_hists_[i.index_]),
                          rdfcalculator_->subvol_rad_, rdfcalculator_->boxc_,
                          rdfcalculator_->do_vol_corr_);
-    nb->SetMatchFunction(&h, &IMCNBSearchHandler::FoundPair);
 
     // is it same types or different types?
     if (prop->get("type1").value() == prop->get("type2").value()) {
-      nb->Generate(beads1);
+      nb->ForEachPair(beads1, h);
     } else {
-      nb->Generate(beads1, beads2);
+      nb->ForEachPair(beads1, beads2, h);
     }
 
     // store particle number in subvolume for each interaction
@@ -15,13 +15,17 @@
  *
  */
 
+// Standard includes
+#include <algorithm>
+#include <memory>
+
 // Third party includes
 #include <boost/algorithm/string/trim.hpp>
-#include <memory>
 
 // Local VOTCA includes
 #include "votca/csg/cgengine.h"
 #include "votca/csg/csgapplication.h"
+#include "votca/csg/parallelfor.h"
 #include "votca/csg/topologymap.h"
 #include "votca/csg/topologyreader.h"
 #include "votca/csg/trajectoryreader.h"
@@ -31,6 +35,11 @@
 namespace votca {
 namespace csg {
 
+CsgApplication::~CsgApplication() {
+  // Run might have been left by an exception while the reader was running
+  StopReading();
+}
+
 void CsgApplication::Initialize() {
   // register all io plugins
   TrajectoryWriter::RegisterPlugins();
@@ -71,7 +80,9 @@ void CsgApplication::Initialize() {
         "first-frame", boost::program_options::value<Index>()->default_value(0),
         "  start with this frame")("nframes",
                                    boost::program_options::value<Index>(),
-                                   "  process the given number of frames");
+                                   "  process the given number of frames")(
+        "save-frame-index",
+        "  store the frame offsets of text trajectories in <trj>.offsets");
   }
 
   if (DoThreaded()) {
@@ -80,7 +91,9 @@ void CsgApplication::Initialize() {
      */
     AddProgramOptions("Threading options")(
         "nt", boost::program_options::value<Index>()->default_value(1),
-        "  number of threads");
+        "  number of threads")(
+        "partition-frames",
+        "  every thread reads its own frames, needs a seekable trajectory");
   }
 }
 
@@ -139,7 +152,9 @@ void CsgApplication::Worker::Run() {
     if (app_->SynchronizeThreads()) {
       Index id = getId();
       app_->threadsMutexesOut_[id]->Lock();
-      app_->MergeWorker(this);
+      if (!skip_merge_) {
+        app_->MergeWorker(this);
+      }
       app_->threadsMutexesOut_[(id + 1) % app_->nthreads_]->Unlock();
     }
   }
@@ -150,42 +165,43 @@ bool CsgApplication::ProcessData(Worker *worker) {
   Index id;
   id = worker->getId();
 
-  if (SynchronizeThreads()) {
+  // with partitioned frames every worker reads on its own
+  bool ordered_input = SynchronizeThreads() && !partitioned_;
+  if (ordered_input) {
     // wait til its your turn
     threadsMutexesIn_[id]->Lock();
   }
-  traj_readerMutex_.Lock();
-  if (nframes_ == 0) {
-    traj_readerMutex_.Unlock();
-
-    if (SynchronizeThreads()) {
-      // done processing? don't forget to unlock next worker anyway
-      threadsMutexesIn_[(id + 1) % nthreads_]->Unlock();
-    }
+  // the first frame was already read into the topology of the master, all
+  // other frames come from the reader thread or the own partition
+  bool has_frame = false;
+  Index slot = -1;
+  if (id == 0 && is_first_frame_) {
+    is_first_frame_ = false;
+    has_frame = (nframes_ != 0);
+  } else if (partitioned_) {
+    has_frame = ReadPartitionFrame(worker);
+  } else if (read_ahead_) {
+    slot = PopFrame();
+    has_frame = (slot >= 0);
+  } else {
+    has_frame = ReadNextFrame(worker);
+  }
+  if (ordered_input) {
+    // unlock next frame for input
+    threadsMutexesIn_[(id + 1) % nthreads_]->Unlock();
+  }
 
+  if (!has_frame) {
     return false;
   }
-  nframes_--;
-  if (!is_first_frame_ || worker->getId() != 0) {
-    // get frame
-    bool tmpRes = traj_reader_->NextFrame(worker->top_);
-    if (!tmpRes) {
-      traj_readerMutex_.Unlock();
-      if (SynchronizeThreads()) {
-        threadsMutexesIn_[(id + 1) % nthreads_]->Unlock();
-      }
-      return false;
-    }
+  if (worker->skip_merge_) {
+    return true;
   }
-  if (worker->getId() == 0) {
-    is_first_frame_ = false;
+  if (slot >= 0) {
+    worker->top_.CopyFrameData(*frame_pool_[slot]);
+    ReleaseFrame(slot);
   }
 
-  traj_readerMutex_.Unlock();
-  if (SynchronizeThreads()) {
-    // unlock next frame for input
-    threadsMutexesIn_[(id + 1) % nthreads_]->Unlock();
-  }
   // evaluate
   if (do_mapping_) {
     worker->map_->Apply();
@@ -197,6 +213,172 @@ bool CsgApplication::ProcessData(Worker *worker) {
   return true;
 }
 
+void CsgApplication::ReadFrames(Index nframes) {
+  try {
+    while (nframes != 0) {
+      Index slot;
+      {
+        std::unique_lock<std::mutex> lock(frames_mutex_);
+        frame_free_.wait(
+            lock, [this] { return reading_done_ || !free_frames_.empty(); });
+        if (reading_done_) {
+          break;
+        }
+        slot = free_frames_.front();
+        free_frames_.pop_front();
+      }
+      // decode without holding the lock
+      if (!traj_reader_->NextFrame(*frame_pool_[slot])) {
+        break;
+      }
+      {
+        std::lock_guard<std::mutex> lock(frames_mutex_);
+        ready_frames_.push_back(slot);
+      }
+      frame_ready_.notify_one();
+      if (nframes > 0) {
+        nframes--;
+      }
+    }
+  } catch (...) {
+    reader_error_ = std::current_exception();
+  }
+  {
+    std::lock_guard<std::mutex> lock(frames_mutex_);
+    reading_done_ = true;
+  }
+  frame_ready_.notify_all();
+}
+
+Index CsgApplication::PopFrame() {
+  std::unique_lock<std::mutex> lock(frames_mutex_);
+  frame_ready_.wait(lock,
+                    [this] { return reading_done_ || !ready_frames_.empty(); });
+  // frames which were read before the reader stopped are still processed
+  if (ready_frames_.empty()) {
+    return -1;
+  }
+  Index slot = ready_frames_.front();
+  ready_frames_.pop_front();
+  return slot;
+}
+
+void CsgApplication::ReleaseFrame(Index slot) {
+  {
+    std::lock_guard<std::mutex> lock(frames_mutex_);
+    free_frames_.push_back(slot);
+  }
+  frame_free_.notify_one();
+}
+
+void CsgApplication::StopReading() {
+  {
+    std::lock_guard<std::mutex> lock(frames_mutex_);
+    reading_done_ = true;
+  }
+  frame_free_.notify_all();
+  frame_ready_.notify_all();
+  if (reader_thread_.joinable()) {
+    reader_thread_.join();
+  }
+  frame_pool_.clear();
+  free_frames_.clear();
+  ready_frames_.clear();
+}
+
+bool CsgApplication::ReadNextFrame(Worker *worker) {
+  if (frames_to_read_ == 0) {
+    return false;
+  }
+  if (frames_to_read_ > 0) {
+    frames_to_read_--;
+  }
+  return traj_reader_->NextFrame(worker->top_);
+}
+
+void CsgApplication::PartitionFrames(Index first) {
+  Index nworkers = Index(myWorkers_.size());
+  Index end = traj_reader_->FrameCount();
+  if (nframes_ >= 0) {
+    end = std::min(end, first + nframes_);
+  }
+  Index nframes = std::max(end - first, Index(0));
+  const std::string trj = OptionsMap()["trj"].as<std::string>();
+
+  for (Index id = 0; id < nworkers; id++) {
+    Worker *worker = myWorkers_[id].get();
+    if (SynchronizeThreads()) {
+      // the same frames as with ordered input, so the merge order is kept
+      worker->frame_ = first + id;
+      worker->frame_end_ = first + nframes;
+      worker->frame_stride_ = nworkers;
+    } else {
+      worker->frame_ = first + ChunkBegin(nframes, nworkers, id);
+      worker->frame_end_ = first + ChunkBegin(nframes, nworkers, id + 1);
+      worker->frame_stride_ = 1;
+    }
+    if (id == 0) {
+      // the first frame is already in the master topology
+      worker->frame_ += worker->frame_stride_;
+      worker->reader_started_ = true;
+    } else {
+      worker->traj_reader_ = TrjReaderFactory().Create(trj);
+      worker->traj_reader_->setSaveFrameIndex(
+          OptionsMap().count("save-frame-index") > 0);
+      worker->traj_reader_->Open(trj);
+      worker->reader_started_ = false;
+    }
+  }
+}
+
+bool CsgApplication::ReadPartitionFrame(Worker *worker) {
+  worker->skip_merge_ = false;
+  if (worker->frame_ >= worker->frame_end_) {
+    return false;
+  }
+  bool failed = false;
+  {
+    std::lock_guard<std::mutex> lock(frames_mutex_);
+    failed = bool(reader_error_);
+  }
+  if (!failed) {
+    TrajectoryReader *reader = (worker->traj_reader_ != nullptr)
+                                   ? worker->traj_reader_.get()
+                                   : traj_reader_.get();
+    try {
+      if (!reader->SeekFrame(worker->frame_)) {
+        throw std::runtime_error("cannot seek frame " +
+                                 std::to_string(worker->frame_) +
+                                 " of the trajectory");
+      }
+      bool read = (worker->reader_started_) ? reader->NextFrame(worker->top_)
+                                            : reader->FirstFrame(worker->top_);
+      if (!read) {
+        throw std::runtime_error("cannot read frame " +
+                                 std::to_string(worker->frame_) +
+                                 " of the trajectory");
+      }
+      worker->reader_started_ = true;
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(frames_mutex_);
+      if (!reader_error_) {
+        reader_error_ = std::current_exception();
+      }
+      failed = true;
+    }
+  }
+  if (failed) {
+    if (!SynchronizeThreads()) {
+      return false;
+    }
+    // the workers with later frames wait for the merge of this frame, so the
+    // rest of the partition is walked through without reading or merging
+    worker->skip_merge_ = true;
+  }
+  worker->frame_ += worker->frame_stride_;
+  return true;
+}
+
 void CsgApplication::Run(void) {
   // create reader for atomistic topology
   std::unique_ptr<TopologyReader> reader =
@@ -299,6 +481,7 @@ void CsgApplication::Run(void) {
       throw std::runtime_error(std::string("input format not supported: ") +
                                OptionsMap()["trj"].as<std::string>());
     }
+    traj_reader_->setSaveFrameIndex(OptionsMap().count("save-frame-index") > 0);
     // open the trajectory
     traj_reader_->Open(OptionsMap()["trj"].as<std::string>());
 
@@ -336,10 +519,20 @@ void CsgApplication::Run(void) {
           << std::endl;
     }
     // seek first frame, let thread0 do that
-    bool bok;
-    for (bok = true; bok == true; bok = traj_reader_->NextFrame(master->top_)) {
+    bool bok = true;
+    // frame in the master topology, counted from 0
+    Index frame = 0;
+    if (traj_reader_->IsSeekable() && first_frame > 1) {
+      // jump over the frames instead of parsing them
+      frame = first_frame - 1;
+      first_frame = 0;
+      bok = traj_reader_->SeekFrame(frame) &&
+            traj_reader_->NextFrame(master->top_);
+    }
+    for (; bok == true; bok = traj_reader_->NextFrame(master->top_)) {
       if ((has_begin && (master->top_.getTime() < begin)) || first_frame > 1) {
         first_frame--;
+        frame++;
         continue;
       }
       break;
@@ -361,6 +554,35 @@ void CsgApplication::Run(void) {
     }
 
     is_first_frame_ = true;
+    reading_done_ = false;
+    reader_error_ = nullptr;
+
+    partitioned_ = DoThreaded() && OptionsMap().count("partition-frames") &&
+                   myWorkers_.size() > 1 && traj_reader_->IsSeekable();
+    // the first frame is already in the master topology
+    frames_to_read_ = (nframes_ > 0) ? nframes_ - 1 : nframes_;
+    read_ahead_ = DoThreaded() && !partitioned_;
+    if (partitioned_) {
+      PartitionFrames(frame);
+    } else if (read_ahead_) {
+      //////////////////////////////////////////////////
+      // start reading ahead into a small pool of topologies
+      //////////////////////////////////////////////////
+      // every slot holds a full topology, but workers only occupy a slot
+      // while copying the frame out of it, so a few slots keep the reader
+      // busy also for many workers
+      Index pool_size =
+          std::min(Index(myWorkers_.size()) + 1, max_frame_pool_size_);
+      for (Index slot = 0; slot < pool_size; slot++) {
+        frame_pool_.push_back(std::make_unique<Topology>());
+        reader->ReadTopology(OptionsMap()["top"].as<std::string>(),
+                             *frame_pool_.back());
+        free_frames_.push_back(slot);
+      }
+      reader_thread_ =
+          std::thread(&CsgApplication::ReadFrames, this, frames_to_read_);
+    }
+
     /////////////////////////////////////////////////////////////////////////
     // start threads
     if (DoThreaded()) {
@@ -401,8 +623,15 @@ void CsgApplication::Run(void) {
       master->WaitDone();
     }
 
+    StopReading();
+    if (reader_error_) {
+      traj_reader_->Close();
+      std::rethrow_exception(reader_error_);
+    }
+
     EndEvaluate();
 
+    // also closes the readers of the workers
     myWorkers_.clear();
     threadsMutexesIn_.clear();
     threadsMutexesOut_.clear();
@@ -1,5 +1,5 @@
 /*
- * Copyright 2009-2020 The VOTCA Development Team (http://www.votca.org)
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,6 +17,7 @@
 
 // Standard includes
 #include <algorithm>
+#include <numeric>
 
 // Local VOTCA includes
 #include "votca/csg/exclusionlist.h"
@@ -33,6 +34,8 @@ void ExclusionList::Clear(void) {
     delete exclusion_;
   }
   exclusions_.clear();
+  excl_by_bead_.clear();
+  index_valid_ = false;
 }
 
 void ExclusionList::CreateExclusions(Topology *top) {
@@ -48,6 +51,37 @@ void ExclusionList::CreateExclusions(Topology *top) {
     }
     ExcludeList(l);
   }
+  BuildIndex();
+}
+
+void ExclusionList::BuildIndex() {
+  Index max_id = -1;
+  for (const exclusion_t *excl : exclusions_) {
+    max_id = std::max(max_id, excl->atom_->getId());
+  }
+
+  run_.assign(max_id + 1, 0);
+  excl_begin_.assign(max_id + 2, 0);
+  for (const exclusion_t *excl : exclusions_) {
+    excl_begin_[excl->atom_->getId() + 1] = Index(excl->exclude_.size());
+  }
+  std::partial_sum(excl_begin_.begin(), excl_begin_.end(), excl_begin_.begin());
+
+  excl_ids_.resize(excl_begin_.back());
+  for (const exclusion_t *excl : exclusions_) {
+    Index id = excl->atom_->getId();
+    auto begin = excl_ids_.begin() + excl_begin_[id];
+    auto end = excl_ids_.begin() + excl_begin_[id + 1];
+    std::transform(excl->exclude_.begin(), excl->exclude_.end(), begin,
+                   [](const Bead *b) { return b->getId(); });
+    std::sort(begin, end);
+    Index run = 0;
+    while (begin + run != end && *(begin + run) == id + run + 1) {
+      run++;
+    }
+    run_[id] = run;
+  }
+  index_valid_ = true;
 }
 
 const ExclusionList::exclusion_t *ExclusionList::GetExclusions(
@@ -78,6 +112,21 @@ bool ExclusionList::IsExcluded(Bead *bead1, Bead *bead2) const {
     swap(bead1, bead2);
   }
 
+  if (index_valid_) {
+    Index id1 = bead1->getId();
+    if (id1 >= Index(run_.size())) {
+      return false;
+    }
+    // unsigned comparison also rejects id1 == id2
+    Index diff = bead2->getId() - id1;
+    if (std::size_t(diff - 1) < std::size_t(run_[id1])) {
+      return true;
+    }
+    return std::binary_search(excl_ids_.begin() + excl_begin_[id1] + run_[id1],
+                              excl_ids_.begin() + excl_begin_[id1 + 1],
+                              bead2->getId());
+  }
+
   const exclusion_t *excl = GetExclusions(bead1);
   if (excl != nullptr) {
     if (find(excl->exclude_.begin(), excl->exclude_.end(), bead2) !=
@@ -109,6 +158,7 @@ void ExclusionList::InsertExclusion(Bead *bead1, Bead *bead2) {
     excl_by_bead_[bead1] = e;
   }
   e->exclude_.push_back(bead2);
+  index_valid_ = false;
 }
 
 void ExclusionList::RemoveExclusion(Bead *bead1, Bead *bead2) {
@@ -132,6 +182,7 @@ void ExclusionList::RemoveExclusion(Bead *bead1, Bead *bead2) {
     return;
   }
 
+  index_valid_ = false;
   (*ex)->exclude_.remove(bead2);
   if ((*ex)->exclude_.empty()) {
     (*ex) = nullptr;
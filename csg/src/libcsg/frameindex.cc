@@ -0,0 +1,119 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Standard includes
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+// Third party includes
+#include <boost/filesystem/operations.hpp>
+
+// Local VOTCA includes
+#include "votca/csg/frameindex.h"
+
+namespace votca {
+namespace csg {
+
+namespace {
+// identifies the sidecar layout, has to change with it
+const std::string sidecar_magic = "VOTCA-FRAME-OFFSETS-1";
+}  // namespace
+
+void FrameIndex::Build(const std::string &file, const std::string &format,
+                       const ScanFunction &scan, bool save_sidecar) {
+  offsets_.clear();
+  boost::filesystem::path path(file);
+  std::int64_t file_size = std::int64_t(boost::filesystem::file_size(path));
+  std::int64_t file_time =
+      std::int64_t(boost::filesystem::last_write_time(path));
+
+  std::string sidecar = SidecarName(file);
+  if (Load(sidecar, format, file_size, file_time)) {
+    return;
+  }
+
+  std::ifstream in(file);
+  if (!in.is_open()) {
+    throw std::ios_base::failure("Error on open trajectory file: " + file);
+  }
+  std::cout << "Building frame index of " << file << std::endl;
+  scan(in, offsets_);
+  if (save_sidecar) {
+    Save(sidecar, format, file_size, file_time);
+  }
+}
+
+bool FrameIndex::SkipLine(std::istream &in, std::string &line,
+                          std::int64_t &offset) {
+  if (!std::getline(in, line)) {
+    return false;
+  }
+  offset += std::int64_t(line.size()) + (in.eof() ? 0 : 1);
+  return true;
+}
+
+bool FrameIndex::Load(const std::string &sidecar, const std::string &format,
+                      std::int64_t file_size, std::int64_t file_time) {
+  std::ifstream in(sidecar, std::ios::binary);
+  if (!in.is_open()) {
+    return false;
+  }
+  std::string magic;
+  std::string stored_format;
+  std::int64_t stored_size = -1;
+  std::int64_t stored_time = -1;
+  std::int64_t nframes = -1;
+  in >> magic >> stored_format >> stored_size >> stored_time >> nframes;
+  if (!in || magic != sidecar_magic || stored_format != format ||
+      stored_size != file_size || stored_time != file_time || nframes < 0) {
+    return false;
+  }
+  in.ignore(1);  // newline after the header
+  std::vector<std::int64_t> offsets(nframes);
+  in.read(reinterpret_cast<char *>(offsets.data()),
+          std::streamsize(nframes * sizeof(std::int64_t)));
+  if (!in) {
+    return false;
+  }
+  offsets_ = std::move(offsets);
+  return true;
+}
+
+void FrameIndex::Save(const std::string &sidecar, const std::string &format,
+                      std::int64_t file_size, std::int64_t file_time) const {
+  std::ofstream out(sidecar, std::ios::binary);
+  if (!out.is_open()) {
+    // e.g. a read-only directory, the index is rebuilt next time
+    std::cout << "Warning: could not write frame index " << sidecar
+              << std::endl;
+    return;
+  }
+  out << sidecar_magic << ' ' << format << ' ' << file_size << ' ' << file_time
+      << ' ' << offsets_.size() << '\n';
+  out.write(reinterpret_cast<const char *>(offsets_.data()),
+            std::streamsize(offsets_.size() * sizeof(std::int64_t)));
+  if (!out) {
+    out.close();
+    std::remove(sidecar.c_str());
+    std::cout << "Warning: could not write frame index " << sidecar
+              << std::endl;
+  }
+}
+
+}  // namespace csg
+}  // namespace votca
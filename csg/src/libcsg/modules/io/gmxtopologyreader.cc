@@ -119,6 +119,7 @@ bool GMXTopologyReader::ReadTopology(std::string file, Topology &top) {
       ifirstatom += natoms_mol;
     }
   }
+  top.getExclusions().BuildIndex();
 
   Eigen::Matrix3d m;
   for (Index i = 0; i < 3; i++) {
@@ -55,11 +55,59 @@ bool GROReader::Open(const string &file) {
   if (!fl_.is_open()) {
     throw std::ios_base::failure("Error on open trajectory file: " + file);
   }
+  fname_ = file;
+  next_frame_ = 0;
+  frame_index_ = FrameIndex();
   return true;
 }
 
 void GROReader::Close() { fl_.close(); }
 
+Index GROReader::FrameCount() {
+  if (frame_index_.empty()) {
+    frame_index_.Build(fname_, "gro", ScanFrames, save_frame_index_);
+  }
+  return frame_index_.size();
+}
+
+bool GROReader::SeekFrame(Index frame) {
+  if (frame == next_frame_) {
+    return true;
+  }
+  if (frame_index_.empty()) {
+    frame_index_.Build(fname_, "gro", ScanFrames, save_frame_index_);
+  }
+  if (frame < 0 || frame >= frame_index_.size()) {
+    return false;
+  }
+  fl_.clear();
+  fl_.seekg(frame_index_.Offset(frame));
+  next_frame_ = frame;
+  return bool(fl_);
+}
+
+void GROReader::ScanFrames(std::istream &in,
+                           std::vector<std::int64_t> &offsets) {
+  string line;
+  std::int64_t offset = 0;
+  while (true) {
+    std::int64_t frame_begin = offset;
+    // title and number of atoms
+    if (!FrameIndex::SkipLine(in, line, offset) ||
+        !FrameIndex::SkipLine(in, line, offset)) {
+      break;
+    }
+    Index natoms = std::stol(line);
+    offsets.push_back(frame_begin);
+    // atoms and box line
+    for (Index i = 0; i < natoms + 1; i++) {
+      if (!FrameIndex::SkipLine(in, line, offset)) {
+        return;
+      }
+    }
+  }
+}
+
 bool GROReader::FirstFrame(Topology &top) {
   topology_ = false;
   NextFrame(top);
@@ -181,7 +229,8 @@ bool GROReader::NextFrame(Topology &top) {
             "wrong!\n";
   }
 
-  return !fl_.eof();
+  next_frame_++;
+  return true;
 }
 
 }  // namespace csg
@@ -27,6 +27,7 @@
 #include <votca/tools/unitconverter.h>
 
 // Local includes
+#include "votca/csg/frameindex.h"
 #include "votca/csg/topologyreader.h"
 #include "votca/csg/trajectoryreader.h"
 
@@ -66,11 +67,23 @@ class GROReader : public TrajectoryReader, public TopologyReader {
   /// read in the next frame
   bool NextFrame(Topology &top) override;
 
+  bool IsSeekable() const override { return true; }
+  Index FrameCount() override;
+  bool SeekFrame(Index frame) override;
+
   void Close() override;
 
  private:
+  /// offsets of the title lines
+  static void ScanFrames(std::istream &in, std::vector<std::int64_t> &offsets);
+
   std::ifstream fl_;
+  std::string fname_;
   bool topology_;
+
+  FrameIndex frame_index_;
+  /// frame read by the next call of NextFrame
+  Index next_frame_ = 0;
 };
 
 }  // namespace csg
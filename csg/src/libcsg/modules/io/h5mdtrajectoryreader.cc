@@ -124,6 +124,8 @@ void H5MDTrajectoryReader::Initialize(Topology &top) {
   CheckError(atom_position_group_,
              "Unable to open " + position_group_name + " group");
   idx_frame_ = -1;
+  block_begin_ = 0;
+  block_size_ = 0;
   ds_atom_position_ = H5Dopen(atom_position_group_, "value", H5P_DEFAULT);
   CheckError(ds_atom_position_,
              "Unable to open " + position_group_name + "/value dataset");
@@ -243,52 +245,41 @@ bool H5MDTrajectoryReader::FirstFrame(Topology &top) {  // NOLINT const
 
 /// Reading the data.
 bool H5MDTrajectoryReader::NextFrame(Topology &top) {  // NOLINT const reference
-  // Reads the position row.
   idx_frame_++;
   if (idx_frame_ > max_idx_frame_) {
     return false;
   }
+  if (idx_frame_ < block_begin_ || idx_frame_ >= block_begin_ + block_size_) {
+    if (!ReadBlock(idx_frame_)) {
+      return false;
+    }
+  }
+  Index row = idx_frame_ - block_begin_;
 
-  cout << '\r' << "Reading frame: " << idx_frame_ << "\n";
-  cout.flush();
   // Set volume of box because top on workers somehow does not have this
   // information.
   if (has_box_ == H5MDTrajectoryReader::TIMEDEPENDENT) {
-    std::unique_ptr<double[]> box = std::unique_ptr<double[]>{new double[3]};
-    ReadBox(ds_edges_group_, H5T_NATIVE_DOUBLE, idx_frame_, box);
+    const double *box = boxes_.data() + 3 * row;
     m = Eigen::Matrix3d::Zero();
-    m(0, 0) = box.get()[0] * length_scaling_;
-    m(1, 1) = box.get()[1] * length_scaling_;
-    m(2, 2) = box.get()[2] * length_scaling_;
-    cout << "Time dependent box:" << endl;
-    cout << m << endl;
+    m(0, 0) = box[0] * length_scaling_;
+    m(1, 1) = box[1] * length_scaling_;
+    m(2, 2) = box[2] * length_scaling_;
   }
   top.setBox(m);
 
-  double *positions;
-  double *forces = nullptr;
-  double *velocities = nullptr;
-  int *ids = nullptr;
-
-  try {
-    positions = ReadVectorData<double>(ds_atom_position_, H5T_NATIVE_DOUBLE,
-                                       idx_frame_);
-  } catch (const std::runtime_error &e) {
-    return false;
-  }
-
+  Index frame_size = N_particles_ * vec_components_;
+  const double *positions = positions_.data() + row * frame_size;
+  const double *velocities = nullptr;
+  const double *forces = nullptr;
+  const int *ids = nullptr;
   if (has_velocity_ != H5MDTrajectoryReader::NONE) {
-    velocities = ReadVectorData<double>(ds_atom_velocity_, H5T_NATIVE_DOUBLE,
-                                        idx_frame_);
+    velocities = velocities_.data() + row * frame_size;
   }
-
   if (has_force_ != H5MDTrajectoryReader::NONE) {
-    forces =
-        ReadVectorData<double>(ds_atom_force_, H5T_NATIVE_DOUBLE, idx_frame_);
+    forces = forces_.data() + row * frame_size;
   }
-
   if (has_id_group_ != H5MDTrajectoryReader::NONE) {
-    ids = ReadScalarData<int>(ds_atom_id_, H5T_NATIVE_INT, idx_frame_);
+    ids = ids_.data() + row * N_particles_;
   }
 
   // Process atoms.
@@ -333,38 +324,70 @@ bool H5MDTrajectoryReader::NextFrame(Topology &top) {  // NOLINT const reference
     }
   }
 
-  // Clean up pointers.
-  delete[] positions;
-  if (has_force_ == H5MDTrajectoryReader::TIMEDEPENDENT) {
-    delete[] forces;
+  return true;
+}
+
+Index H5MDTrajectoryReader::BlockFrames() const {
+  Index chunk_frames = 1;
+  hid_t plist = H5Dget_create_plist(ds_atom_position_);
+  if (plist >= 0) {
+    if (H5Pget_layout(plist) == H5D_CHUNKED) {
+      hsize_t chunk_dims[3] = {1, 1, 1};
+      if (H5Pget_chunk(plist, 3, chunk_dims) > 0 && chunk_dims[0] > 0) {
+        chunk_frames = Index(chunk_dims[0]);
+      }
+    }
+    H5Pclose(plist);
   }
-  if (has_velocity_ == H5MDTrajectoryReader::TIMEDEPENDENT) {
-    delete[] velocities;
+
+  // Bytes per frame over all time dependent datasets.
+  Index vectors = 1;
+  if (has_velocity_ != H5MDTrajectoryReader::NONE) {
+    vectors++;
   }
-  if (has_id_group_ == H5MDTrajectoryReader::TIMEDEPENDENT) {
-    delete[] ids;
+  if (has_force_ != H5MDTrajectoryReader::NONE) {
+    vectors++;
   }
-
-  return true;
+  std::size_t frame_bytes =
+      std::size_t(N_particles_ * vec_components_ * vectors) * sizeof(double) +
+      std::size_t(N_particles_) * sizeof(int) + 3 * sizeof(double);
+  // Whole chunks are read, as many as fit into the memory limit.
+  Index chunks =
+      std::max(Index(1), Index(block_memory_ / (frame_bytes * chunk_frames)));
+  return std::min(chunks * chunk_frames, max_idx_frame_ + 1);
 }
 
-void H5MDTrajectoryReader::ReadBox(hid_t ds, hid_t ds_data_type, Index row,
-                                   std::unique_ptr<double[]> &data_out) {
-  hsize_t offset[2];
-  offset[0] = row;
-  offset[1] = 0;
-  hsize_t ch_rows[2];
-  ch_rows[0] = 1;
-  ch_rows[1] = 3;
-  hid_t dsp = H5Dget_space(ds);
-  H5Sselect_hyperslab(dsp, H5S_SELECT_SET, offset, nullptr, ch_rows, nullptr);
-  hid_t mspace1 = H5Screate_simple(2, ch_rows, nullptr);
-  herr_t status =
-      H5Dread(ds, ds_data_type, mspace1, dsp, H5P_DEFAULT, data_out.get());
-  if (status < 0) {
-    throw std::runtime_error("Error ReadScalarData: " +
-                             boost::lexical_cast<std::string>(status));
+bool H5MDTrajectoryReader::ReadBlock(Index frame) {
+  Index block_frames = BlockFrames();
+  block_begin_ = (frame / block_frames) * block_frames;
+  block_size_ = std::min(block_frames, max_idx_frame_ + 1 - block_begin_);
+
+  try {
+    ReadRows<double>(ds_atom_position_, H5T_NATIVE_DOUBLE, block_begin_,
+                     block_size_, N_particles_, vec_components_, positions_);
+  } catch (const std::runtime_error &e) {
+    block_size_ = 0;
+    return false;
   }
+  if (has_box_ == H5MDTrajectoryReader::TIMEDEPENDENT) {
+    ReadRows<double>(ds_edges_group_, H5T_NATIVE_DOUBLE, block_begin_,
+                     block_size_, 3, 0, boxes_);
+  }
+  if (has_velocity_ != H5MDTrajectoryReader::NONE) {
+    ReadRows<double>(ds_atom_velocity_, H5T_NATIVE_DOUBLE, block_begin_,
+                     block_size_, N_particles_, vec_components_, velocities_);
+  }
+  if (has_force_ != H5MDTrajectoryReader::NONE) {
+    ReadRows<double>(ds_atom_force_, H5T_NATIVE_DOUBLE, block_begin_,
+                     block_size_, N_particles_, vec_components_, forces_);
+  }
+  if (has_id_group_ != H5MDTrajectoryReader::NONE) {
+    ReadRows<int>(ds_atom_id_, H5T_NATIVE_INT, block_begin_, block_size_,
+                  N_particles_, 0, ids_);
+  }
+  cout << "H5MD: read frames " << block_begin_ << " to "
+       << block_begin_ + block_size_ - 1 << "\n";
+  return true;
 }
 
 double H5MDTrajectoryReader::ReadScaleFactor(const hid_t &ds,
@@ -19,10 +19,12 @@
 #define VOTCA_CSG_H5MDTRAJECTORYREADER_PRIVATE_H
 
 // Standard includes
+#include <algorithm>
 #include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 
 // Third party includes
 #include <hdf5.h>
@@ -65,55 +67,37 @@ class H5MDTrajectoryReader : public TrajectoryReader {
   /// Closes original trajectory file.
   void Close() override;
 
+  /// Upper limit of the memory used by the frame buffers, at least one chunk
+  /// of frames is always read.
+  void setBlockMemory(std::size_t bytes) { block_memory_ = bytes; }
+
  private:
   enum DatasetState { NONE, STATIC, TIMEDEPENDENT };
 
-  /// Reads dataset that contains vectors.
+  /// Reads the rows [first, first + nrows) of a dataset with the shape
+  /// (frames, ncols) or, if ncomponents > 0, (frames, ncols, ncomponents)
+  /// with a single hyperslab selection. The buffer is only grown.
   template <typename T1>
-  T1 *ReadVectorData(hid_t ds, hid_t ds_data_type, Index row) {
-    hsize_t offset[3];
-    offset[0] = hsize_t(row);
-    offset[1] = 0;
-    offset[2] = 0;
-    hsize_t chunk_rows[3];
-    chunk_rows[0] = 1;
-    chunk_rows[1] = N_particles_;
-    chunk_rows[2] = vec_components_;
-    hid_t dsp = H5Dget_space(ds);
-    H5Sselect_hyperslab(dsp, H5S_SELECT_SET, offset, nullptr, chunk_rows,
-                        nullptr);
-    hid_t mspace1 = H5Screate_simple(vec_components_, chunk_rows, nullptr);
-    T1 *data_out = new T1[N_particles_ * vec_components_];
-    herr_t status =
-        H5Dread(ds, ds_data_type, mspace1, dsp, H5P_DEFAULT, data_out);
-    if (status < 0) {
-      throw std::runtime_error("Error ReadVectorData: " +
-                               boost::lexical_cast<std::string>(status));
-    } else {
-      return data_out;
+  void ReadRows(hid_t ds, hid_t ds_data_type, Index first, Index nrows,
+                Index ncols, Index ncomponents, std::vector<T1> &data_out) {
+    int rank = (ncomponents > 0) ? 3 : 2;
+    hsize_t offset[3] = {hsize_t(first), 0, 0};
+    hsize_t count[3] = {hsize_t(nrows), hsize_t(ncols), hsize_t(ncomponents)};
+    std::size_t size =
+        std::size_t(nrows * ncols * std::max(ncomponents, Index(1)));
+    if (data_out.size() < size) {
+      data_out.resize(size);
     }
-  }
-
-  /// Reads dataset with scalar values.
-  template <typename T1>
-  T1 *ReadScalarData(hid_t ds, hid_t ds_data_type, Index row) {
-    hsize_t offset[2];
-    offset[0] = row;
-    offset[1] = 0;
-    hsize_t ch_rows[2];
-    ch_rows[0] = 1;
-    ch_rows[1] = N_particles_;
     hid_t dsp = H5Dget_space(ds);
-    H5Sselect_hyperslab(dsp, H5S_SELECT_SET, offset, nullptr, ch_rows, nullptr);
-    hid_t mspace1 = H5Screate_simple(2, ch_rows, nullptr);
-    T1 *data_out = new T1[N_particles_];
+    H5Sselect_hyperslab(dsp, H5S_SELECT_SET, offset, nullptr, count, nullptr);
+    hid_t mspace = H5Screate_simple(rank, count, nullptr);
     herr_t status =
-        H5Dread(ds, ds_data_type, mspace1, dsp, H5P_DEFAULT, data_out);
+        H5Dread(ds, ds_data_type, mspace, dsp, H5P_DEFAULT, data_out.data());
+    H5Sclose(mspace);
+    H5Sclose(dsp);
     if (status < 0) {
-      throw std::runtime_error("Error ReadScalarData: " +
+      throw std::runtime_error("Error ReadRows: " +
                                boost::lexical_cast<std::string>(status));
-    } else {
-      return data_out;
     }
   }
 
@@ -127,8 +111,13 @@ class H5MDTrajectoryReader : public TrajectoryReader {
     }
   }
 
-  void ReadBox(hid_t ds, hid_t ds_data_type, Index row,
-               std::unique_ptr<double[]> &data_out);
+  /// Number of frames read with one HDF5 call, a multiple of the chunk
+  /// size of the position dataset.
+  Index BlockFrames() const;
+
+  /// Reads the block of frames containing frame into the buffers, returns
+  /// false if the positions can not be read.
+  bool ReadBlock(Index frame);
 
   double ReadScaleFactor(const hid_t &ds, const std::string &unit_type);
 
@@ -202,6 +191,17 @@ class H5MDTrajectoryReader : public TrajectoryReader {
 
   // Box matrix.
   Eigen::Matrix3d m;
+
+  // Frames [block_begin_, block_begin_ + block_size_) are in the buffers.
+  Index block_begin_ = 0;
+  Index block_size_ = 0;
+  // Upper limit of the memory used by the frame buffers.
+  std::size_t block_memory_ = std::size_t(64) << 20;
+  std::vector<double> positions_;
+  std::vector<double> velocities_;
+  std::vector<double> forces_;
+  std::vector<int> ids_;
+  std::vector<double> boxes_;
 };
 
 }  // namespace csg
@@ -16,6 +16,7 @@
  */
 
 // Standard includes
+#include <charconv>
 #include <memory>
 #include <vector>
 
@@ -39,6 +40,7 @@ bool LAMMPSDumpReader::ReadTopology(string file, Topology &top) {
   topology_ = true;
   top.Cleanup();
 
+  SetReadBuffer();
   fl_.open(file);
   if (!fl_.is_open()) {
     throw std::ios_base::failure("Error on open topology file: " + file);
@@ -53,16 +55,62 @@ bool LAMMPSDumpReader::ReadTopology(string file, Topology &top) {
 }
 
 bool LAMMPSDumpReader::Open(const string &file) {
+  SetReadBuffer();
   fl_.open(file);
   if (!fl_.is_open()) {
     throw std::ios_base::failure("Error on open trajectory file: " + file);
   }
   fname_ = file;
+  next_frame_ = 0;
+  frame_index_ = FrameIndex();
   return true;
 }
 
 void LAMMPSDumpReader::Close() { fl_.close(); }
 
+Index LAMMPSDumpReader::FrameCount() {
+  if (frame_index_.empty()) {
+    frame_index_.Build(fname_, "lammpsdump", ScanFrames, save_frame_index_);
+  }
+  return frame_index_.size();
+}
+
+bool LAMMPSDumpReader::SeekFrame(Index frame) {
+  if (frame == next_frame_) {
+    return true;
+  }
+  if (frame_index_.empty()) {
+    frame_index_.Build(fname_, "lammpsdump", ScanFrames, save_frame_index_);
+  }
+  if (frame < 0 || frame >= frame_index_.size()) {
+    return false;
+  }
+  fl_.clear();
+  fl_.seekg(frame_index_.Offset(frame));
+  next_frame_ = frame;
+  return bool(fl_);
+}
+
+void LAMMPSDumpReader::ScanFrames(std::istream &in,
+                                  std::vector<std::int64_t> &offsets) {
+  string line;
+  std::int64_t offset = 0;
+  std::int64_t line_begin = offset;
+  while (FrameIndex::SkipLine(in, line, offset)) {
+    if (line.compare(0, 14, "ITEM: TIMESTEP") == 0) {
+      offsets.push_back(line_begin);
+    }
+    line_begin = offset;
+  }
+}
+
+void LAMMPSDumpReader::SetReadBuffer() {
+  // dump files are read sequentially, a large buffer reduces the number of
+  // read calls
+  read_buffer_.resize(1 << 20);
+  fl_.rdbuf()->pubsetbuf(read_buffer_.data(), read_buffer_.size());
+}
+
 bool LAMMPSDumpReader::FirstFrame(Topology &top) {
   topology_ = false;
   NextFrame(top);
@@ -99,8 +147,11 @@ bool LAMMPSDumpReader::NextFrame(Topology &top) {
     cout << "WARNING: topology created from .dump file, masses, charges, "
             "types, residue names are wrong!\n";
   }
-  return !fl_.eof();
-  ;
+  if (fl_.eof()) {
+    return false;
+  }
+  next_frame_++;
+  return true;
 }
 
 void LAMMPSDumpReader::ReadTimestep(Topology &top) {
@@ -149,42 +200,17 @@ void LAMMPSDumpReader::ReadAtoms(Topology &top, string itemline) {
     }
   }
 
-  bool pos = false;
-  bool force = false;
-  bool vel = false;
-  Index id = -1;
-
-  vector<string> fields;
-
-  {
-    tools::Tokenizer tok(itemline.substr(12), " ");
-    fields = tok.ToVector();
-    Index j = 0;
-    for (tools::Tokenizer::iterator i = tok.begin(); i != tok.end(); ++i, ++j) {
-      if (*i == "x" || *i == "y" || *i == "z") {
-        pos = true;
-      } else if (*i == "xu" || *i == "yu" || *i == "zu") {
-        pos = true;
-      } else if (*i == "xs" || *i == "ys" || *i == "zs") {
-        pos = true;
-      } else if (*i == "vx" || *i == "vy" || *i == "vz") {
-        vel = true;
-      } else if (*i == "fx" || *i == "fy" || *i == "fz") {
-        force = true;
-      } else if (*i == "id") {
-        id = j;
-      }
-    }
-  }
-  if (id < 0) {
-    throw std::runtime_error(
-        "error, id not found in any column of the atoms section");
+  if (itemline != columns_header_) {
+    ParseColumns(itemline);
   }
 
+  const Eigen::Matrix3d box = top.getBox();  // already in nm
+  const double force_scale = tools::conv::kcal2kj / tools::conv::ang2nm;
+  const Index ncolumns = Index(columns_.size());
+  values_.resize(ncolumns);
+
   for (Index i = 0; i < natoms_; ++i) {
-    string s;
-    tools::getline(fl_, s);
-    boost::algorithm::trim(s);
+    std::getline(fl_, line_);
     if (fl_.eof()) {
       throw std::runtime_error("Error: unexpected end of lammps file '" +
                                fname_ + "' only " +
@@ -192,66 +218,181 @@ void LAMMPSDumpReader::ReadAtoms(Topology &top, string itemline) {
                                boost::lexical_cast<string>(natoms_) + " read.");
     }
 
-    tools::Tokenizer tok(s, " ");
-    tools::Tokenizer::iterator itok = tok.begin();
-    vector<string> fields2 = tok.ToVector();
+    // tokenize in place, every column is converted according to the layout
+    // of the header
+    const char *p = line_.data();
+    const char *end = p + line_.size();
+    Index atom_id = -1;
+    const char *type_begin = nullptr;
+    const char *type_end = nullptr;
+    Index j = 0;
+    while (true) {
+      while (p != end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+        ++p;
+      }
+      if (p == end) {
+        break;
+      }
+      const char *token_end = p;
+      while (token_end != end && *token_end != ' ' && *token_end != '\t' &&
+             *token_end != '\r') {
+        ++token_end;
+      }
+      if (j == ncolumns) {
+        throw std::runtime_error(
+            "error, wrong number of columns in atoms section");
+      }
+      std::from_chars_result result{token_end, std::errc()};
+      switch (columns_[j]) {
+        case Column::ignore:
+          break;
+        case Column::id:
+          result = std::from_chars(p, token_end, atom_id);
+          break;
+        case Column::type:
+          type_begin = p;
+          type_end = token_end;
+          break;
+        default:
+          result = std::from_chars(p, token_end, values_[j]);
+          break;
+      }
+      if (result.ec != std::errc() || result.ptr != token_end) {
+        throw std::runtime_error("error, cannot convert '" +
+                                 string(p, token_end) + "' in lammps file '" +
+                                 fname_ + "'");
+      }
+      p = token_end;
+      ++j;
+    }
+    if (j != ncolumns) {
+      throw std::runtime_error(
+          "error, wrong number of columns in atoms section");
+    }
+
     // internal numbering begins with 0
-    Index atom_id = boost::lexical_cast<Index>(fields2[id]);
-    if (atom_id > natoms_) {
+    if (atom_id < 1 || atom_id > natoms_) {
       throw std::runtime_error(
           "Error: found atom with id " + boost::lexical_cast<string>(atom_id) +
           " but only " + boost::lexical_cast<string>(natoms_) +
           " atoms defined in header of file '" + fname_ + "'");
     }
     Bead *b = top.getBead(atom_id - 1);
-    b->HasPos(pos);
-    b->HasF(force);
-    b->HasVel(vel);
-    Eigen::Matrix3d m = top.getBox();
+    b->HasPos(has_pos_);
+    b->HasF(has_force_);
+    b->HasVel(has_vel_);
 
-    for (size_t j = 0; itok != tok.end(); ++itok, ++j) {
-      if (j == fields.size()) {
-        throw std::runtime_error(
-            "error, wrong number of columns in atoms section");
-      } else if (fields[j] == "x") {
-        b->Pos().x() = stod(*itok) * tools::conv::ang2nm;
-      } else if (fields[j] == "y") {
-        b->Pos().y() = stod(*itok) * tools::conv::ang2nm;
-      } else if (fields[j] == "z") {
-        b->Pos().z() = stod(*itok) * tools::conv::ang2nm;
-      } else if (fields[j] == "xu") {
-        b->Pos().x() = stod(*itok) * tools::conv::ang2nm;
-      } else if (fields[j] == "yu") {
-        b->Pos().y() = stod(*itok) * tools::conv::ang2nm;
-      } else if (fields[j] == "zu") {
-        b->Pos().z() = stod(*itok) * tools::conv::ang2nm;
-      } else if (fields[j] == "xs") {
-        b->Pos().x() = stod(*itok) * m(0, 0);  // box is already in nm
-      } else if (fields[j] == "ys") {
-        b->Pos().y() = stod(*itok) * m(1, 1);  // box is already in nm
-      } else if (fields[j] == "zs") {
-        b->Pos().z() = stod(*itok) * m(2, 2);  // box is already in nm
-      } else if (fields[j] == "vx") {
-        b->Vel().x() = stod(*itok) * tools::conv::ang2nm;
-      } else if (fields[j] == "vy") {
-        b->Vel().y() = stod(*itok) * tools::conv::ang2nm;
-      } else if (fields[j] == "vz") {
-        b->Vel().z() = stod(*itok) * tools::conv::ang2nm;
-      } else if (fields[j] == "fx") {
-        b->F().x() = stod(*itok) * tools::conv::kcal2kj / tools::conv::ang2nm;
-      } else if (fields[j] == "fy") {
-        b->F().y() = stod(*itok) * tools::conv::kcal2kj / tools::conv::ang2nm;
-      } else if (fields[j] == "fz") {
-        b->F().z() = stod(*itok) * tools::conv::kcal2kj / tools::conv::ang2nm;
-      } else if ((fields[j] == "type") && topology_) {
-        if (!top.BeadTypeExist(*itok)) {
-          top.RegisterBeadType(*itok);
-        }
-        b->setType(*itok);
+    for (j = 0; j < ncolumns; ++j) {
+      const double value = values_[j];
+      switch (columns_[j]) {
+        case Column::x:
+          b->Pos().x() = value * tools::conv::ang2nm;
+          break;
+        case Column::y:
+          b->Pos().y() = value * tools::conv::ang2nm;
+          break;
+        case Column::z:
+          b->Pos().z() = value * tools::conv::ang2nm;
+          break;
+        case Column::xs:
+          b->Pos().x() = value * box(0, 0);
+          break;
+        case Column::ys:
+          b->Pos().y() = value * box(1, 1);
+          break;
+        case Column::zs:
+          b->Pos().z() = value * box(2, 2);
+          break;
+        case Column::vx:
+          b->Vel().x() = value * tools::conv::ang2nm;
+          break;
+        case Column::vy:
+          b->Vel().y() = value * tools::conv::ang2nm;
+          break;
+        case Column::vz:
+          b->Vel().z() = value * tools::conv::ang2nm;
+          break;
+        case Column::fx:
+          b->F().x() = value * force_scale;
+          break;
+        case Column::fy:
+          b->F().y() = value * force_scale;
+          break;
+        case Column::fz:
+          b->F().z() = value * force_scale;
+          break;
+        case Column::type:
+          if (topology_) {
+            string type(type_begin, type_end);
+            if (!top.BeadTypeExist(type)) {
+              top.RegisterBeadType(type);
+            }
+            b->setType(type);
+          }
+          break;
+        default:
+          break;
       }
     }
   }
 }
 
+void LAMMPSDumpReader::ParseColumns(const string &itemline) {
+  columns_.clear();
+  has_pos_ = false;
+  has_vel_ = false;
+  has_force_ = false;
+  bool has_id = false;
+
+  tools::Tokenizer tok(itemline.substr(12), " ");
+  for (const string &field : tok) {
+    Column column = Column::ignore;
+    if (field == "x" || field == "xu") {
+      column = Column::x;
+    } else if (field == "y" || field == "yu") {
+      column = Column::y;
+    } else if (field == "z" || field == "zu") {
+      column = Column::z;
+    } else if (field == "xs") {
+      column = Column::xs;
+    } else if (field == "ys") {
+      column = Column::ys;
+    } else if (field == "zs") {
+      column = Column::zs;
+    } else if (field == "vx") {
+      column = Column::vx;
+    } else if (field == "vy") {
+      column = Column::vy;
+    } else if (field == "vz") {
+      column = Column::vz;
+    } else if (field == "fx") {
+      column = Column::fx;
+    } else if (field == "fy") {
+      column = Column::fy;
+    } else if (field == "fz") {
+      column = Column::fz;
+    } else if (field == "id") {
+      column = Column::id;
+      has_id = true;
+    } else if (field == "type") {
+      column = Column::type;
+    }
+    has_pos_ = has_pos_ || column == Column::x || column == Column::y ||
+               column == Column::z || column == Column::xs ||
+               column == Column::ys || column == Column::zs;
+    has_vel_ = has_vel_ || column == Column::vx || column == Column::vy ||
+               column == Column::vz;
+    has_force_ = has_force_ || column == Column::fx || column == Column::fy ||
+                 column == Column::fz;
+    columns_.push_back(column);
+  }
+  if (!has_id) {
+    columns_header_.clear();
+    throw std::runtime_error(
+        "error, id not found in any column of the atoms section");
+  }
+  columns_header_ = itemline;
+}
+
 }  // namespace csg
 }  // namespace votca
@@ -18,11 +18,13 @@
 #ifndef VOTCA_CSG_LAMMPSDUMPREADER_H
 #define VOTCA_CSG_LAMMPSDUMPREADER_H
 
+#include "../../../../include/votca/csg/frameindex.h"
 #include "../../../../include/votca/csg/topologyreader.h"
 #include "../../../../include/votca/csg/trajectoryreader.h"
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 #include <votca/tools/unitconverter.h>
 
 namespace votca {
@@ -62,18 +64,63 @@ class LAMMPSDumpReader : public TrajectoryReader, public TopologyReader {
   /// read in the next frame
   bool NextFrame(Topology &top) override;
 
+  bool IsSeekable() const override { return true; }
+  Index FrameCount() override;
+  bool SeekFrame(Index frame) override;
+
   void Close() override;
 
  private:
+  /// offsets of the "ITEM: TIMESTEP" lines
+  static void ScanFrames(std::istream &in, std::vector<std::int64_t> &offsets);
   void ReadTimestep(Topology &top);
   void ReadBox(Topology &top);
   void ReadNumAtoms(Topology &top);
   void ReadAtoms(Topology &top, std::string itemline);
 
+  /// quantity stored in a column of the atoms section
+  enum class Column {
+    ignore,
+    id,
+    type,
+    x,  // also the unwrapped xu
+    y,
+    z,
+    xs,  // scaled coordinates
+    ys,
+    zs,
+    vx,
+    vy,
+    vz,
+    fx,
+    fy,
+    fz
+  };
+  /// resolve the column layout of an atoms header into columns_
+  void ParseColumns(const std::string &itemline);
+  /// large stream buffer, has to be installed before the file is opened
+  void SetReadBuffer();
+
   std::ifstream fl_;
   std::string fname_;
   bool topology_;
   Index natoms_;
+
+  /// column layout of the last atoms header, only rebuilt if it changes
+  std::string columns_header_;
+  std::vector<Column> columns_;
+  bool has_pos_ = false;
+  bool has_vel_ = false;
+  bool has_force_ = false;
+
+  /// buffers reused for every atom line and frame
+  std::string line_;
+  std::vector<double> values_;
+  std::vector<char> read_buffer_;
+
+  FrameIndex frame_index_;
+  /// frame read by the next call of NextFrame
+  Index next_frame_ = 0;
 };
 
 }  // namespace csg
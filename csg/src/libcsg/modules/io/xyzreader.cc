@@ -56,6 +56,8 @@ bool XYZReader::Open(const string &file) {
     throw std::ios_base::failure("Error on open trajectory file: " + file);
   }
   line_ = 0;
+  next_frame_ = 0;
+  frame_index_ = FrameIndex();
   return true;
 }
 
@@ -65,8 +67,62 @@ bool XYZReader::FirstFrame(Topology &top) { return NextFrame(top); }
 
 bool XYZReader::NextFrame(Topology &top) {
   bool success = ReadFrame<false, Topology>(top);
+  if (success) {
+    next_frame_++;
+  }
   return success;
 }
 
+Index XYZReader::FrameCount() {
+  if (frame_index_.empty()) {
+    frame_index_.Build(file_, "xyz", ScanFrames, save_frame_index_);
+  }
+  return frame_index_.size();
+}
+
+bool XYZReader::SeekFrame(Index frame) {
+  if (frame == next_frame_) {
+    return true;
+  }
+  if (frame_index_.empty()) {
+    frame_index_.Build(file_, "xyz", ScanFrames, save_frame_index_);
+  }
+  if (frame < 0 || frame >= frame_index_.size()) {
+    return false;
+  }
+  fl_.clear();
+  fl_.seekg(frame_index_.Offset(frame));
+  next_frame_ = frame;
+  // line numbers in error messages are not known after a seek
+  line_ = 0;
+  return bool(fl_);
+}
+
+void XYZReader::ScanFrames(std::istream &in,
+                           std::vector<std::int64_t> &offsets) {
+  string line;
+  std::int64_t offset = 0;
+  while (true) {
+    std::int64_t frame_begin = offset;
+    if (!FrameIndex::SkipLine(in, line, offset)) {
+      break;
+    }
+    tools::Tokenizer tok(line, " \t\r");
+    std::vector<std::string> fields = tok.ToVector();
+    if (fields.size() != 1) {
+      // trailing empty lines
+      break;
+    }
+    Index natoms = boost::lexical_cast<Index>(fields[0]);
+    offsets.push_back(frame_begin);
+    // title and atoms
+    for (Index i = 0; i < natoms + 1; i++) {
+      if (!FrameIndex::SkipLine(in, line, offset)) {
+        return;
+      }
+    }
+  }
+}
+
 }  // namespace csg
 }  // namespace votca
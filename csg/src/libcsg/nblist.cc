@@ -1,5 +1,5 @@
 /*
- * Copyright 2009-2020 The VOTCA Development Team (http://www.votca.org)
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -16,7 +16,13 @@
  */
 
 // Standard library includes
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <unordered_set>
+
+// Third party includes
+#include <Eigen/SVD>
 
 // Local VOTCA includes
 #include "votca/csg/nblist.h"
@@ -35,18 +41,177 @@ NBList::~NBList() {
 }
 
 void NBList::Generate(BeadList &list1, BeadList &list2, bool do_exclusions) {
-  BeadList::iterator iter1;
-  BeadList::iterator iter2;
   do_exclusions_ = do_exclusions;
-
   if (list1.empty()) {
     return;
   }
   if (list2.empty()) {
     return;
   }
-
   assert(&(list1.getTopology()) == &(list2.getTopology()));
+
+  if (skin_ > 0) {
+    GenerateVerlet(list1, list2);
+  } else {
+    Search(list1, list2, cutoff_);
+  }
+}
+
+void NBList::Generate(BeadList &list, bool do_exclusions) {
+  do_exclusions_ = do_exclusions;
+  if (list.empty()) {
+    return;
+  }
+
+  if (skin_ > 0) {
+    GenerateVerlet(list, list);
+  } else {
+    Search(list, cutoff_);
+  }
+}
+
+void NBList::GenerateVerlet(BeadList &list1, BeadList &list2) {
+  const Topology &top = list1.getTopology();
+
+  if (CandidatesOutdated(top, list1, list2)) {
+    candidates_.clear();
+    collect_candidates_ = true;
+    if (&list1 == &list2) {
+      Search(list1, cutoff_ + skin_);
+    } else {
+      Search(list1, list2, cutoff_ + skin_);
+    }
+    collect_candidates_ = false;
+    if (&list1 != &list2) {
+      RemoveDuplicateCandidates();
+    }
+
+    ref_beads_.clear();
+    ref_pos_.clear();
+    for (Bead *bead : list1) {
+      ref_beads_.push_back(bead);
+      ref_pos_.push_back(bead->getPos());
+    }
+    if (&list1 != &list2) {
+      for (Bead *bead : list2) {
+        ref_beads_.push_back(bead);
+        ref_pos_.push_back(bead->getPos());
+      }
+    }
+    ref_box_ = top.getBox();
+    ref_exclusions_ = do_exclusions_;
+    rebuilds_++;
+  }
+
+  for (const auto &candidate : candidates_) {
+    Eigen::Vector3d r = top.BCShortestConnection(candidate.first->getPos(),
+                                                 candidate.second->getPos());
+    double d = r.norm();
+    if (d < cutoff_) {
+      AcceptPair(candidate.first, candidate.second, r, d);
+    }
+  }
+}
+
+void NBList::RemoveDuplicateCandidates() {
+  // overlapping lists yield a pair twice, keep the first one like FindPair
+  // does in Search
+  std::unordered_set<std::pair<Bead *, Bead *>, bead_pair_hash> seen;
+  seen.reserve(candidates_.size());
+  auto duplicate = [&seen](const std::pair<Bead *, Bead *> &candidate) {
+    return !seen.insert(std::minmax(candidate.first, candidate.second)).second;
+  };
+  candidates_.erase(
+      std::remove_if(candidates_.begin(), candidates_.end(), duplicate),
+      candidates_.end());
+}
+
+void NBList::FindSharedBeads(BeadList &list1, BeadList &list2) {
+  std::unordered_set<Bead *> beads1(list1.begin(), list1.end());
+  for (Bead *bead : list2) {
+    if (beads1.count(bead) > 0) {
+      shared_beads_.insert(bead);
+    }
+  }
+}
+
+void NBList::ResetVisitor() {
+  pair_visitor_ = nullptr;
+  visitor_context_ = nullptr;
+  visit_buffer_.clear();
+  shared_beads_.clear();
+  visited_shared_.clear();
+}
+
+bool NBList::CandidatesOutdated(const Topology &top, BeadList &list1,
+                                BeadList &list2) const {
+  if (ref_beads_.empty() || ref_exclusions_ != do_exclusions_) {
+    return true;
+  }
+  Index nbeads = list1.size();
+  if (&list1 != &list2) {
+    nbeads += list2.size();
+  }
+  if (nbeads != Index(ref_beads_.size())) {
+    return true;
+  }
+
+  // A change of the box is treated as an affine deformation M of the
+  // reference configuration, the beads move relative to their scaled
+  // reference positions. A pair outside cutoff + skin is then at least
+  // s_min(M) * (cutoff + skin) - 2 * max_displacement apart, where s_min is
+  // the smallest singular value of M, and has to stay outside the cutoff.
+  Eigen::Matrix3d deformation = Eigen::Matrix3d::Identity();
+  double shrink = 1.0;
+  const Eigen::Matrix3d &box = top.getBox();
+  if (top.getBoxType() != BoundaryCondition::typeOpen && box != ref_box_) {
+    if (std::abs(ref_box_.determinant()) < 1e-12) {
+      return true;
+    }
+    deformation = box * ref_box_.inverse();
+    Eigen::JacobiSVD<Eigen::Matrix3d> svd(deformation);
+    const Eigen::Vector3d singular_values = svd.singularValues();
+    shrink = singular_values.minCoeff();
+  }
+  const double budget = 0.5 * (shrink * (cutoff_ + skin_) - cutoff_);
+  if (budget <= 0) {
+    return true;
+  }
+  const double max_displacement2 = budget * budget;
+  Index i = 0;
+  auto moved = [&](BeadList &list) {
+    for (Bead *bead : list) {
+      if (bead != ref_beads_[i]) {
+        return true;
+      }
+      if (top.BCShortestConnection(deformation * ref_pos_[i], bead->getPos())
+              .squaredNorm() > max_displacement2) {
+        return true;
+      }
+      ++i;
+    }
+    return false;
+  };
+  if (moved(list1)) {
+    return true;
+  }
+  return (&list1 != &list2) && moved(list2);
+}
+
+void NBList::ProcessPair(const Topology &top, Bead *bead1, Bead *bead2,
+                         const Eigen::Vector3d &r, double dist) {
+  if (do_exclusions_) {
+    if (top.getExclusions().IsExcluded(bead1, bead2)) {
+      return;
+    }
+  }
+  StorePair(bead1, bead2, r, dist);
+}
+
+void NBList::Search(BeadList &list1, BeadList &list2, double radius) {
+  BeadList::iterator iter1;
+  BeadList::iterator iter2;
+
   const Topology &top = list1.getTopology();
 
   for (iter1 = list1.begin(); iter1 != list1.end(); ++iter1) {
@@ -70,16 +235,9 @@ void NBList::Generate(BeadList &list1, BeadList &list2, bool do_exclusions) {
 
       Eigen::Vector3d r = top.BCShortestConnection(u, v);
       double d = r.norm();
-      if (d < cutoff_) {
-        if (do_exclusions_) {
-          if (top.getExclusions().IsExcluded(*iter1, *iter2)) {
-            continue;
-          }
-        }
-        if ((*match_function_)(*iter1, *iter2, r, d)) {
-          if (!FindPair(*iter1, *iter2)) {
-            AddPair(pair_creator_(*iter1, *iter2, r));
-          }
+      if (d < radius) {
+        if (!FindPair(*iter1, *iter2)) {
+          ProcessPair(top, *iter1, *iter2, r, d);
         }
       }
     }
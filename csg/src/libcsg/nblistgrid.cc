@@ -1,5 +1,5 @@
 /*
- * Copyright 2009-2020 The VOTCA Development Team (http://www.votca.org)
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -15,137 +15,217 @@
  *
  */
 
+// Standard includes
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
 // Local VOTCA includes
 #include "votca/csg/nblistgrid.h"
 #include "votca/csg/topology.h"
-#include "votca/tools/NDimVector.h"
 
 namespace votca {
 namespace csg {
 
 using namespace std;
 
-void NBListGrid::Generate(BeadList &list1, BeadList &list2,
-                          bool do_exclusions) {
+void NBListGrid::Search(BeadList &list1, BeadList &list2, double radius) {
+  const Topology &top = list1.getTopology();
 
-  do_exclusions_ = do_exclusions;
-  if (list1.empty()) {
-    return;
-  }
-  if (list2.empty()) {
+  InitializeGrid(top, radius);
+  Index nthreads = getThreads(list2.size());
+  BinBeads(list1, nthreads);
+  thread_data_.resize(nthreads);
+
+  // the two lists are not symmetric, so every bead of list2 is tested against
+  // the full shell of list1 cells, which still yields every pair only once
+  auto search_beads = [&](Index begin, Index end, scratch_t &scratch,
+                          auto &&sink) {
+    for (auto bead = list2.begin() + begin; bead != list2.begin() + end;
+         ++bead) {
+      Index cell = getCell((*bead)->getPos());
+      TestRange(top, *bead, cell_begin_[cell], cell_begin_[cell + 1], scratch,
+                sink);
+      for (Index n = neighbour_begin_[cell]; n < neighbour_begin_[cell + 1];
+           ++n) {
+        Index neighbour = neighbours_[n];
+        TestRange(top, *bead, cell_begin_[neighbour],
+                  cell_begin_[neighbour + 1], scratch, sink);
+      }
+    }
+  };
+
+  if (nthreads == 1) {
+    // overlapping lists would otherwise report a pair twice
+    search_beads(
+        0, list2.size(), thread_data_[0].scratch_,
+        [&](Bead *bead1, Bead *bead2, const Eigen::Vector3d &r, double dist) {
+          if (!FindPair(bead1, bead2)) {
+            ProcessPair(top, bead1, bead2, r, dist);
+          }
+        });
     return;
   }
 
-  assert(&(list1.getTopology()) == &(list2.getTopology()));
-  const Topology &top = list1.getTopology();
+  ParallelFor(team_.get(), nthreads, [&](Index thread) {
+    thread_data_t &data = thread_data_[thread];
+    data.pairs_.clear();
+    search_beads(
+        ChunkBegin(list2.size(), nthreads, thread),
+        ChunkBegin(list2.size(), nthreads, thread + 1), data.scratch_,
+        [&](Bead *bead1, Bead *bead2, const Eigen::Vector3d &r, double dist) {
+          if (!do_exclusions_ ||
+              !top.getExclusions().IsExcluded(bead1, bead2)) {
+            data.pairs_.push_back({bead1, bead2, r, dist});
+          }
+        });
+  });
+  MergePairs(nthreads, true);
+}
 
-  InitializeGrid(top.getBox());
+void NBListGrid::Search(BeadList &list, double radius) {
+  const Topology &top = list.getTopology();
 
-  // Add all beads of list1
-  for (auto &iter : list1) {
-    getCell(iter->getPos()).beads_.push_back(iter);
-  }
+  InitializeGrid(top, radius);
+  Index nthreads = getThreads(getNumberOfCells());
+  BinBeads(list, nthreads);
+  thread_data_.resize(nthreads);
 
-  for (auto &iter : list2) {
-    cell_t &cell = getCell(iter->getPos());
-    TestBead(top, cell, iter);
+  if (nthreads == 1) {
+    SearchCells(top, 0, getNumberOfCells(), thread_data_[0].scratch_,
+                [&](Bead *bead1, Bead *bead2, const Eigen::Vector3d &r,
+                    double dist) { ProcessPair(top, bead1, bead2, r, dist); });
+    return;
   }
-}
 
-void NBListGrid::Generate(BeadList &list, bool do_exclusions) {
-  do_exclusions_ = do_exclusions;
-  if (list.empty()) {
-    return;
+  // slabs of consecutive cells with roughly the same number of beads, merging
+  // them in order reproduces the order of the serial search
+  std::vector<Index> slab_begin(nthreads + 1, getNumberOfCells());
+  slab_begin[0] = 0;
+  for (Index thread = 1; thread < nthreads; ++thread) {
+    Index first_bead = ChunkBegin(list.size(), nthreads, thread);
+    slab_begin[thread] = std::lower_bound(cell_begin_.begin(),
+                                          cell_begin_.end() - 1, first_bead) -
+                         cell_begin_.begin();
   }
 
-  const Topology &top = list.getTopology();
+  ParallelFor(team_.get(), nthreads, [&](Index thread) {
+    thread_data_t &data = thread_data_[thread];
+    data.pairs_.clear();
+    SearchCells(
+        top, slab_begin[thread], slab_begin[thread + 1], data.scratch_,
+        [&](Bead *bead1, Bead *bead2, const Eigen::Vector3d &r, double dist) {
+          if (!do_exclusions_ ||
+              !top.getExclusions().IsExcluded(bead1, bead2)) {
+            data.pairs_.push_back({bead1, bead2, r, dist});
+          }
+        });
+  });
+  MergePairs(nthreads, false);
+}
 
-  InitializeGrid(top.getBox());
+void NBListGrid::MergePairs(Index nthreads, bool check_duplicates) {
+  for (Index thread = 0; thread < nthreads; ++thread) {
+    for (const found_pair_t &pair : thread_data_[thread].pairs_) {
+      if (check_duplicates && FindPair(pair.bead1_, pair.bead2_)) {
+        continue;
+      }
+      StorePair(pair.bead1_, pair.bead2_, pair.r_, pair.dist_);
+    }
+    thread_data_[thread].pairs_.clear();
+  }
+}
 
-  for (auto &iter : list) {
-    cell_t &cell = getCell(iter->getPos());
-    TestBead(top, cell, iter);
-    getCell(iter->getPos()).beads_.push_back(iter);
+template <typename Sink>
+void NBListGrid::SearchCells(const Topology &top, Index cell_begin,
+                             Index cell_end, scratch_t &scratch,
+                             Sink &&sink) const {
+  // half-shell: pairs inside a cell and with all neighbouring cells of
+  // higher index, every cell pair is therefore visited exactly once
+  for (Index cell = cell_begin; cell < cell_end; ++cell) {
+    for (Index i = cell_begin_[cell]; i < cell_begin_[cell + 1]; ++i) {
+      TestRangeOrdered(top, i, i + 1, cell_begin_[cell + 1], scratch, sink);
+      for (Index n = neighbour_begin_[cell]; n < neighbour_begin_[cell + 1];
+           ++n) {
+        Index neighbour = neighbours_[n];
+        if (neighbour < cell) {
+          continue;
+        }
+        TestRangeOrdered(top, i, cell_begin_[neighbour],
+                         cell_begin_[neighbour + 1], scratch, sink);
+      }
+    }
   }
 }
-void NBListGrid::InitializeGrid(const Eigen::Matrix3d &box) {
-  box_a_ = box.col(0);
-  box_b_ = box.col(1);
-  box_c_ = box.col(2);
+
+void NBListGrid::InitializeGrid(const Topology &top, double radius) {
+  const Eigen::Matrix3d &box = top.getBox();
+  Eigen::Vector3d box_a = box.col(0);
+  Eigen::Vector3d box_b = box.col(1);
+  Eigen::Vector3d box_c = box.col(2);
+
+  orthorhombic_ = (top.getBoxType() == BoundaryCondition::typeOrthorhombic);
+  box_diag_ = box.diagonal().array();
+  inv_box_diag_ = box_diag_.inverse();
 
   // create plane normals
-  norm_a_ = box_b_.cross(box_c_);
-  norm_b_ = box_c_.cross(box_a_);
-  norm_c_ = box_a_.cross(box_b_);
+  norm_a_ = box_b.cross(box_c);
+  norm_b_ = box_c.cross(box_a);
+  norm_c_ = box_a.cross(box_b);
 
   norm_a_.normalize();
   norm_b_.normalize();
   norm_c_.normalize();
 
-  double la = box_a_.dot(norm_a_);
-  double lb = box_b_.dot(norm_b_);
-  double lc = box_c_.dot(norm_c_);
+  double la = box_a.dot(norm_a_);
+  double lb = box_b.dot(norm_b_);
+  double lc = box_c.dot(norm_c_);
 
   // calculate grid size, each grid has to be at least size of cut-off
-  box_Na_ = Index(std::max(std::abs(la / cutoff_), 1.0));
-  box_Nb_ = Index(std::max(std::abs(lb / cutoff_), 1.0));
-  box_Nc_ = Index(std::max(std::abs(lc / cutoff_), 1.0));
-
-  norm_a_ = norm_a_ / box_a_.dot(norm_a_) * (double)box_Na_;
-  norm_b_ = norm_b_ / box_b_.dot(norm_b_) * (double)box_Nb_;
-  norm_c_ = norm_c_ / box_c_.dot(norm_c_) * (double)box_Nc_;
-
-  grid_ = tools::NDimVector<cell_t, 3>(box_Na_, box_Nb_, box_Nc_);
-
-  Index a1, a2, b1, b2, c1, c2;
-
-  a1 = b1 = c1 = -1;
-  a2 = b2 = c2 = 1;
-
-  if (box_Na_ < 3) {
-    a2 = 0;
-  }
-  if (box_Nb_ < 3) {
-    b2 = 0;
-  }
-  if (box_Nc_ < 3) {
-    c2 = 0;
-  }
-
-  if (box_Na_ < 2) {
-    a1 = 0;
-  }
-  if (box_Nb_ < 2) {
-    b1 = 0;
-  }
-  if (box_Nc_ < 2) {
-    c1 = 0;
-  }
-
-  // wow, setting up the neighbours is an ugly for construct!
-  // loop from N..2*N to avoid if and only use %
-  for (Index a = box_Na_; a < 2 * box_Na_; ++a) {
-    for (Index b = box_Nb_; b < 2 * box_Nb_; ++b) {
-      for (Index c = box_Nc_; c < 2 * box_Nc_; ++c) {
-        cell_t &cell = grid_(a % box_Na_, b % box_Nb_, c % box_Nc_);
-        for (Index aa = a + a1; aa <= a + a2; ++aa) {
-          for (Index bb = b + b1; bb <= b + b2; ++bb) {
-            for (Index cc = c + c1; cc <= c + c2; ++cc) {
-              cell_t *cell2 = &grid_(aa % box_Na_, bb % box_Nb_, cc % box_Nc_);
-              if (cell2 == &cell) {
-                continue;  // ignore self
+  radius2_ = radius * radius;
+  box_Na_ = Index(std::max(std::abs(la / radius), 1.0));
+  box_Nb_ = Index(std::max(std::abs(lb / radius), 1.0));
+  box_Nc_ = Index(std::max(std::abs(lc / radius), 1.0));
+
+  norm_a_ = norm_a_ / box_a.dot(norm_a_) * (double)box_Na_;
+  norm_b_ = norm_b_ / box_b.dot(norm_b_) * (double)box_Nb_;
+  norm_c_ = norm_c_ / box_c.dot(norm_c_) * (double)box_Nc_;
+
+  // for small grids the periodic images of a neighbour coincide, so the
+  // neighbours are collected per cell and made unique
+  neighbour_begin_.assign(getNumberOfCells() + 1, 0);
+  neighbours_.clear();
+  std::vector<Index> cell_neighbours;
+  for (Index c = 0; c < box_Nc_; ++c) {
+    for (Index b = 0; b < box_Nb_; ++b) {
+      for (Index a = 0; a < box_Na_; ++a) {
+        Index cell = getCell(a, b, c);
+        cell_neighbours.clear();
+        for (Index dc = -1; dc <= 1; ++dc) {
+          for (Index db = -1; db <= 1; ++db) {
+            for (Index da = -1; da <= 1; ++da) {
+              Index neighbour = getCell((a + da + box_Na_) % box_Na_,
+                                        (b + db + box_Nb_) % box_Nb_,
+                                        (c + dc + box_Nc_) % box_Nc_);
+              if (neighbour != cell) {
+                cell_neighbours.push_back(neighbour);
               }
-              cell.neighbours_.push_back(
-                  &grid_(aa % box_Na_, bb % box_Nb_, cc % box_Nc_));
             }
           }
         }
+        std::sort(cell_neighbours.begin(), cell_neighbours.end());
+        cell_neighbours.erase(
+            std::unique(cell_neighbours.begin(), cell_neighbours.end()),
+            cell_neighbours.end());
+        neighbours_.insert(neighbours_.end(), cell_neighbours.begin(),
+                           cell_neighbours.end());
+        neighbour_begin_[cell + 1] = Index(neighbours_.size());
       }
     }
   }
 }
 
-NBListGrid::cell_t &NBListGrid::getCell(const Eigen::Vector3d &r) {
+Index NBListGrid::getCell(const Eigen::Vector3d &r) const {
   Index a = (Index)floor(r.dot(norm_a_));
   Index b = (Index)floor(r.dot(norm_b_));
   Index c = (Index)floor(r.dot(norm_c_));
@@ -165,37 +245,149 @@ NBListGrid::cell_t &NBListGrid::getCell(const Eigen::Vector3d &r) {
   }
   c %= box_Nc_;
 
-  return grid_(a, b, c);
+  return getCell(a, b, c);
 }
 
-void NBListGrid::TestBead(const Topology &top, NBListGrid::cell_t &cell,
-                          Bead *bead) {
-  TestCell(top, cell, bead);
-  for (auto &neighbour : cell.neighbours_) {
-    TestCell(top, *neighbour, bead);
+void NBListGrid::BinBeads(BeadList &list, Index nthreads) {
+  Index nbeads = list.size();
+  Index ncells = getNumberOfCells();
+  cell_of_bead_.resize(nbeads);
+  thread_counts_.assign(nthreads * ncells, 0);
+
+  // every thread counts the beads of its chunk of the list per cell
+  ParallelFor(team_.get(), nthreads, [&](Index thread) {
+    Index *counts = thread_counts_.data() + thread * ncells;
+    for (Index i = ChunkBegin(nbeads, nthreads, thread);
+         i < ChunkBegin(nbeads, nthreads, thread + 1); ++i) {
+      Index cell = getCell((*(list.begin() + i))->getPos());
+      cell_of_bead_[i] = cell;
+      ++counts[cell];
+    }
+  });
+
+  // turn the counts into the first slot of each thread in each cell, the
+  // chunks are in list order, so the sort stays stable
+  cell_begin_.resize(ncells + 1);
+  Index slot = 0;
+  for (Index cell = 0; cell < ncells; ++cell) {
+    cell_begin_[cell] = slot;
+    for (Index thread = 0; thread < nthreads; ++thread) {
+      Index count = thread_counts_[thread * ncells + cell];
+      thread_counts_[thread * ncells + cell] = slot;
+      slot += count;
+    }
   }
+  cell_begin_[ncells] = slot;
+
+  beads_.resize(nbeads);
+  order_.resize(nbeads);
+  x_.resize(nbeads);
+  y_.resize(nbeads);
+  z_.resize(nbeads);
+
+  ParallelFor(team_.get(), nthreads, [&](Index thread) {
+    Index *next_slot = thread_counts_.data() + thread * ncells;
+    for (Index i = ChunkBegin(nbeads, nthreads, thread);
+         i < ChunkBegin(nbeads, nthreads, thread + 1); ++i) {
+      Bead *bead = *(list.begin() + i);
+      Index target = next_slot[cell_of_bead_[i]]++;
+      const Eigen::Vector3d &pos = bead->getPos();
+      beads_[target] = bead;
+      order_[target] = i;
+      x_[target] = pos.x();
+      y_[target] = pos.y();
+      z_[target] = pos.z();
+    }
+  });
 }
 
-void NBListGrid::TestCell(const Topology &top, NBListGrid::cell_t &cell,
-                          Bead *bead) {
-  const Eigen::Vector3d &u = bead->getPos();
+void NBListGrid::CalcDistances(const Topology &top, const Eigen::Vector3d &pos,
+                               Index begin, Index end,
+                               scratch_t &scratch) const {
+  Index n = end - begin;
+  if (Index(scratch.dist2_.size()) < n) {
+    scratch.dx_.resize(n);
+    scratch.dy_.resize(n);
+    scratch.dz_.resize(n);
+    scratch.dist2_.resize(n);
+  }
+
+  const double *x = x_.data() + begin;
+  const double *y = y_.data() + begin;
+  const double *z = z_.data() + begin;
+  double *dx = scratch.dx_.data();
+  double *dy = scratch.dy_.data();
+  double *dz = scratch.dz_.data();
+  double *dist2 = scratch.dist2_.data();
+
+  if (orthorhombic_) {
+    const double px = pos.x();
+    const double py = pos.y();
+    const double pz = pos.z();
+    const double lx = box_diag_.x();
+    const double ly = box_diag_.y();
+    const double lz = box_diag_.z();
+    const double ilx = inv_box_diag_.x();
+    const double ily = inv_box_diag_.y();
+    const double ilz = inv_box_diag_.z();
+    // branch free minimum image, nearbyint maps to a single vector rounding
+    // instruction, ties are irrelevant as both images are equally far away
+    for (Index j = 0; j < n; ++j) {
+      double rx = x[j] - px;
+      double ry = y[j] - py;
+      double rz = z[j] - pz;
+      rx -= lx * std::nearbyint(rx * ilx);
+      ry -= ly * std::nearbyint(ry * ily);
+      rz -= lz * std::nearbyint(rz * ilz);
+      dx[j] = rx;
+      dy[j] = ry;
+      dz[j] = rz;
+      dist2[j] = rx * rx + ry * ry + rz * rz;
+    }
+  } else {
+    for (Index j = 0; j < n; ++j) {
+      Eigen::Vector3d r =
+          top.BCShortestConnection(pos, Eigen::Vector3d(x[j], y[j], z[j]));
+      dx[j] = r.x();
+      dy[j] = r.y();
+      dz[j] = r.z();
+      dist2[j] = r.squaredNorm();
+    }
+  }
+}
 
-  for (auto &bead_ : cell.beads_) {
+template <typename Sink>
+void NBListGrid::TestRange(const Topology &top, Bead *bead, Index begin,
+                           Index end, scratch_t &scratch, Sink &&sink) const {
+  CalcDistances(top, bead->getPos(), begin, end, scratch);
+  for (Index j = 0; j < end - begin; ++j) {
+    if (scratch.dist2_[j] >= radius2_) {
+      continue;
+    }
+    Bead *other = beads_[begin + j];
+    if (other == bead) {
+      continue;
+    }
+    Eigen::Vector3d r(-scratch.dx_[j], -scratch.dy_[j], -scratch.dz_[j]);
+    sink(other, bead, r, std::sqrt(scratch.dist2_[j]));
+  }
+}
 
-    const Eigen::Vector3d &v = bead_->getPos();
-    const Eigen::Vector3d &r = top.BCShortestConnection(v, u);
-    double d = r.norm();
-    if (d < cutoff_) {
-      if (do_exclusions_) {
-        if (top.getExclusions().IsExcluded(bead_, bead)) {
-          continue;
-        }
-      }
-      if ((*match_function_)(bead_, bead, r, d)) {
-        if (!FindPair(bead_, bead)) {
-          AddPair(pair_creator_(bead_, bead, r));
-        }
-      }
+template <typename Sink>
+void NBListGrid::TestRangeOrdered(const Topology &top, Index i, Index begin,
+                                  Index end, scratch_t &scratch,
+                                  Sink &&sink) const {
+  CalcDistances(top, Eigen::Vector3d(x_[i], y_[i], z_[i]), begin, end, scratch);
+  for (Index j = 0; j < end - begin; ++j) {
+    if (scratch.dist2_[j] >= radius2_) {
+      continue;
+    }
+    Index k = begin + j;
+    Eigen::Vector3d r(scratch.dx_[j], scratch.dy_[j], scratch.dz_[j]);
+    if (order_[i] < order_[k]) {
+      sink(beads_[i], beads_[k], r, std::sqrt(scratch.dist2_[j]));
+    } else {
+      sink(beads_[k], beads_[i], -r, std::sqrt(scratch.dist2_[j]));
     }
   }
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright 2009-2020 The VOTCA Development Team (http://www.votca.org)
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -46,26 +46,11 @@ void NBListGrid_3Body::Generate(BeadList &list1, BeadList &list2,
 
   InitializeGrid(top.getBox());
 
-  // Add all beads of list1 to  beads1_
-  for (auto &iter : list1) {
-    getCell(iter->getPos()).beads1_.push_back(iter);
-  }
-
-  // Add all beads of list2 to  beads2_
-  for (auto &iter : list2) {
-    getCell(iter->getPos()).beads2_.push_back(iter);
-  }
-
-  // Add all beads of list2 to  beads3_
-  for (auto &iter : list3) {
-    getCell(iter->getPos()).beads3_.push_back(iter);
-  }
+  BinBeads(list1, cell_of_bead1_, &cell_t::beads1_);
+  BinBeads(list2, cell_of_bead_, &cell_t::beads2_);
+  BinBeads(list3, cell_of_bead_, &cell_t::beads3_);
 
-  // loop over beads of list 1 again to get the correlations
-  for (auto &iter : list1) {
-    cell_t &cell = getCell(iter->getPos());
-    TestBead(top, cell, iter);
-  }
+  SearchTriples(top, list1);
 }
 
 void NBListGrid_3Body::Generate(BeadList &list1, BeadList &list2,
@@ -84,26 +69,15 @@ void NBListGrid_3Body::Generate(BeadList &list1, BeadList &list2,
 
   InitializeGrid(top.getBox());
 
-  // Add all beads of list1 to  beads1_
-  for (auto &bead : list1) {
-    getCell(bead->getPos()).beads1_.push_back(bead);
-  }
-
-  // Add all beads of list2 to  beads2_
-  for (auto &bead : list2) {
-    getCell(bead->getPos()).beads2_.push_back(bead);
-  }
+  BinBeads(list1, cell_of_bead1_, &cell_t::beads1_);
+  BinBeads(list2, cell_of_bead_, &cell_t::beads2_);
 
   // In this case type2 and type3 are the same
   for (auto &cell : grid_) {
     cell.beads3_ = cell.beads2_;
   }
 
-  // loop over beads of list 1 again to get the correlations
-  for (auto &bead : list1) {
-    cell_t &cell = getCell(bead->getPos());
-    TestBead(top, cell, bead);
-  }
+  SearchTriples(top, list1);
 }
 
 void NBListGrid_3Body::Generate(BeadList &list, bool do_exclusions) {
@@ -117,20 +91,75 @@ void NBListGrid_3Body::Generate(BeadList &list, bool do_exclusions) {
   InitializeGrid(top.getBox());
 
   // Add all beads of list to all! bead lists of the cell
-  for (auto &iter : list) {
-    getCell(iter->getPos()).beads1_.push_back(iter);
-  }
+  BinBeads(list, cell_of_bead1_, &cell_t::beads1_);
 
   for (auto &cell : grid_) {
     cell.beads2_ = cell.beads1_;
     cell.beads3_ = cell.beads1_;
   }
 
-  // loop over beads again to get the correlations (as all of the same type
-  // here)
-  for (auto &bead : list) {
-    cell_t &cell = getCell(bead->getPos());
-    TestBead(top, cell, bead);
+  // all beads are of the same type here
+  SearchTriples(top, list);
+}
+
+void NBListGrid_3Body::BinBeads(BeadList &list, std::vector<Index> &cells,
+                                BeadList cell_t::*beads) {
+  // the cells are computed in parallel, the beads are added in list order
+  Index nbeads = list.size();
+  Index nthreads = std::min(nthreads_, nbeads);
+  cells.resize(nbeads);
+  ParallelFor(team_.get(), nthreads, [&](Index thread) {
+    for (Index i = ChunkBegin(nbeads, nthreads, thread);
+         i < ChunkBegin(nbeads, nthreads, thread + 1); ++i) {
+      cells[i] = getCellIndex((*(list.begin() + i))->getPos());
+    }
+  });
+  Index i = 0;
+  for (Bead *bead : list) {
+    (grid_[cells[i]].*beads).push_back(bead);
+    ++i;
+  }
+}
+
+void NBListGrid_3Body::SearchTriples(const Topology &top, BeadList &list1) {
+  // loop over beads of list 1 again to get the correlations
+  Index nbeads = list1.size();
+  Index nthreads = std::min(nthreads_, nbeads);
+  if (nthreads == 1) {
+    Index i = 0;
+    for (Bead *bead : list1) {
+      TestBead(top, grid_[cell_of_bead1_[i]], bead,
+               [this](const found_triple_t &t) { ProcessTriple(t); });
+      ++i;
+    }
+    return;
+  }
+
+  thread_triples_.resize(nthreads);
+  ParallelFor(team_.get(), nthreads, [&](Index thread) {
+    std::vector<found_triple_t> &triples = thread_triples_[thread];
+    triples.clear();
+    for (Index i = ChunkBegin(nbeads, nthreads, thread);
+         i < ChunkBegin(nbeads, nthreads, thread + 1); ++i) {
+      TestBead(top, grid_[cell_of_bead1_[i]], *(list1.begin() + i),
+               [&triples](const found_triple_t &t) { triples.push_back(t); });
+    }
+  });
+  for (std::vector<found_triple_t> &triples : thread_triples_) {
+    for (const found_triple_t &t : triples) {
+      ProcessTriple(t);
+    }
+    triples.clear();
+  }
+}
+
+void NBListGrid_3Body::ProcessTriple(const found_triple_t &t) {
+  if ((*match_function_)(t.bead1_, t.bead2_, t.bead3_, t.r12_, t.r13_, t.r23_,
+                         t.d12_, t.d13_, t.d23_)) {
+    if (!FindTriple(t.bead1_, t.bead2_, t.bead3_)) {
+      AddTriple(triple_creator_(t.bead1_, t.bead2_, t.bead3_, t.r12_, t.r13_,
+                                t.r23_));
+    }
   }
 }
 
@@ -161,6 +190,8 @@ void NBListGrid_3Body::InitializeGrid(const Eigen::Matrix3d &box) {
   norm_b_ = norm_b_ / lb * (double)box_Nb_;
   norm_c_ = norm_c_ / lc * (double)box_Nc_;
 
+  // start from empty cells, the list may be generated more than once
+  grid_.clear();
   grid_.resize(box_Na_ * box_Nb_ * box_Nc_);
 
   Index a1, a2, b1, b2, c1, c2;
@@ -209,7 +240,7 @@ void NBListGrid_3Body::InitializeGrid(const Eigen::Matrix3d &box) {
   }
 }
 
-NBListGrid_3Body::cell_t &NBListGrid_3Body::getCell(const Eigen::Vector3d &r) {
+Index NBListGrid_3Body::getCellIndex(const Eigen::Vector3d &r) const {
   Index a = (Index)floor(r.dot(norm_a_));
   Index b = (Index)floor(r.dot(norm_b_));
   Index c = (Index)floor(r.dot(norm_c_));
@@ -229,42 +260,39 @@ NBListGrid_3Body::cell_t &NBListGrid_3Body::getCell(const Eigen::Vector3d &r) {
   }
   c %= box_Nc_;
 
-  return getCell(a, b, c);
+  return a + box_Na_ * b + box_Na_ * box_Nb_ * c;
 }
 
+template <typename Sink>
 void NBListGrid_3Body::TestBead(const Topology &top,
-                                NBListGrid_3Body::cell_t &cell, Bead *bead) {
-  BeadList::iterator iter2;
-  BeadList::iterator iter3;
+                                const NBListGrid_3Body::cell_t &cell,
+                                Bead *bead, Sink &&sink) const {
   Eigen::Vector3d u = bead->getPos();
 
   // loop over all neighbors (this now includes the cell itself!) to iterate
   // over all beads of type2 of the cell and its neighbors
-  for (vector<cell_t *>::iterator iterc2 = cell.neighbours_.begin();
-       iterc2 != cell.neighbours_.end(); ++iterc2) {
-    for (iter2 = (*(*iterc2)).beads2_.begin();
-         iter2 != (*(*iterc2)).beads2_.end(); ++iter2) {
+  for (cell_t *cell2 : cell.neighbours_) {
+    for (Bead *bead2 : cell2->beads2_) {
 
-      if (bead == *iter2) {
+      if (bead == bead2) {
         continue;
       }
 
       // loop again over all neighbors (this now includes the cell itself!)
       // to iterate over all beads of type3 of the cell and its neighbors
-      for (auto &neighbour_ : cell.neighbours_) {
-        for (iter3 = (*neighbour_).beads3_.begin();
-             iter3 != (*neighbour_).beads3_.end(); ++iter3) {
+      for (cell_t *cell3 : cell.neighbours_) {
+        for (Bead *bead3 : cell3->beads3_) {
 
           // do not include the same beads twice in one triple!
-          if (bead == *iter3) {
+          if (bead == bead3) {
             continue;
           }
-          if (*iter2 == *iter3) {
+          if (bead2 == bead3) {
             continue;
           }
 
-          Eigen::Vector3d v = (*iter2)->getPos();
-          Eigen::Vector3d z = (*iter3)->getPos();
+          Eigen::Vector3d v = bead2->getPos();
+          Eigen::Vector3d z = bead3->getPos();
 
           Eigen::Vector3d r12 = top.BCShortestConnection(u, v);
           Eigen::Vector3d r13 = top.BCShortestConnection(u, z);
@@ -280,18 +308,14 @@ void NBListGrid_3Body::TestBead(const Topology &top,
             /// experimental: at the moment exclude interaction as soon as
             /// one of the three pairs (1,2) (1,3) (2,3) is excluded!
             if (do_exclusions_) {
-              if ((top.getExclusions().IsExcluded(bead, *iter2)) ||
-                  (top.getExclusions().IsExcluded(bead, *iter3)) ||
-                  (top.getExclusions().IsExcluded(*iter2, *iter3))) {
+              if ((top.getExclusions().IsExcluded(bead, bead2)) ||
+                  (top.getExclusions().IsExcluded(bead, bead3)) ||
+                  (top.getExclusions().IsExcluded(bead2, bead3))) {
                 continue;
               }
             }
-            if ((*match_function_)(bead, *iter2, *iter3, r12, r13, r23, d12,
-                                   d13, d23)) {
-              if (!FindTriple(bead, *iter2, *iter3)) {
-                AddTriple(triple_creator_(bead, *iter2, *iter3, r12, r13, r23));
-              }
-            }
+            sink(found_triple_t{bead, bead2, bead3, r12, r13, r23, d12, d13,
+                                d23});
           }
         }
       }
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Local VOTCA includes
+#include "votca/csg/parallelfor.h"
+
+namespace votca {
+namespace csg {
+
+ThreadTeam::ThreadTeam(Index nthreads) {
+  for (Index thread = 1; thread < nthreads; ++thread) {
+    threads_.emplace_back(&ThreadTeam::Work, this, thread);
+  }
+}
+
+ThreadTeam::~ThreadTeam() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_.notify_all();
+  for (std::thread &thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadTeam::Run(Index nthreads, const std::function<void(Index)> &fkt) {
+  nthreads = std::min(nthreads, size());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    job_ = &fkt;
+    job_threads_ = nthreads;
+    pending_ = nthreads - 1;
+    errors_.assign(nthreads, nullptr);
+    ++generation_;
+  }
+  start_.notify_all();
+  try {
+    fkt(0);
+  } catch (...) {
+    errors_[0] = std::current_exception();
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]() { return pending_ == 0; });
+    job_ = nullptr;
+  }
+  for (std::exception_ptr &error : errors_) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+void ThreadTeam::Work(Index thread) {
+  std::uint64_t seen = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    start_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+    if (stop_) {
+      return;
+    }
+    seen = generation_;
+    if (thread >= job_threads_) {
+      continue;
+    }
+    const std::function<void(Index)> *job = job_;
+    lock.unlock();
+    try {
+      (*job)(thread);
+    } catch (...) {
+      errors_[thread] = std::current_exception();
+    }
+    lock.lock();
+    if (--pending_ == 0) {
+      done_.notify_one();
+    }
+  }
+}
+
+}  // namespace csg
+}  // namespace votca
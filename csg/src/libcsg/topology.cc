@@ -130,6 +130,35 @@ void Topology::CopyTopologyData(Topology *top) {
   }
 }
 
+void Topology::CopyFrameData(const Topology &top) {
+  if (top.beads_.size() != beads_.size()) {
+    throw std::runtime_error(
+        "CopyFrameData: topologies have a different number of beads");
+  }
+  setBox(top.getBox(), top.getBoxType());
+  time_ = top.time_;
+  step_ = top.step_;
+  has_vel_ = top.has_vel_;
+  has_force_ = top.has_force_;
+
+  for (std::size_t i = 0; i < beads_.size(); ++i) {
+    const Bead &from = top.beads_[i];
+    Bead &to = beads_[i];
+    if (from.HasPos()) {
+      to.setPos(from.getPos());
+    }
+    to.HasPos(from.HasPos());
+    if (from.HasVel()) {
+      to.setVel(from.getVel());
+    }
+    to.HasVel(from.HasVel());
+    if (from.HasF()) {
+      to.setF(from.getF());
+    }
+    to.HasF(from.HasF());
+  }
+}
+
 Index Topology::getBeadTypeId(string type) const {
   assert(beadtypes_.count(type));
   return beadtypes_.at(type);
@@ -99,6 +99,40 @@ BOOST_AUTO_TEST_CASE(create_bead) {
   top.Cleanup();
 }
 
+BOOST_AUTO_TEST_CASE(copy_frame_data) {
+  Topology frame, top;
+  string bead_type_name = "type1";
+  for (Topology *t : {&frame, &top}) {
+    t->RegisterBeadType(bead_type_name);
+    for (votca::Index i = 0; i < 2; i++) {
+      t->CreateBead(Bead::spherical, "b" + to_string(i), bead_type_name, 1, 1.0,
+                    0.0);
+    }
+  }
+
+  Eigen::Matrix3d box = 3 * Eigen::Matrix3d::Identity();
+  frame.setBox(box);
+  frame.setTime(2.5);
+  frame.setStep(10);
+  frame.getBead(0)->setPos(Eigen::Vector3d(1.0, 2.0, 3.0));
+  frame.getBead(1)->setPos(Eigen::Vector3d(0.5, 0.5, 0.5));
+  frame.getBead(1)->setF(Eigen::Vector3d(0.0, 0.0, 1.0));
+
+  top.CopyFrameData(frame);
+  BOOST_CHECK(top.getBox().isApprox(box));
+  BOOST_CHECK_EQUAL(top.getBoxType(), BoundaryCondition::typeOrthorhombic);
+  BOOST_CHECK_CLOSE(top.getTime(), 2.5, 1e-5);
+  BOOST_CHECK_EQUAL(top.getStep(), 10);
+  BOOST_CHECK(
+      top.getBead(0)->getPos().isApprox(Eigen::Vector3d(1.0, 2.0, 3.0)));
+  BOOST_CHECK(!top.getBead(0)->HasF());
+  BOOST_CHECK(top.getBead(1)->HasF());
+  BOOST_CHECK(top.getBead(1)->getF().isApprox(Eigen::Vector3d(0.0, 0.0, 1.0)));
+
+  Topology empty;
+  BOOST_CHECK_THROW(empty.CopyFrameData(frame), std::runtime_error);
+}
+
 /**
  * This test ensures that the interactions are stored correctly. Three beads
  * are created and two interactions are created connecting the three beads. The
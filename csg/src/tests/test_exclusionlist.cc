@@ -0,0 +1,99 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE exclusionlist_test
+
+// Standard includes
+#include <string>
+#include <vector>
+
+// Third party includes
+#include <boost/test/unit_test.hpp>
+
+// Local VOTCA includes
+#include "votca/csg/bead.h"
+#include "votca/csg/exclusionlist.h"
+#include "votca/csg/molecule.h"
+#include "votca/csg/topology.h"
+
+using namespace std;
+using namespace votca::csg;
+using votca::Index;
+
+BOOST_AUTO_TEST_SUITE(exclusionlist_test)
+
+BOOST_AUTO_TEST_CASE(exclusionlist_index) {
+  Topology top;
+  string bead_type_name = "CG";
+  top.RegisterBeadType(bead_type_name);
+  Index nbeads = 10;
+  Molecule *mol = top.CreateMolecule("chain");
+  for (Index i = 0; i < nbeads; i++) {
+    Bead *b = top.CreateBead(Bead::spherical, "b" + to_string(i),
+                             bead_type_name, 0, 1.0, 0.0);
+    mol->AddBead(b, "b" + to_string(i));
+  }
+  // a bead in another molecule
+  Molecule *other = top.CreateMolecule("other");
+  Bead *single =
+      top.CreateBead(Bead::spherical, "single", bead_type_name, 0, 1.0, 0.0);
+  other->AddBead(single, "single");
+
+  ExclusionList exclusions;
+  // chain exclusions up to second neighbours plus one ring closure
+  for (Index i = 0; i < nbeads; i++) {
+    vector<Bead *> excluded;
+    for (Index j = i + 1; j < std::min(i + 3, nbeads); j++) {
+      excluded.push_back(top.getBead(j));
+    }
+    exclusions.InsertExclusion(top.getBead(i), excluded);
+  }
+  exclusions.InsertExclusion(top.getBead(7), top.getBead(1));
+
+  auto expected = [](Index i, Index j) {
+    if (i > j) {
+      std::swap(i, j);
+    }
+    return (j > i && j - i <= 2) || (i == 1 && j == 7);
+  };
+
+  for (Index pass = 0; pass < 2; pass++) {
+    for (Index i = 0; i < nbeads; i++) {
+      for (Index j = 0; j < nbeads; j++) {
+        BOOST_CHECK_EQUAL(exclusions.IsExcluded(top.getBead(i), top.getBead(j)),
+                          expected(i, j));
+      }
+      BOOST_CHECK(!exclusions.IsExcluded(top.getBead(i), single));
+    }
+    exclusions.BuildIndex();
+  }
+
+  // modifications invalidate the index
+  exclusions.RemoveExclusion(top.getBead(2), top.getBead(3));
+  BOOST_CHECK(!exclusions.IsExcluded(top.getBead(3), top.getBead(2)));
+  exclusions.BuildIndex();
+  BOOST_CHECK(!exclusions.IsExcluded(top.getBead(3), top.getBead(2)));
+  BOOST_CHECK(exclusions.IsExcluded(top.getBead(2), top.getBead(4)));
+  BOOST_CHECK(exclusions.IsExcluded(top.getBead(1), top.getBead(7)));
+
+  exclusions.Clear();
+  BOOST_CHECK(!exclusions.IsExcluded(top.getBead(0), top.getBead(1)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
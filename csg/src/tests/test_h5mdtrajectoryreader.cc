@@ -0,0 +1,184 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE h5mdtrajectoryreader_test
+
+// Standard includes
+#include <string>
+#include <vector>
+
+// Third party includes
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+#include <hdf5.h>
+
+// Local VOTCA includes
+#include "votca/csg/bead.h"
+#include "votca/csg/topology.h"
+
+// Local private VOTCA includes
+#include "h5mdtrajectoryreader.h"
+
+using namespace std;
+using namespace votca::csg;
+using votca::Index;
+
+namespace {
+
+const Index nframes = 7;
+const Index nparticles = 5;
+// frames per chunk of the time dependent datasets
+const hsize_t chunk_frames = 2;
+
+double Position(Index frame, Index particle, Index dim) {
+  return 0.1 * double(frame) + 0.01 * double(particle) + 0.001 * double(dim);
+}
+
+double Force(Index frame, Index particle, Index dim) {
+  return -Position(frame, particle, dim) + 1.0;
+}
+
+double Edge(Index frame, Index dim) {
+  return 3.0 + 0.1 * double(frame) + double(dim);
+}
+
+void WriteDataset(hid_t group, const std::string &name, int rank,
+                  const hsize_t *dims, const std::vector<double> &data) {
+  hid_t space = H5Screate_simple(rank, dims, nullptr);
+  hid_t plist = H5Pcreate(H5P_DATASET_CREATE);
+  std::vector<hsize_t> chunk(dims, dims + rank);
+  chunk[0] = chunk_frames;
+  H5Pset_chunk(plist, rank, chunk.data());
+  hid_t ds = H5Dcreate(group, name.c_str(), H5T_NATIVE_DOUBLE, space,
+                       H5P_DEFAULT, plist, H5P_DEFAULT);
+  H5Dwrite(ds, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, data.data());
+  H5Dclose(ds);
+  H5Pclose(plist);
+  H5Sclose(space);
+}
+
+void WriteIntAttribute(hid_t object, const std::string &name,
+                       const std::vector<int> &values) {
+  hsize_t size = values.size();
+  hid_t space = H5Screate_simple(1, &size, nullptr);
+  hid_t attr = H5Acreate(object, name.c_str(), H5T_NATIVE_INT, space,
+                         H5P_DEFAULT, H5P_DEFAULT);
+  H5Awrite(attr, H5T_NATIVE_INT, values.data());
+  H5Aclose(attr);
+  H5Sclose(space);
+}
+
+// trajectory with a time dependent box and forces, the frames do not fill
+// the last block of frames
+void WriteTrajectory(const std::string &file) {
+  hid_t fid = H5Fcreate(file.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  hid_t h5md = H5Gcreate(fid, "h5md", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  WriteIntAttribute(h5md, "version", {1, 0});
+  H5Gclose(h5md);
+
+  hid_t particles =
+      H5Gcreate(fid, "particles", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  hid_t atoms =
+      H5Gcreate(particles, "atoms", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+  std::vector<double> positions;
+  std::vector<double> forces;
+  for (Index frame = 0; frame < nframes; frame++) {
+    for (Index particle = 0; particle < nparticles; particle++) {
+      for (Index dim = 0; dim < 3; dim++) {
+        positions.push_back(Position(frame, particle, dim));
+        forces.push_back(Force(frame, particle, dim));
+      }
+    }
+  }
+  hsize_t vector_dims[3] = {hsize_t(nframes), hsize_t(nparticles), 3};
+  hid_t position =
+      H5Gcreate(atoms, "position", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  WriteDataset(position, "value", 3, vector_dims, positions);
+  H5Gclose(position);
+  hid_t force =
+      H5Gcreate(atoms, "force", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  WriteDataset(force, "value", 3, vector_dims, forces);
+  H5Gclose(force);
+
+  std::vector<double> edges;
+  for (Index frame = 0; frame < nframes; frame++) {
+    for (Index dim = 0; dim < 3; dim++) {
+      edges.push_back(Edge(frame, dim));
+    }
+  }
+  hsize_t edge_dims[2] = {hsize_t(nframes), 3};
+  hid_t box = H5Gcreate(atoms, "box", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  WriteIntAttribute(box, "dimension", {3});
+  hid_t edges_group =
+      H5Gcreate(box, "edges", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  WriteDataset(edges_group, "value", 2, edge_dims, edges);
+  H5Gclose(edges_group);
+  H5Gclose(box);
+
+  H5Gclose(atoms);
+  H5Gclose(particles);
+  H5Fclose(fid);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(h5mdtrajectoryreader_test)
+
+BOOST_AUTO_TEST_CASE(partial_block_test) {
+  std::string file = "h5mdtrajectoryreader_test.h5";
+  WriteTrajectory(file);
+
+  Topology top;
+  top.setParticleGroup("atoms");
+  top.RegisterBeadType("A");
+  for (Index particle = 0; particle < nparticles; particle++) {
+    top.CreateBead(Bead::spherical, "A" + boost::lexical_cast<string>(particle),
+                   "A", 0, 1.0, 0.0);
+  }
+
+  H5MDTrajectoryReader reader;
+  // two chunks of two frames per block, so the seven frames are read in the
+  // blocks 0-3 and 4-6
+  std::size_t frame_bytes = nparticles * 3 * 2 * sizeof(double) +
+                            nparticles * sizeof(int) + 3 * sizeof(double);
+  reader.setBlockMemory(2 * chunk_frames * frame_bytes + 1);
+  BOOST_REQUIRE(reader.Open(file));
+
+  for (Index frame = 0; frame < nframes; frame++) {
+    bool read = (frame == 0) ? reader.FirstFrame(top) : reader.NextFrame(top);
+    BOOST_REQUIRE(read);
+    for (Index dim = 0; dim < 3; dim++) {
+      BOOST_CHECK_CLOSE(top.getBox()(dim, dim), Edge(frame, dim), 1e-10);
+    }
+    for (Index particle = 0; particle < nparticles; particle++) {
+      const Bead *bead = top.getBead(particle);
+      for (Index dim = 0; dim < 3; dim++) {
+        BOOST_CHECK_CLOSE(bead->getPos()[dim], Position(frame, particle, dim),
+                          1e-10);
+        BOOST_CHECK_CLOSE(bead->getF()[dim], Force(frame, particle, dim),
+                          1e-10);
+      }
+    }
+  }
+  BOOST_CHECK(!reader.NextFrame(top));
+  reader.Close();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -196,6 +196,134 @@ BOOST_AUTO_TEST_CASE(test_trajectoryreader) {
   }
 }
 
+/**
+ * \brief Test frames with different column layouts
+ *
+ * The column layout of the atoms section is resolved once per header, a
+ * later frame with a different header has to be read with its own layout.
+ */
+BOOST_AUTO_TEST_CASE(test_trajectoryreader_columns) {
+  string filename = "test_columns.dump";
+  {
+    ofstream out(filename);
+    out << "ITEM: TIMESTEP\n1\nITEM: NUMBER OF ATOMS\n2\n"
+        << "ITEM: BOX BOUNDS pp pp pp\n0 10\n0 20\n0 30\n"
+        << "ITEM: ATOMS id type x y z\n"
+        << "2 1 4.0 5.0 6.0\n"
+        << "1 1 1.0 2.0 3.0\n"
+        << "ITEM: TIMESTEP\n2\nITEM: NUMBER OF ATOMS\n2\n"
+        << "ITEM: BOX BOUNDS pp pp pp\n0 10\n0 20\n0 30\n"
+        << "ITEM: ATOMS xs ys zs id vx vy vz\n"
+        << "0.5 0.25 0.1 1 1e-1 -2.0 3\r\n"
+        << "\t0.1 0.1 0.1  2 0 0 0\n";
+  }
+
+  Topology top;
+  top.RegisterBeadType("A");
+  for (votca::Index i = 0; i < 2; ++i) {
+    top.CreateBead(Bead::spherical, "A", "A", 1, 1.0, 0.0);
+  }
+
+  TrajectoryReader::RegisterPlugins();
+  std::unique_ptr<TrajectoryReader> reader =
+      TrjReaderFactory().Create(filename);
+  reader->Open(filename);
+  reader->FirstFrame(top);
+  BOOST_CHECK_EQUAL(top.getStep(), 1);
+  BOOST_CHECK(top.getBead(0)->getPos().isApprox(Eigen::Vector3d(1.0, 2.0, 3.0) *
+                                                conv::ang2nm));
+  BOOST_CHECK(top.getBead(1)->getPos().isApprox(Eigen::Vector3d(4.0, 5.0, 6.0) *
+                                                conv::ang2nm));
+  BOOST_CHECK(!top.getBead(0)->HasVel());
+
+  reader->NextFrame(top);
+  BOOST_CHECK_EQUAL(top.getStep(), 2);
+  Eigen::Vector3d box_diag = top.getBox().diagonal();
+  BOOST_CHECK(top.getBead(0)->getPos().isApprox(
+      Eigen::Vector3d(0.5, 0.25, 0.1).cwiseProduct(box_diag)));
+  BOOST_CHECK(top.getBead(0)->HasVel());
+  BOOST_CHECK(top.getBead(0)->getVel().isApprox(
+      Eigen::Vector3d(0.1, -2.0, 3.0) * conv::ang2nm));
+  reader->Close();
+  std::remove(filename.c_str());
+}
+
+/**
+ * \brief Test random access to the frames of a dump file
+ *
+ * On request the frame offsets are stored in a sidecar file, which is reused
+ * by a second reader and rebuilt once the trajectory changes.
+ */
+BOOST_AUTO_TEST_CASE(test_trajectoryreader_seek) {
+  string filename = "test_seek.dump";
+  string sidecar = filename + ".offsets";
+  std::remove(sidecar.c_str());
+  auto write_frames = [&filename](votca::Index begin, votca::Index end) {
+    ofstream out(filename, begin == 0 ? ios::trunc : ios::app);
+    for (votca::Index step = begin; step < end; ++step) {
+      out << "ITEM: TIMESTEP\n"
+          << step << "\nITEM: NUMBER OF ATOMS\n1\n"
+          << "ITEM: BOX BOUNDS pp pp pp\n0 10\n0 10\n0 10\n"
+          << "ITEM: ATOMS id type x y z\n"
+          << "1 1 " << step << ".0 0.0 0.0\n";
+    }
+  };
+  write_frames(0, 5);
+
+  Topology top;
+  top.RegisterBeadType("A");
+  top.CreateBead(Bead::spherical, "A", "A", 1, 1.0, 0.0);
+
+  TrajectoryReader::RegisterPlugins();
+  std::unique_ptr<TrajectoryReader> reader =
+      TrjReaderFactory().Create(filename);
+  BOOST_REQUIRE(reader->IsSeekable());
+  // by default the index is only kept in memory
+  reader->Open(filename);
+  BOOST_CHECK_EQUAL(reader->FrameCount(), 5);
+  BOOST_CHECK(!ifstream(sidecar).good());
+  reader->Close();
+
+  reader->setSaveFrameIndex(true);
+  reader->Open(filename);
+  BOOST_CHECK_EQUAL(reader->FrameCount(), 5);
+  BOOST_CHECK(ifstream(sidecar).good());
+
+  BOOST_REQUIRE(reader->SeekFrame(3));
+  reader->FirstFrame(top);
+  BOOST_CHECK_EQUAL(top.getStep(), 3);
+  BOOST_CHECK_CLOSE(top.getBead(0)->getPos().x(), 3.0 * conv::ang2nm, 1e-8);
+  BOOST_REQUIRE(reader->SeekFrame(1));
+  BOOST_CHECK(reader->NextFrame(top));
+  BOOST_CHECK_EQUAL(top.getStep(), 1);
+  // reading continues after the seeked frame
+  BOOST_CHECK(reader->NextFrame(top));
+  BOOST_CHECK_EQUAL(top.getStep(), 2);
+  BOOST_CHECK(!reader->SeekFrame(5));
+  reader->Close();
+
+  // the second reader uses the sidecar
+  std::unique_ptr<TrajectoryReader> reader2 =
+      TrjReaderFactory().Create(filename);
+  reader2->Open(filename);
+  BOOST_REQUIRE(reader2->SeekFrame(4));
+  reader2->FirstFrame(top);
+  BOOST_CHECK_EQUAL(top.getStep(), 4);
+  reader2->Close();
+
+  // an appended frame invalidates the sidecar
+  write_frames(5, 6);
+  reader2->Open(filename);
+  BOOST_CHECK_EQUAL(reader2->FrameCount(), 6);
+  BOOST_REQUIRE(reader2->SeekFrame(5));
+  reader2->FirstFrame(top);
+  BOOST_CHECK_EQUAL(top.getStep(), 5);
+  reader2->Close();
+
+  std::remove(filename.c_str());
+  std::remove(sidecar.c_str());
+}
+
 /**
  * \brief Testing trajectory writer
  *
@@ -0,0 +1,396 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE nblistgrid_test
+
+// Standard includes
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// Third party includes
+#include <boost/test/unit_test.hpp>
+
+// Local VOTCA includes
+#include "votca/csg/bead.h"
+#include "votca/csg/beadlist.h"
+#include "votca/csg/molecule.h"
+#include "votca/csg/nblistgrid.h"
+#include "votca/csg/parallelfor.h"
+#include "votca/csg/topology.h"
+
+using namespace std;
+using namespace votca::csg;
+using votca::Index;
+
+using pair_map_t = map<pair<Index, Index>, Eigen::Vector3d>;
+
+static void FillTopology(Topology &top, const Eigen::Matrix3d &box,
+                         Index nbeads) {
+  top.setBox(box);
+  top.RegisterBeadType("A");
+  top.RegisterBeadType("B");
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+  for (Index i = 0; i < nbeads; i++) {
+    Molecule *mol = top.CreateMolecule("M" + to_string(i));
+    string type = (i % 3 == 0) ? "B" : "A";
+    Bead *b =
+        top.CreateBead(Bead::spherical, "b" + to_string(i), type, 0, 1.0, 0.0);
+    Eigen::Vector3d frac(dist(gen), dist(gen), dist(gen));
+    b->setPos(box * frac);
+    mol->AddBead(b, type);
+  }
+}
+
+static pair_map_t ToMap(NBList &nb) {
+  pair_map_t pairs;
+  for (BeadPair *pair : nb) {
+    pairs[{pair->first()->getId(), pair->second()->getId()}] = pair->r();
+  }
+  BOOST_CHECK_EQUAL(Index(pairs.size()), nb.size());
+  return pairs;
+}
+
+static void ComparePairs(const pair_map_t &ref, const pair_map_t &grid) {
+  BOOST_REQUIRE_EQUAL(ref.size(), grid.size());
+  for (const auto &entry : ref) {
+    auto it = grid.find(entry.first);
+    BOOST_REQUIRE(it != grid.end());
+    BOOST_CHECK(entry.second.isApprox(it->second, 1e-10));
+  }
+}
+
+static void CompareToSimple(const Eigen::Matrix3d &box, double cutoff) {
+  Topology top;
+  FillTopology(top, box, 300);
+
+  BeadList all, beadsA, beadsB;
+  all.Generate(top, "*");
+  beadsA.Generate(top, "A");
+  beadsB.Generate(top, "B");
+
+  NBList simple;
+  simple.setCutoff(cutoff);
+  simple.Generate(all);
+  NBListGrid grid;
+  grid.setCutoff(cutoff);
+  grid.Generate(all);
+  BOOST_CHECK(simple.size() > 0);
+  ComparePairs(ToMap(simple), ToMap(grid));
+
+  NBList simple_cross;
+  simple_cross.setCutoff(cutoff);
+  simple_cross.Generate(beadsA, beadsB);
+  NBListGrid grid_cross;
+  grid_cross.setCutoff(cutoff);
+  grid_cross.Generate(beadsA, beadsB);
+  BOOST_CHECK(simple_cross.size() > 0);
+  ComparePairs(ToMap(simple_cross), ToMap(grid_cross));
+}
+
+BOOST_AUTO_TEST_SUITE(nblistgrid_test)
+
+BOOST_AUTO_TEST_CASE(test_nblistgrid_orthorhombic) {
+  Eigen::Matrix3d box = Eigen::Vector3d(6.0, 7.0, 8.0).asDiagonal();
+  CompareToSimple(box, 1.5);
+}
+
+BOOST_AUTO_TEST_CASE(test_nblistgrid_small_grid) {
+  // only one or two cells per dimension, neighbours coincide with images
+  Eigen::Matrix3d box = Eigen::Vector3d(2.5, 3.5, 5.0).asDiagonal();
+  CompareToSimple(box, 1.2);
+}
+
+BOOST_AUTO_TEST_CASE(test_nblistgrid_triclinic) {
+  Eigen::Matrix3d box;
+  box << 6.0, 1.0, 0.5, 0.0, 7.0, 1.0, 0.0, 0.0, 8.0;
+  CompareToSimple(box, 1.5);
+}
+
+BOOST_AUTO_TEST_CASE(test_nblistgrid_verlet) {
+  Eigen::Matrix3d box = Eigen::Vector3d(6.0, 7.0, 8.0).asDiagonal();
+  Topology top;
+  FillTopology(top, box, 300);
+  BeadList all;
+  all.Generate(top, "*");
+
+  NBListGrid verlet;
+  verlet.setCutoff(1.5);
+  verlet.setSkin(0.4);
+
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> dist(-0.02, 0.02);
+  for (Index frame = 0; frame < 4; frame++) {
+    verlet.Cleanup();
+    verlet.Generate(all);
+    NBListGrid fresh;
+    fresh.setCutoff(1.5);
+    fresh.Generate(all);
+    ComparePairs(ToMap(fresh), ToMap(verlet));
+
+    // displacements stay below half the skin
+    for (Bead *b : all) {
+      Eigen::Vector3d shift(dist(gen), dist(gen), dist(gen));
+      b->setPos(b->getPos() + shift);
+    }
+  }
+  BOOST_CHECK_EQUAL(verlet.getRebuildCount(), 1);
+
+  Bead *moved = *all.begin();
+  moved->setPos(moved->getPos() + Eigen::Vector3d(0.3, 0.0, 0.0));
+  verlet.Cleanup();
+  verlet.Generate(all);
+  BOOST_CHECK_EQUAL(verlet.getRebuildCount(), 2);
+  NBListGrid fresh;
+  fresh.setCutoff(1.5);
+  fresh.Generate(all);
+  ComparePairs(ToMap(fresh), ToMap(verlet));
+}
+
+BOOST_AUTO_TEST_CASE(test_nblistgrid_verlet_cutoff) {
+  Eigen::Matrix3d box = Eigen::Vector3d(6.0, 7.0, 8.0).asDiagonal();
+  Topology top;
+  FillTopology(top, box, 300);
+  BeadList all;
+  all.Generate(top, "*");
+
+  NBListGrid verlet;
+  verlet.setCutoff(1.5);
+  verlet.setSkin(0.4);
+  verlet.Generate(all);
+
+  // the candidates of the old cutoff do not cover the new one
+  verlet.setCutoff(2.2);
+  verlet.Cleanup();
+  verlet.Generate(all);
+  BOOST_CHECK_EQUAL(verlet.getRebuildCount(), 2);
+  NBListGrid fresh;
+  fresh.setCutoff(2.2);
+  fresh.Generate(all);
+  ComparePairs(ToMap(fresh), ToMap(verlet));
+}
+
+BOOST_AUTO_TEST_CASE(test_nblistgrid_verlet_box) {
+  Eigen::Matrix3d box = Eigen::Vector3d(6.0, 7.0, 8.0).asDiagonal();
+  Topology top;
+  FillTopology(top, box, 300);
+  BeadList all;
+  all.Generate(top, "*");
+
+  NBListGrid verlet;
+  verlet.setCutoff(1.5);
+  verlet.setSkin(0.4);
+
+  // small NPT like fluctuations of the box only use up part of the skin
+  for (double scale : {1.0, 1.003, 0.998, 0.995, 1.001}) {
+    Eigen::Matrix3d new_box = scale * box;
+    for (Bead *b : all) {
+      b->setPos(new_box * top.getBox().inverse() * b->getPos());
+    }
+    top.setBox(new_box);
+    verlet.Cleanup();
+    verlet.Generate(all);
+    NBListGrid fresh;
+    fresh.setCutoff(1.5);
+    fresh.Generate(all);
+    ComparePairs(ToMap(fresh), ToMap(verlet));
+  }
+  BOOST_CHECK_EQUAL(verlet.getRebuildCount(), 1);
+
+  // a strong compression exhausts it
+  Eigen::Matrix3d new_box = 0.75 * box;
+  for (Bead *b : all) {
+    b->setPos(new_box * top.getBox().inverse() * b->getPos());
+  }
+  top.setBox(new_box);
+  verlet.Cleanup();
+  verlet.Generate(all);
+  BOOST_CHECK_EQUAL(verlet.getRebuildCount(), 2);
+  NBListGrid fresh;
+  fresh.setCutoff(1.5);
+  fresh.Generate(all);
+  ComparePairs(ToMap(fresh), ToMap(verlet));
+}
+
+BOOST_AUTO_TEST_CASE(test_nblistgrid_verlet_overlap) {
+  Eigen::Matrix3d box = Eigen::Vector3d(6.0, 7.0, 8.0).asDiagonal();
+  Topology top;
+  FillTopology(top, box, 300);
+  BeadList all, beadsA;
+  all.Generate(top, "*");
+  beadsA.Generate(top, "A");
+
+  // pairs of two A beads are found from both lists
+  NBListGrid plain;
+  plain.setCutoff(1.5);
+  plain.Generate(all, beadsA);
+  NBListGrid verlet;
+  verlet.setCutoff(1.5);
+  verlet.setSkin(0.4);
+  verlet.Generate(all, beadsA);
+
+  std::set<pair<Index, Index>> unique_pairs;
+  for (BeadPair *pair : verlet) {
+    Index id1 = pair->first()->getId();
+    Index id2 = pair->second()->getId();
+    unique_pairs.insert({std::min(id1, id2), std::max(id1, id2)});
+  }
+  BOOST_CHECK_EQUAL(Index(unique_pairs.size()), verlet.size());
+  BOOST_CHECK_EQUAL(plain.size(), verlet.size());
+}
+
+BOOST_AUTO_TEST_CASE(test_nblistgrid_foreachpair) {
+  Eigen::Matrix3d box = Eigen::Vector3d(6.0, 7.0, 8.0).asDiagonal();
+  Topology top;
+  FillTopology(top, box, 300);
+  BeadList all;
+  all.Generate(top, "*");
+
+  NBListGrid stored;
+  stored.setCutoff(1.5);
+  stored.Generate(all);
+
+  NBListGrid visited;
+  visited.setCutoff(1.5);
+  pair_map_t pairs;
+  visited.ForEachPair(
+      all, [&pairs](Bead *b1, Bead *b2, const Eigen::Vector3d &r, double dist) {
+        BOOST_CHECK_CLOSE(r.norm(), dist, 1e-10);
+        pairs[{b1->getId(), b2->getId()}] = r;
+      });
+  BOOST_CHECK(visited.empty());
+  ComparePairs(ToMap(stored), pairs);
+}
+
+BOOST_AUTO_TEST_CASE(test_nblistgrid_foreachpair_overlap) {
+  Eigen::Matrix3d box = Eigen::Vector3d(6.0, 7.0, 8.0).asDiagonal();
+  Topology top;
+  FillTopology(top, box, 300);
+  BeadList all, beadsA;
+  all.Generate(top, "*");
+  beadsA.Generate(top, "A");
+
+  // pairs of two A beads are found from both lists but visited once, as
+  // Generate stores them once
+  NBList simple, simple_stored;
+  NBListGrid grid, grid_stored;
+  for (auto lists :
+       {std::make_pair<NBList *, NBList *>(&simple, &simple_stored),
+        std::make_pair<NBList *, NBList *>(&grid, &grid_stored)}) {
+    NBList &nb = *lists.first;
+    NBList &stored = *lists.second;
+    nb.setCutoff(1.5);
+    stored.setCutoff(1.5);
+    stored.Generate(all, beadsA);
+    std::set<pair<Index, Index>> visited;
+    Index count = 0;
+    nb.ForEachPair(all, beadsA,
+                   [&](Bead *b1, Bead *b2, const Eigen::Vector3d &, double) {
+                     visited.insert({std::min(b1->getId(), b2->getId()),
+                                     std::max(b1->getId(), b2->getId())});
+                     count++;
+                   });
+    BOOST_CHECK(count > 0);
+    BOOST_CHECK_EQUAL(count, stored.size());
+    BOOST_CHECK_EQUAL(Index(visited.size()), count);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_nblistgrid_threaded) {
+  Eigen::Matrix3d box = Eigen::Vector3d(6.0, 7.0, 8.0).asDiagonal();
+  Topology top;
+  FillTopology(top, box, 300);
+  BeadList all, beadsA, beadsB;
+  all.Generate(top, "*");
+  beadsA.Generate(top, "A");
+  beadsB.Generate(top, "B");
+
+  for (Index nthreads : {2, 3, 8}) {
+    NBListGrid serial;
+    serial.setCutoff(1.5);
+    serial.Generate(all);
+    NBListGrid threaded;
+    threaded.setCutoff(1.5);
+    threaded.setNumberOfThreads(nthreads);
+    // the threads are reused for the second list
+    threaded.Generate(all);
+    threaded.Cleanup();
+    threaded.Generate(all);
+
+    // the merged list has the same order as the serial one
+    BOOST_REQUIRE_EQUAL(serial.size(), threaded.size());
+    auto it = threaded.begin();
+    for (BeadPair *pair : serial) {
+      BOOST_CHECK_EQUAL(pair->first(), (*it)->first());
+      BOOST_CHECK_EQUAL(pair->second(), (*it)->second());
+      BOOST_CHECK(pair->r().isApprox((*it)->r(), 1e-10));
+      ++it;
+    }
+
+    NBListGrid serial_cross;
+    serial_cross.setCutoff(1.5);
+    serial_cross.Generate(beadsA, all);
+    NBListGrid threaded_cross;
+    threaded_cross.setCutoff(1.5);
+    threaded_cross.setNumberOfThreads(nthreads);
+    threaded_cross.Generate(beadsA, all);
+    ComparePairs(ToMap(serial_cross), ToMap(threaded_cross));
+
+    // a visitor is served from the calling thread
+    NBListGrid serial_ab;
+    serial_ab.setCutoff(1.5);
+    serial_ab.Generate(beadsA, beadsB);
+    pair_map_t visited;
+    threaded_cross.Cleanup();
+    threaded_cross.ForEachPair(
+        beadsA, beadsB,
+        [&visited](Bead *b1, Bead *b2, const Eigen::Vector3d &r, double) {
+          visited[{b1->getId(), b2->getId()}] = r;
+        });
+    ComparePairs(ToMap(serial_ab), visited);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_threadteam) {
+  ThreadTeam team(4);
+  BOOST_CHECK_EQUAL(team.size(), 4);
+  for (Index run = 0; run < 20; run++) {
+    std::vector<Index> calls(4, 0);
+    team.Run(3, [&calls](Index thread) { calls[thread]++; });
+    BOOST_CHECK_EQUAL(calls[0] + calls[1] + calls[2], 3);
+    BOOST_CHECK_EQUAL(calls[3], 0);
+  }
+  BOOST_CHECK_THROW(team.Run(4,
+                             [](Index thread) {
+                               if (thread == 2) {
+                                 throw std::runtime_error("failed");
+                               }
+                             }),
+                    std::runtime_error);
+  // the team stays usable after an exception
+  std::vector<Index> calls(4, 0);
+  team.Run(4, [&calls](Index thread) { calls[thread]++; });
+  BOOST_CHECK_EQUAL(calls[0] + calls[1] + calls[2] + calls[3], 4);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
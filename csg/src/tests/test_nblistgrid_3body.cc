@@ -20,6 +20,7 @@
 #define BOOST_TEST_MODULE nblist_3body_test
 
 // Standard includes
+#include <random>
 #include <string>
 #include <vector>
 
@@ -29,6 +30,7 @@
 // Local VOTCA includes
 #include "votca/csg/bead.h"
 #include "votca/csg/beadlist.h"
+#include "votca/csg/molecule.h"
 #include "votca/csg/nblistgrid_3body.h"
 #include "votca/csg/topology.h"
 
@@ -129,4 +131,46 @@ BOOST_AUTO_TEST_CASE(test_nblist_3body_generate_list) {
   BOOST_CHECK_CLOSE((*triple_iter)->dist23(), 1.0, 1e-4);
 }
 
+BOOST_AUTO_TEST_CASE(test_nblistgrid_3body_threaded) {
+  Topology top;
+  Eigen::Matrix3d box = 6 * Eigen::Matrix3d::Identity();
+  top.setBox(box);
+  string bead_type_name = "CG";
+  top.RegisterBeadType(bead_type_name);
+  Molecule *mol = top.CreateMolecule("UNKNOWN");
+
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<double> dist(0.0, 6.0);
+  for (votca::Index i = 0; i < 80; i++) {
+    Bead *b = top.CreateBead(Bead::spherical, "dummy" + to_string(i),
+                             bead_type_name, 0, 1.0, 0.0);
+    b->setPos(Eigen::Vector3d(dist(gen), dist(gen), dist(gen)));
+    mol->AddBead(b, bead_type_name);
+  }
+
+  BeadList beads;
+  beads.Generate(top, "CG");
+
+  NBListGrid_3Body serial;
+  serial.setCutoff(1.5);
+  serial.Generate(beads, false);
+  BOOST_CHECK(serial.size() > 0);
+
+  NBListGrid_3Body threaded;
+  threaded.setCutoff(1.5);
+  threaded.setNumberOfThreads(4);
+  threaded.Generate(beads, false);
+
+  // the merged list has the same order as the serial one
+  BOOST_REQUIRE_EQUAL(serial.size(), threaded.size());
+  auto it = threaded.begin();
+  for (BeadTriple *triple : serial) {
+    BOOST_CHECK_EQUAL(triple->bead1(), (*it)->bead1());
+    BOOST_CHECK_EQUAL(triple->bead2(), (*it)->bead2());
+    BOOST_CHECK_EQUAL(triple->bead3(), (*it)->bead3());
+    BOOST_CHECK_CLOSE(triple->dist23(), (*it)->dist23(), 1e-10);
+    ++it;
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
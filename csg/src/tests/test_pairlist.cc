@@ -0,0 +1,125 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE pairlist_test
+
+// Standard includes
+#include <string>
+
+// Third party includes
+#include <boost/test/unit_test.hpp>
+
+// Local VOTCA includes
+#include "votca/csg/bead.h"
+#include "votca/csg/beadpair.h"
+#include "votca/csg/pairlist.h"
+#include "votca/csg/topology.h"
+
+using namespace std;
+using namespace votca::csg;
+using votca::Index;
+
+class TestPairList : public PairList<Bead *, BeadPair> {
+ public:
+  BeadPair *CreatePair(Bead *b1, Bead *b2, const Eigen::Vector3d &r) {
+    BeadPair *p = arena_.Create<BeadPair>(b1, b2, r);
+    InsertPair(p);
+    return p;
+  }
+};
+
+static void CreateBeads(Topology &top, Index nbeads) {
+  string bead_type_name = "CG";
+  top.RegisterBeadType(bead_type_name);
+  for (Index i = 0; i < nbeads; i++) {
+    top.CreateBead(Bead::spherical, "dummy" + to_string(i), bead_type_name, 0,
+                   1.0, 0.0);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(pairlist_test)
+
+BOOST_AUTO_TEST_CASE(pairlist_add_find) {
+  Topology top;
+  CreateBeads(top, 3);
+  Bead *b0 = top.getBead(0);
+  Bead *b1 = top.getBead(1);
+  Bead *b2 = top.getBead(2);
+
+  PairList<Bead *, BeadPair> pairlist;
+  BOOST_CHECK(pairlist.empty());
+  BOOST_CHECK(pairlist.FindPair(b0, b1) == nullptr);
+
+  BeadPair *p01 = new BeadPair(b0, b1, Eigen::Vector3d::UnitX());
+  BeadPair *p12 = new BeadPair(b1, b2, Eigen::Vector3d::UnitY());
+  pairlist.AddPair(p01);
+  pairlist.AddPair(p12);
+
+  BOOST_CHECK_EQUAL(pairlist.size(), 2);
+  BOOST_CHECK_EQUAL(pairlist.FindPair(b0, b1), p01);
+  BOOST_CHECK_EQUAL(pairlist.FindPair(b1, b0), p01);
+  BOOST_CHECK_EQUAL(pairlist.FindPair(b2, b1), p12);
+  BOOST_CHECK(pairlist.FindPair(b0, b2) == nullptr);
+
+  PairList<Bead *, BeadPair>::partners *partners = pairlist.FindPartners(b1);
+  BOOST_REQUIRE(partners != nullptr);
+  BOOST_CHECK_EQUAL(partners->size(), 2);
+  BOOST_CHECK_EQUAL(partners->at(b0), p01);
+  BOOST_CHECK_EQUAL(partners->at(b2), p12);
+
+  pairlist.Cleanup();
+  BOOST_CHECK(pairlist.empty());
+  BOOST_CHECK(pairlist.FindPair(b0, b1) == nullptr);
+  BOOST_CHECK(pairlist.FindPartners(b1) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(pairlist_arena_reuse) {
+  Topology top;
+  Index nbeads = 60;
+  CreateBeads(top, nbeads);
+
+  TestPairList pairlist;
+  for (Index cycle = 0; cycle < 3; cycle++) {
+    // enough pairs to grow the index several times
+    for (Index i = 0; i < nbeads; i++) {
+      for (Index j = i + 1; j < nbeads; j += 2) {
+        pairlist.CreatePair(top.getBead(i), top.getBead(j),
+                            Eigen::Vector3d(double(i), double(j), 0.0));
+      }
+    }
+    BOOST_CHECK_EQUAL(pairlist.size(), 900);
+    for (Index i = 0; i < nbeads; i++) {
+      for (Index j = i + 1; j < nbeads; j++) {
+        BeadPair *p = pairlist.FindPair(top.getBead(j), top.getBead(i));
+        if ((j - i) % 2 == 1) {
+          BOOST_REQUIRE(p != nullptr);
+          BOOST_CHECK_EQUAL(p->first(), top.getBead(i));
+          BOOST_CHECK_EQUAL(p->r().y(), double(j));
+        } else {
+          BOOST_CHECK(p == nullptr);
+        }
+      }
+    }
+    pairlist.Cleanup();
+    BOOST_CHECK_EQUAL(pairlist.size(), 0);
+    BOOST_CHECK(pairlist.FindPair(top.getBead(0), top.getBead(1)) == nullptr);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -83,6 +83,17 @@ void CGForceMatching::BeginEvaluate(Topology *top, Topology *) {
   nframes_ = options_.get("cg.fmatch.frames_per_block").as<votca::Index>();
   // read  constr_least_sq_ from input file
   constr_least_sq_ = options_.get("cg.fmatch.constrainedLS").as<bool>();
+  normal_equations_ = false;
+  if (options_.exists("cg.fmatch.normal_equations")) {
+    normal_equations_ = options_.get("cg.fmatch.normal_equations").as<bool>();
+  }
+  // without a block size all frames form a single block, which is only
+  // affordable with the normal equations
+  if (nframes_ < 0 || (nframes_ == 0 && !normal_equations_)) {
+    throw std::runtime_error(
+        "cg.fmatch.frames_per_block has to be positive, 0 is only allowed "
+        "with cg.fmatch.normal_equations");
+  }
 
   // initializing bonded interactions
   for (votca::tools::Property *prop : bonded_) {
@@ -117,7 +128,16 @@ void CGForceMatching::BeginEvaluate(Topology *top, Topology *) {
 
   // now initialize  A_,  b_,  x_ and probably  B_constr_
   // depending on least-squares algorithm used
-  if (constr_least_sq_) {  // Constrained Least Squares
+  if (normal_equations_) {
+    cout << "\nUsing " << (constr_least_sq_ ? "constrained" : "simple")
+         << " Least Squares from the normal equations!\n " << endl;
+    // the smoothing conditions are either the constraints or are added to
+    // the normal equations of every block
+    least_sq_offset_ = 0;
+    B_constr_ = Eigen::MatrixXd::Zero(line_cntr_, col_cntr_);
+    FmatchAssignSmoothCondsToMatrix(B_constr_);
+    FmatchResetBlock();
+  } else if (constr_least_sq_) {  // Constrained Least Squares
 
     cout << "\nUsing constrained Least Squares!\n " << endl;
 
@@ -264,7 +284,59 @@ CGForceMatching::SplineInfo::SplineInfo(votca::Index index,
   block_res_f2 = Eigen::VectorXd::Zero(num_outgrid);
 }
 
+std::unique_ptr<CsgApplication::Worker> CGForceMatching::ForkWorker() {
+  auto worker = std::make_unique<CGForceMatching::Worker>();
+  worker->fmatch_ = this;
+  return worker;
+}
+
+void CGForceMatching::Worker::EvalConfiguration(Topology *conf, Topology *) {
+  conf_ = conf;
+  if (!fmatch_->normal_equations_) {
+    // all equations of a block share  A_, so they are filled in order in
+    // MergeWorker
+    return;
+  }
+  if (conf->BeadCount() != fmatch_->nbeads_) {
+    throw std::runtime_error(
+        "CG Topology has a different number of beads than the first frame");
+  }
+  rows_.entries_.clear();
+  fmatch_->FmatchAssignEquations(conf, rows_, 0, nblists_, nblists3body_);
+  frame_A_.resize(3 * fmatch_->nbeads_, fmatch_->col_cntr_);
+  frame_A_.setFromTriplets(rows_.entries_.begin(), rows_.entries_.end());
+  frame_AtA_ = frame_A_.transpose() * frame_A_;
+}
+
+void CGForceMatching::MergeWorker(CsgApplication::Worker *worker_) {
+  CGForceMatching::Worker *worker =
+      dynamic_cast<CGForceMatching::Worker *>(worker_);
+  if (!normal_equations_) {
+    EvalConfiguration(worker->conf_);
+    return;
+  }
+
+  FmatchPrepareConfiguration(worker->conf_);
+  Eigen::VectorXd b(3 * nbeads_);
+  FmatchAssignForces(worker->conf_, b, 0);
+  AtA_ += worker->frame_AtA_;
+  Atb_ += worker->frame_A_.transpose() * b;
+  btb_ += b.squaredNorm();
+  frame_counter_ += 1;
+
+  if (frame_counter_ == nframes_) {
+    FmatchFinishBlock();
+  }
+  if (has_existing_forces_) {
+    trjreader_force_->NextFrame(top_force_);
+  }
+}
+
 void CGForceMatching::EndEvaluate() {
+  // all frames in one block
+  if (normal_equations_ && nframes_ == 0 && frame_counter_ > 0) {
+    FmatchFinishBlock();
+  }
   // sanity check
   if (nblocks_ == 0) {
     cerr << "\nERROR in CGForceMatching::EndEvaluate - No blocks have been "
@@ -380,7 +452,7 @@ void CGForceMatching::WriteOutFiles() {
   }
 }
 
-void CGForceMatching::EvalConfiguration(Topology *conf, Topology *) {
+void CGForceMatching::FmatchPrepareConfiguration(Topology *conf) {
   if (conf->BeadCount() == 0) {
     throw std::runtime_error(
         "CG Topology has 0 beads, check your mapping file!");
@@ -402,73 +474,127 @@ void CGForceMatching::EvalConfiguration(Topology *conf, Topology *) {
       }
     }
   }
+}
 
+template <typename Matrix>
+void CGForceMatching::FmatchAssignEquations(Topology *conf, Matrix &A,
+                                            votca::Index row0,
+                                            NBListMap &nblists,
+                                            NBList3BodyMap &nblists3body) {
   for (SplineInfo &sinfo : splines_) {
     if (sinfo.bonded) {
-      EvalBonded(conf, &sinfo);
+      EvalBonded(conf, &sinfo, A, row0);
     } else {
       if (sinfo.threebody) {
-        EvalNonbonded_Threebody(conf, &sinfo);
+        EvalNonbonded_Threebody(conf, &sinfo, A, row0, nblists3body);
       } else {
-        EvalNonbonded(conf, &sinfo);
+        EvalNonbonded(conf, &sinfo, A, row0, nblists);
       }
     }
   }
+}
 
+void CGForceMatching::FmatchAssignForces(Topology *conf, Eigen::VectorXd &b,
+                                         votca::Index row0) {
   // loop for the forces vector:
   // hack, change the Has functions..
   if (conf->getBead(0)->HasF()) {
     for (votca::Index iatom = 0; iatom < nbeads_; ++iatom) {
       const Eigen::Vector3d &Force = conf->getBead(iatom)->getF();
-      b_(least_sq_offset_ + 3 * nbeads_ * frame_counter_ + iatom) = Force.x();
-      b_(least_sq_offset_ + 3 * nbeads_ * frame_counter_ + nbeads_ + iatom) =
-          Force.y();
-      b_(least_sq_offset_ + 3 * nbeads_ * frame_counter_ + 2 * nbeads_ +
-         iatom) = Force.z();
+      b(row0 + iatom) = Force.x();
+      b(row0 + nbeads_ + iatom) = Force.y();
+      b(row0 + 2 * nbeads_ + iatom) = Force.z();
     }
   } else {
     throw std::runtime_error(
         "\nERROR in csg_fmatch::EvalConfiguration - No forces in "
         "configuration!");
   }
+}
+
+void CGForceMatching::EvalConfiguration(Topology *conf, Topology *) {
+  FmatchPrepareConfiguration(conf);
+
+  votca::Index row0 = least_sq_offset_ + 3 * nbeads_ * frame_counter_;
+  FmatchAssignEquations(conf, A_, row0, nblists_, nblists3body_);
+  FmatchAssignForces(conf, b_, row0);
+
   // update the frame counter
   frame_counter_ += 1;
 
   if (frame_counter_ % nframes_ == 0) {  // at this point we processed  nframes_
                                          // frames, which is enough for one
                                          // block
-                                         // update block counter
-    nblocks_++;
-    // solve FM equations and accumulate the result
-    FmatchAccumulateData();
-    // print status information
-    cout << "\nBlock No" << nblocks_ << " done!" << endl;
-    // write results to output files
-    WriteOutFiles();
-
-    // we must count frames from zero again for the next block
-    frame_counter_ = 0;
-    if (constr_least_sq_) {  // Constrained Least Squares
-      // Matrices should be cleaned after each block is evaluated
-      A_.setZero();
-      b_.setZero();
-      // clear and assign smoothing conditions to  B_constr_
-      FmatchAssignSmoothCondsToMatrix(B_constr_);
-    } else {  // Simple Least Squares
-      // Matrices should be cleaned after each block is evaluated
-      // clear and assign smoothing conditions to  A_
-      FmatchAssignSmoothCondsToMatrix(A_);
-      b_.setZero();
-    }
+    FmatchFinishBlock();
   }
   if (has_existing_forces_) {
     trjreader_force_->NextFrame(top_force_);
   }
 }
 
-void CGForceMatching::FmatchAccumulateData() {
+void CGForceMatching::FmatchFinishBlock() {
+  // update block counter
+  nblocks_++;
+  // solve FM equations and accumulate the result
+  FmatchAccumulateData();
+  // print status information
+  cout << "\nBlock No" << nblocks_ << " done!" << endl;
+  // write results to output files
+  WriteOutFiles();
+
+  // we must count frames from zero again for the next block
+  frame_counter_ = 0;
+  FmatchResetBlock();
+}
+
+void CGForceMatching::FmatchResetBlock() {
+  if (normal_equations_) {
+    // the smoothing conditions are part of every simple least squares block
+    if (constr_least_sq_) {
+      AtA_ = Eigen::MatrixXd::Zero(col_cntr_, col_cntr_);
+    } else {
+      AtA_ = B_constr_.transpose() * B_constr_;
+    }
+    Atb_ = Eigen::VectorXd::Zero(col_cntr_);
+    btb_ = 0.0;
+  } else if (constr_least_sq_) {  // Constrained Least Squares
+    // Matrices should be cleaned after each block is evaluated
+    A_.setZero();
+    b_.setZero();
+    // clear and assign smoothing conditions to  B_constr_
+    FmatchAssignSmoothCondsToMatrix(B_constr_);
+  } else {  // Simple Least Squares
+    // Matrices should be cleaned after each block is evaluated
+    // clear and assign smoothing conditions to  A_
+    FmatchAssignSmoothCondsToMatrix(A_);
+    b_.setZero();
+  }
+}
+
+void CGForceMatching::FmatchSolveNormalEquations() {
   if (constr_least_sq_) {  // Constrained Least Squares
-                           // Solving linear equations system
+    x_ = votca::tools::linalg_constrained_normalsolve(AtA_, Atb_, B_constr_);
+  } else {  // Simple Least Squares
+    x_ = votca::tools::linalg_constrained_normalsolve(
+        AtA_, Atb_, Eigen::MatrixXd::Zero(0, col_cntr_));
+    // |b - A*x|^2 expanded in the accumulated products
+    double fm_resid = btb_ - 2.0 * x_.dot(Atb_) + x_.dot(AtA_ * x_);
+
+    fm_resid /= (double)(3 * nbeads_ * frame_counter_);
+
+    cout << endl;
+    cout << "#### Force matching residual ####" << endl;
+    cout << "     Chi_2[(kJ/(mol*nm))^2] = " << fm_resid << endl;
+    cout << "#################################" << endl;
+    cout << endl;
+  }
+}
+
+void CGForceMatching::FmatchAccumulateData() {
+  if (normal_equations_) {
+    FmatchSolveNormalEquations();
+  } else if (constr_least_sq_) {  // Constrained Least Squares
+                                  // Solving linear equations system
     x_ = votca::tools::linalg_constrained_qrsolve(A_, b_, B_constr_);
   } else {  // Simple Least Squares
 
@@ -568,7 +694,9 @@ void CGForceMatching::LoadOptions(const string &file) {
   nonbonded_ = options_.Select("cg.non-bonded");
 }
 
-void CGForceMatching::EvalBonded(Topology *conf, SplineInfo *sinfo) {
+template <typename Matrix>
+void CGForceMatching::EvalBonded(Topology *conf, SplineInfo *sinfo, Matrix &A,
+                                 votca::Index row0) {
 
   std::vector<Interaction *> interList =
       conf->InteractionsInGroup(sinfo->splineName);
@@ -589,48 +717,57 @@ void CGForceMatching::EvalBonded(Topology *conf, SplineInfo *sinfo) {
       votca::Index ii = inter->getBeadId(loop);
       Eigen::Vector3d gradient = inter->Grad(*conf, loop);
 
-      SP.AddToFitMatrix(A_, var,
-                        least_sq_offset_ + 3 * nbeads_ * frame_counter_ + ii,
-                        mpos, -gradient.x());
-      SP.AddToFitMatrix(
-          A_, var,
-          least_sq_offset_ + 3 * nbeads_ * frame_counter_ + nbeads_ + ii, mpos,
-          -gradient.y());
-      SP.AddToFitMatrix(
-          A_, var,
-          least_sq_offset_ + 3 * nbeads_ * frame_counter_ + 2 * nbeads_ + ii,
-          mpos, -gradient.z());
+      SP.AddToFitMatrix(A, var, row0 + ii, mpos, -gradient.x());
+      SP.AddToFitMatrix(A, var, row0 + nbeads_ + ii, mpos, -gradient.y());
+      SP.AddToFitMatrix(A, var, row0 + 2 * nbeads_ + ii, mpos, -gradient.z());
     }
   }
 }
 
-void CGForceMatching::EvalNonbonded(Topology *conf, SplineInfo *sinfo) {
+votca::Index CGForceMatching::NBThreads() const {
+  // with several workers the cores are already busy with whole frames
+  if (nthreads_ > 1 || !options_.exists("cg.nbthreads")) {
+    return 1;
+  }
+  return options_.get("cg.nbthreads").as<votca::Index>();
+}
+
+template <typename Matrix>
+void CGForceMatching::EvalNonbonded(Topology *conf, SplineInfo *sinfo,
+                                    Matrix &A, votca::Index row0,
+                                    NBListMap &nblists) {
 
-  // generate the neighbour list
-  std::unique_ptr<NBList> nb;
+  // generate the neighbour list, it is kept across frames such that the
+  // Verlet candidates can be reused
+  std::unique_ptr<NBList> &nb = nblists[sinfo->splineIndex];
 
-  bool gridsearch = false;
+  if (!nb) {
+    bool gridsearch = false;
 
-  if (options_.exists("cg.nbsearch")) {
-    if (options_.get("cg.nbsearch").as<string>() == "grid") {
-      gridsearch = true;
-    } else if (options_.get("cg.nbsearch").as<string>() == "simple") {
-      gridsearch = false;
+    if (options_.exists("cg.nbsearch")) {
+      if (options_.get("cg.nbsearch").as<string>() == "grid") {
+        gridsearch = true;
+      } else if (options_.get("cg.nbsearch").as<string>() == "simple") {
+        gridsearch = false;
+      } else {
+        throw std::runtime_error("cg.nbsearch invalid, can be grid or simple");
+      }
+    }
+    if (gridsearch) {
+      auto grid = std::make_unique<NBListGrid>();
+      grid->setNumberOfThreads(NBThreads());
+      nb = std::move(grid);
     } else {
-      throw std::runtime_error("cg.nbsearch invalid, can be grid or simple");
+      nb = std::make_unique<NBList>();
     }
-  }
-  if (gridsearch) {
-    nb = std::make_unique<NBListGrid>();
-  } else {
-    nb = std::make_unique<NBList>();
-  }
 
-  nb->setCutoff(
-      sinfo->options_->get("fmatch.max").as<double>());  // implement different
-                                                         // cutoffs for
-                                                         // different
-                                                         // interactions!
+    // implement different cutoffs for different interactions!
+    nb->setCutoff(sinfo->options_->get("fmatch.max").as<double>());
+    if (options_.exists("cg.nbskin")) {
+      nb->setSkin(options_.get("cg.nbskin").as<double>());
+    }
+  }
+  nb->Cleanup();
 
   // generate the bead lists
   BeadList beads1, beads2;
@@ -656,61 +793,51 @@ void CGForceMatching::EvalNonbonded(Topology *conf, SplineInfo *sinfo) {
     votca::Index mpos = sinfo->matr_pos;
 
     // add iatom
-    SP.AddToFitMatrix(A_, var,
-                      least_sq_offset_ + 3 * nbeads_ * frame_counter_ + iatom,
-                      mpos, gradient.x());
-    SP.AddToFitMatrix(
-        A_, var,
-        least_sq_offset_ + 3 * nbeads_ * frame_counter_ + nbeads_ + iatom, mpos,
-        gradient.y());
-    SP.AddToFitMatrix(
-        A_, var,
-        least_sq_offset_ + 3 * nbeads_ * frame_counter_ + 2 * nbeads_ + iatom,
-        mpos, gradient.z());
+    SP.AddToFitMatrix(A, var, row0 + iatom, mpos, gradient.x());
+    SP.AddToFitMatrix(A, var, row0 + nbeads_ + iatom, mpos, gradient.y());
+    SP.AddToFitMatrix(A, var, row0 + 2 * nbeads_ + iatom, mpos, gradient.z());
 
     // add jatom
-    SP.AddToFitMatrix(A_, var,
-                      least_sq_offset_ + 3 * nbeads_ * frame_counter_ + jatom,
-                      mpos, -gradient.x());
-    SP.AddToFitMatrix(
-        A_, var,
-        least_sq_offset_ + 3 * nbeads_ * frame_counter_ + nbeads_ + jatom, mpos,
-        -gradient.y());
-    SP.AddToFitMatrix(
-        A_, var,
-        least_sq_offset_ + 3 * nbeads_ * frame_counter_ + 2 * nbeads_ + jatom,
-        mpos, -gradient.z());
+    SP.AddToFitMatrix(A, var, row0 + jatom, mpos, -gradient.x());
+    SP.AddToFitMatrix(A, var, row0 + nbeads_ + jatom, mpos, -gradient.y());
+    SP.AddToFitMatrix(A, var, row0 + 2 * nbeads_ + jatom, mpos, -gradient.z());
   }
 }
 
-void CGForceMatching::EvalNonbonded_Threebody(Topology *conf,
-                                              SplineInfo *sinfo) {
-  // so far option gridsearch ignored. Only simple search
-
-  // generate the neighbour list
-  std::unique_ptr<NBList_3Body> nb;
-
-  bool gridsearch = false;
-
-  if (options_.exists("cg.nbsearch")) {
-    if (options_.get("cg.nbsearch").as<string>() == "grid") {
-      gridsearch = true;
-    } else if (options_.get("cg.nbsearch").as<string>() == "simple") {
-      gridsearch = false;
+template <typename Matrix>
+void CGForceMatching::EvalNonbonded_Threebody(Topology *conf, SplineInfo *sinfo,
+                                              Matrix &A, votca::Index row0,
+                                              NBList3BodyMap &nblists) {
+  // generate the neighbour list, it is kept across frames such that the
+  // threads of the grid search are only started once
+  std::unique_ptr<NBList_3Body> &nb = nblists[sinfo->splineIndex];
+
+  if (!nb) {
+    bool gridsearch = false;
+
+    if (options_.exists("cg.nbsearch")) {
+      if (options_.get("cg.nbsearch").as<string>() == "grid") {
+        gridsearch = true;
+      } else if (options_.get("cg.nbsearch").as<string>() == "simple") {
+        gridsearch = false;
+      } else {
+        throw std::runtime_error("cg.nbsearch invalid, can be grid or simple");
+      }
+    }
+    if (gridsearch) {
+      auto grid = std::make_unique<NBListGrid_3Body>();
+      grid->setNumberOfThreads(NBThreads());
+      nb = std::move(grid);
     } else {
-      throw std::runtime_error("cg.nbsearch invalid, can be grid or simple");
+      nb = std::make_unique<NBList_3Body>();
     }
-  }
-  if (gridsearch) {
-    nb = std::make_unique<NBListGrid_3Body>();
-  } else {
-    nb = std::make_unique<NBList_3Body>();
-  }
 
-  nb->setCutoff(sinfo->a);  // implement different cutoffs for different
-                            // interactions!
-  // Here, a is the distance between two beads of a triple, where the 3-body
-  // interaction is zero
+    nb->setCutoff(sinfo->a);  // implement different cutoffs for different
+                              // interactions!
+    // Here, a is the distance between two beads of a triple, where the 3-body
+    // interaction is zero
+  }
+  nb->Cleanup();
 
   // generate the bead lists
   BeadList beads1, beads2, beads3;
@@ -788,17 +915,12 @@ void CGForceMatching::EvalNonbonded_Threebody(Topology *conf,
         expij * expik;
 
     // add iatom
-    SP.AddToFitMatrix(A_, var,
-                      least_sq_offset_ + 3 * nbeads_ * frame_counter_ + iatom,
-                      mpos, -gradient1.x(), -gradient2.x());
-    SP.AddToFitMatrix(
-        A_, var,
-        least_sq_offset_ + 3 * nbeads_ * frame_counter_ + nbeads_ + iatom, mpos,
-        -gradient1.y(), -gradient2.y());
-    SP.AddToFitMatrix(
-        A_, var,
-        least_sq_offset_ + 3 * nbeads_ * frame_counter_ + 2 * nbeads_ + iatom,
-        mpos, -gradient1.z(), -gradient2.z());
+    SP.AddToFitMatrix(A, var, row0 + iatom, mpos, -gradient1.x(),
+                      -gradient2.x());
+    SP.AddToFitMatrix(A, var, row0 + nbeads_ + iatom, mpos, -gradient1.y(),
+                      -gradient2.y());
+    SP.AddToFitMatrix(A, var, row0 + 2 * nbeads_ + iatom, mpos, -gradient1.z(),
+                      -gradient2.z());
 
     // evaluate gradient1 and gradient2 for jatom:
     gradient1 = acos_prime *
@@ -810,17 +932,12 @@ void CGForceMatching::EvalNonbonded_Threebody(Topology *conf,
                 expij * expik;
 
     // add jatom
-    SP.AddToFitMatrix(A_, var,
-                      least_sq_offset_ + 3 * nbeads_ * frame_counter_ + jatom,
-                      mpos, -gradient1.x(), -gradient2.x());
-    SP.AddToFitMatrix(
-        A_, var,
-        least_sq_offset_ + 3 * nbeads_ * frame_counter_ + nbeads_ + jatom, mpos,
-        -gradient1.y(), -gradient2.y());
-    SP.AddToFitMatrix(
-        A_, var,
-        least_sq_offset_ + 3 * nbeads_ * frame_counter_ + 2 * nbeads_ + jatom,
-        mpos, -gradient1.z(), -gradient2.z());
+    SP.AddToFitMatrix(A, var, row0 + jatom, mpos, -gradient1.x(),
+                      -gradient2.x());
+    SP.AddToFitMatrix(A, var, row0 + nbeads_ + jatom, mpos, -gradient1.y(),
+                      -gradient2.y());
+    SP.AddToFitMatrix(A, var, row0 + 2 * nbeads_ + jatom, mpos, -gradient1.z(),
+                      -gradient2.z());
 
     // evaluate gradient1 and gradient2 for katom:
     gradient1 = acos_prime *
@@ -832,16 +949,11 @@ void CGForceMatching::EvalNonbonded_Threebody(Topology *conf,
                 expij * expik;
 
     // add katom
-    SP.AddToFitMatrix(A_, var,
-                      least_sq_offset_ + 3 * nbeads_ * frame_counter_ + katom,
-                      mpos, -gradient1.x(), -gradient2.x());
-    SP.AddToFitMatrix(
-        A_, var,
-        least_sq_offset_ + 3 * nbeads_ * frame_counter_ + nbeads_ + katom, mpos,
-        -gradient1.y(), -gradient2.y());
-    SP.AddToFitMatrix(
-        A_, var,
-        least_sq_offset_ + 3 * nbeads_ * frame_counter_ + 2 * nbeads_ + katom,
-        mpos, -gradient1.z(), -gradient2.z());
+    SP.AddToFitMatrix(A, var, row0 + katom, mpos, -gradient1.x(),
+                      -gradient2.x());
+    SP.AddToFitMatrix(A, var, row0 + nbeads_ + katom, mpos, -gradient1.y(),
+                      -gradient2.y());
+    SP.AddToFitMatrix(A, var, row0 + 2 * nbeads_ + katom, mpos, -gradient1.z(),
+                      -gradient2.z());
   }
 }
@@ -18,12 +18,19 @@
 #ifndef VOTCA_CSG_CSG_FMATCH_H
 #define VOTCA_CSG_CSG_FMATCH_H
 
+// Standard includes
+#include <map>
+#include <memory>
+#include <vector>
+
 // VOTCA includes
 #include <votca/tools/cubicspline.h>
 #include <votca/tools/property.h>
 
 // Local VOTCA includes
 #include "votca/csg/csgapplication.h"
+#include "votca/csg/nblist.h"
+#include "votca/csg/nblist_3body.h"
 #include "votca/csg/trajectoryreader.h"
 
 using namespace votca::csg;
@@ -37,6 +44,11 @@ using namespace std;
  *  using cubic spline basis set. Block averaging over trajectory blocks
  *  is used for calculating CG forces and their errors.
  *
+ *  With cg.fmatch.normal_equations the workers fill the equations of their
+ *  frames into sparse per frame matrices and only the normal equations
+ *  A^T*A and A^T*b of a block are kept, such that the memory does not depend
+ *  on the number of frames per block.
+ *
  * \todo force matching needs a big cleanup!
  **/
 
@@ -49,6 +61,7 @@ class CGForceMatching : public CsgApplication {
 
   bool DoTrajectory() override { return true; }
   bool DoMapping() override { return true; }
+  bool DoThreaded() override { return true; }
 
   void Initialize(void) override;
   bool EvaluateOptions() override;
@@ -62,8 +75,63 @@ class CGForceMatching : public CsgApplication {
                          Topology *conf_atom = nullptr) override;
   /// \brief load options from the input file
   void LoadOptions(const string &file);
+  /// \brief threads to build a single neighbour list, only used if the
+  /// frames are not distributed over several workers
+  votca::Index NBThreads() const;
+
+  std::unique_ptr<CsgApplication::Worker> ForkWorker() override;
+  void MergeWorker(CsgApplication::Worker *worker) override;
 
  protected:
+  using NBListMap = std::map<votca::Index, std::unique_ptr<NBList>>;
+  using NBList3BodyMap = std::map<votca::Index, std::unique_ptr<NBList_3Body>>;
+
+  /// \brief one entry of the force matching equations, in the triplet layout
+  /// expected by Eigen::SparseMatrix::setFromTriplets
+  struct FitEntry {
+    FitEntry(votca::Index row, votca::Index col)
+        : row_(row), col_(col), value_(0.0) {}
+    votca::Index row() const { return row_; }
+    votca::Index col() const { return col_; }
+    double value() const { return value_; }
+    votca::Index row_;
+    votca::Index col_;
+    double value_;
+  };
+
+  /// \brief collects the equations of one frame as a list of entries, stands
+  /// in for the dense matrix in CubicSpline::AddToFitMatrix. Entries with the
+  /// same row and column are summed when the sparse matrix is built.
+  class FitEntries {
+   public:
+    double &operator()(votca::Index row, votca::Index col) {
+      entries_.emplace_back(row, col);
+      return entries_.back().value_;
+    }
+    std::vector<FitEntry> entries_;
+  };
+
+  /// \brief fills the equations of the frames it is given, in normal
+  /// equation mode in parallel to the other workers
+  class Worker : public CsgApplication::Worker {
+   public:
+    void EvalConfiguration(Topology *conf,
+                           Topology *conf_atom = nullptr) override;
+
+    CGForceMatching *fmatch_;
+    /// \brief frame to be merged, stays valid until the next frame is read
+    Topology *conf_ = nullptr;
+    /// \brief equations of the current frame (normal equation mode)
+    FitEntries rows_;
+    /// \brief matrix of the current frame, 3*nbeads rows
+    Eigen::SparseMatrix<double> frame_A_;
+    /// \brief A^T*A of the current frame
+    Eigen::SparseMatrix<double> frame_AtA_;
+    /// \brief neighbour lists of this worker, kept across frames
+    NBListMap nblists_;
+    NBList3BodyMap nblists3body_;
+  };
+
   /// \brief structure, which contains CubicSpline object with related
   /// parameters
   struct SplineInfo {
@@ -180,20 +248,53 @@ class CGForceMatching : public CsgApplication {
 
   bool has_existing_forces_;
 
+  /// \brief true: accumulate the normal equations of the frames instead of
+  /// storing all equations of a block in  A_
+  bool normal_equations_;
+  /// \brief A^T*A of the current block (normal equation mode), starts with
+  /// the smoothing conditions for simple least squares
+  Eigen::MatrixXd AtA_;
+  /// \brief A^T*b of the current block (normal equation mode)
+  Eigen::VectorXd Atb_;
+  /// \brief b^T*b of the current block (normal equation mode)
+  double btb_;
+
   /// \brief Solves FM equations for one block and stores the results for
   /// further processing
   void FmatchAccumulateData();
+  /// \brief Solves the accumulated normal equations of one block
+  void FmatchSolveNormalEquations();
+  /// \brief Solves, writes out and resets the current block
+  void FmatchFinishBlock();
+  /// \brief Clears the equations for the next block
+  void FmatchResetBlock();
+  /// \brief Checks the frame and subtracts the already known forces
+  void FmatchPrepareConfiguration(Topology *conf);
+  /// \brief Writes the reference forces of the frame to b starting at row0
+  void FmatchAssignForces(Topology *conf, Eigen::VectorXd &b,
+                          votca::Index row0);
+  /// \brief Writes the equations of all interactions of the frame to A
+  /// starting at row0
+  template <typename Matrix>
+  void FmatchAssignEquations(Topology *conf, Matrix &A, votca::Index row0,
+                             NBListMap &nblists, NBList3BodyMap &nblists3body);
   /// \brief Assigns smoothing conditions to matrices  A_ and  B_constr_
   void FmatchAssignSmoothCondsToMatrix(Eigen::MatrixXd &Matrix);
   /// \brief For each trajectory frame writes equations for bonded interactions
-  /// to matrix  A_
-  void EvalBonded(Topology *conf, SplineInfo *sinfo);
+  /// to matrix A
+  template <typename Matrix>
+  void EvalBonded(Topology *conf, SplineInfo *sinfo, Matrix &A,
+                  votca::Index row0);
   /// \brief For each trajectory frame writes equations for non-bonded
-  /// interactions to matrix  A_
-  void EvalNonbonded(Topology *conf, SplineInfo *sinfo);
+  /// interactions to matrix A
+  template <typename Matrix>
+  void EvalNonbonded(Topology *conf, SplineInfo *sinfo, Matrix &A,
+                     votca::Index row0, NBListMap &nblists);
   /// \brief For each trajectory frame writes equations for non-bonded threebody
-  /// interactions to matrix  A_
-  void EvalNonbonded_Threebody(Topology *conf, SplineInfo *sinfo);
+  /// interactions to matrix A
+  template <typename Matrix>
+  void EvalNonbonded_Threebody(Topology *conf, SplineInfo *sinfo, Matrix &A,
+                               votca::Index row0, NBList3BodyMap &nblists);
   /// \brief Write results to output files
   void WriteOutFiles();
 
@@ -201,6 +302,10 @@ class CGForceMatching : public CsgApplication {
 
   Topology top_force_;
   std::unique_ptr<TrajectoryReader> trjreader_force_;
+
+  /// \brief non-bonded neighbour lists kept across frames (Verlet mode)
+  NBListMap nblists_;
+  NBList3BodyMap nblists3body_;
 };
 
 #endif  // VOTCA_CSG_CSG_FMATCH_H
@@ -465,6 +465,10 @@ std::unique_ptr<CsgApplication::Worker> CsgREupdate::ForkWorker() {
 
   // initialize worker
   worker->options_ = options_;
+  // with several workers the cores are already busy with whole frames
+  if (nthreads_ == 1 && options_.exists("cg.nbthreads")) {
+    worker->nbthreads_ = options_.get("cg.nbthreads").as<votca::Index>();
+  }
   worker->nonbonded_ = nonbonded_;
   worker->nlamda_ = 0;
 
@@ -570,27 +574,35 @@ void CsgREupdateWorker::EvalNonbonded(Topology *conf, PotentialInfo *potinfo) {
                              potinfo->potentialName + "\"");
   }
 
-  std::unique_ptr<NBList> nb;
-  bool gridsearch = false;
+  // the list is kept across frames such that the threads of the grid search
+  // are only started once
+  std::unique_ptr<NBList> &nb = nblists_[potinfo];
+
+  if (!nb) {
+    bool gridsearch = false;
 
-  if (options_.exists("cg.nbsearch")) {
+    if (options_.exists("cg.nbsearch")) {
+
+      if (options_.get("cg.nbsearch").as<string>() == "grid") {
+        gridsearch = true;
+      } else if (options_.get("cg.nbsearch").as<string>() == "simple") {
+        gridsearch = false;
+      } else {
+        throw std::runtime_error("cg.nbsearch invalid, can be grid or simple");
+      }
+    }
 
-    if (options_.get("cg.nbsearch").as<string>() == "grid") {
-      gridsearch = true;
-    } else if (options_.get("cg.nbsearch").as<string>() == "simple") {
-      gridsearch = false;
+    if (gridsearch) {
+      auto grid = std::make_unique<NBListGrid>();
+      grid->setNumberOfThreads(nbthreads_);
+      nb = std::move(grid);
     } else {
-      throw std::runtime_error("cg.nbsearch invalid, can be grid or simple");
+      nb = std::make_unique<NBList>();
     }
-  }
 
-  if (gridsearch) {
-    nb = std::make_unique<NBListGrid>();
-  } else {
-    nb = std::make_unique<NBList>();
+    nb->setCutoff(potinfo->ucg->getCutOff());
   }
-
-  nb->setCutoff(potinfo->ucg->getCutOff());
+  nb->Cleanup();
 
   if (potinfo->type1 == potinfo->type2) {  // same beads
     nb->Generate(beads1, true);
@@ -18,6 +18,10 @@
 #ifndef VOTCA_CSG_CSG_REUPDATE_H
 #define VOTCA_CSG_CSG_REUPDATE_H
 
+// Standard includes
+#include <map>
+#include <memory>
+
 // Third party includes
 #include <boost/program_options.hpp>
 
@@ -28,6 +32,7 @@
 
 // Local VOTCA includes
 #include "votca/csg/csgapplication.h"
+#include "votca/csg/nblist.h"
 #include "votca/csg/potentialfunctions/potentialfunction.h"
 #include "votca/csg/potentialfunctions/potentialfunctioncbspl.h"
 #include "votca/csg/potentialfunctions/potentialfunctionlj126.h"
@@ -152,6 +157,10 @@ class CsgREupdateWorker : public CsgApplication::Worker {
   double UavgCG_;
   double beta_;
   votca::Index nframes_;
+  /// threads to build a single neighbour list
+  votca::Index nbthreads_ = 1;
+  /// neighbour lists of the nonbonded potentials, kept across frames
+  std::map<PotentialInfo *, std::unique_ptr<NBList>> nblists_;
 
   void EvalConfiguration(Topology *conf, Topology *conf_atom) override;
   void EvalBonded(Topology *conf, PotentialInfo *potinfo);
@@ -241,6 +241,7 @@ void Imc::EndEvaluate() {
       string suffix = string(".") + extension_;
       WriteDist(suffix);
       if (do_imc_) {
+        ReduceCorrelations();
         WriteIMCData();
       }
     }
@@ -248,6 +249,7 @@ void Imc::EndEvaluate() {
   // clear interactions and groups
   interactions_.clear();
   groups_.clear();
+  workers_.clear();
   if (!processed_some_frames_) {
     throw std::runtime_error(
         "no frames were processed. Please check your input");
@@ -263,6 +265,16 @@ void Imc::LoadOptions(const string &file) {
 
 // evaluate current conformation
 void Imc::Worker::EvalConfiguration(Topology *top, Topology *) {
+  // full batches are added to the correlations here and not in the
+  // serialized merge
+  {
+    std::lock_guard<std::mutex> lock(correlations_mutex_);
+    for (correlation_batch_t &batch : correlations_) {
+      if (batch.full()) {
+        batch.Flush();
+      }
+    }
+  }
 
   cur_vol_ = top->BoxVolume();
   // process non-bonded interactions
@@ -282,21 +294,22 @@ void Imc::ClearAverages() {
   }
   for (auto &group : groups_) {
     group.second->corr_.setZero();
+    group.second->corr_sum_.setZero();
   }
 }
 
-class IMCNBSearchHandler {
- public:
-  explicit IMCNBSearchHandler(votca::tools::HistogramNew *hist)
-      : hist_(*hist) {}
-
-  votca::tools::HistogramNew &hist_;
-
-  bool FoundPair(Bead *, Bead *, const Eigen::Vector3d &, const double dist) {
-    hist_.Process(dist);
-    return false;
+NBList &Imc::Worker::getNBList(std::map<Index, std::unique_ptr<NBList>> &lists,
+                               const interaction_t &i) {
+  std::unique_ptr<NBList> &nb = lists[i.index_];
+  if (!nb) {
+    nb = std::make_unique<NBListGrid>();
+    nb->setCutoff(i.max_ + i.step_);
+    if (imc_->options_.exists("cg.nbskin")) {
+      nb->setSkin(imc_->options_.get("cg.nbskin").as<double>());
+    }
   }
-};
+  return *nb;
+}
 
 // process non-bonded interactions for current frame
 void Imc::Worker::DoNonbonded(Topology *top) {
@@ -395,49 +408,35 @@ void Imc::Worker::DoNonbonded(Topology *top) {
       beads2.Generate(*top, prop->get("type2").value());
 
       {
-        // generate the neighbour list
-        std::unique_ptr<NBList> nb;
-        if (gridsearch) {
-          nb = std::unique_ptr<NBList>(new NBListGrid());
-        } else {
-          nb = std::unique_ptr<NBList>(new NBListGrid());
-        }
-
-        nb->setCutoff(i.max_ + i.step_);
-
-        IMCNBSearchHandler h(&(current_hists_[i.index_]));
-
-        nb->SetMatchFunction(&h, &IMCNBSearchHandler::FoundPair);
+        // histogram all pairs directly, they are not stored
+        NBList &nb = getNBList(nblists_, i);
+        tools::HistogramNew &hist = current_hists_[i.index_];
+        auto process = [&hist](Bead *, Bead *, const Eigen::Vector3d &,
+                               double dist) { hist.Process(dist); };
 
         // is it same types or different types?
         if (prop->get("type1").value() == prop->get("type2").value()) {
-          nb->Generate(beads1, !(imc_->include_intra_));
+          nb.ForEachPair(beads1, process, !(imc_->include_intra_));
         } else {
-          nb->Generate(beads1, beads2, !(imc_->include_intra_));
+          nb.ForEachPair(beads1, beads2, process, !(imc_->include_intra_));
         }
       }
 
       // if one wants to calculate the mean force
       if (i.force_) {
-        std::unique_ptr<NBList> nb_force;
-        if (gridsearch) {
-          nb_force = std::unique_ptr<NBList>(new NBListGrid());
-        } else {
-          nb_force = std::unique_ptr<NBList>(new NBListGrid());
-        }
-
-        nb_force->setCutoff(i.max_ + i.step_);
+        NBList &nb_force = getNBList(nblists_force_, i);
+        nb_force.Cleanup();
 
         // is it same types or different types?
         if (prop->get("type1").value() == prop->get("type2").value()) {
-          nb_force->Generate(beads1);
+          nb_force.Generate(beads1);
         } else {
-          nb_force->Generate(beads1, beads2);
+          nb_force.Generate(beads1, beads2);
         }
 
         // process all pairs to calculate the projection of the
         // mean force on bead 1 on the pair distance: F1 * r12
-        for (auto &pair : *nb_force) {
+        for (auto &pair : nb_force) {
           Eigen::Vector3d F2 = pair->second()->getF();
           Eigen::Vector3d F1 = pair->first()->getF();
           Eigen::Vector3d r12 = pair->r();
@@ -491,8 +490,10 @@ void Imc::InitializeGroups() {
   // clear all the pairs
 
   // iterator over all groups
+  votca::Index index = 0;
   for (auto &group : groups_) {
     auto &grp = group.second;
+    grp->index_ = index++;
     grp->pairs_.clear();
 
     auto &interactions = grp->interactions_;
@@ -507,6 +508,7 @@ void Imc::InitializeGroups() {
 
     // initialize matrix with zeroes
     M = Eigen::MatrixXd::Zero(n, n);
+    grp->corr_sum_ = Eigen::MatrixXd::Zero(n, n);
 
     // now create references to the sub matrices and offsets
     votca::Index offset_i = 0;
@@ -529,21 +531,60 @@ void Imc::InitializeGroups() {
   }
 }
 
-// update the correlation matrix
+// add the histograms of the frame to the correlation batches of the worker
 void Imc::DoCorrelations(Imc::Worker *worker) {
   if (!do_imc_) {
     return;
   }
 
+  std::lock_guard<std::mutex> lock(worker->correlations_mutex_);
   for (auto &group : groups_) {
     auto &grp = group.second;
-    // update correlation for all pairs
+    correlation_batch_t &batch = worker->correlations_[grp->index_];
+    if (batch.full()) {
+      batch.Flush();
+    }
+    votca::Index offset = 0;
+    for (interaction_t *i : grp->interactions_) {
+      const Eigen::VectorXd &h = worker->current_hists_[i->index_].data().y();
+      batch.frames_.col(batch.nframes_).segment(offset, h.size()) = h;
+      offset += h.size();
+    }
+    batch.nframes_++;
+  }
+}
+
+void Imc::correlation_batch_t::Flush() {
+  if (nframes_ == 0) {
+    return;
+  }
+  sum_.selfadjointView<Eigen::Upper>().rankUpdate(frames_.leftCols(nframes_));
+  nframes_ = 0;
+}
+
+// update the correlation matrix
+void Imc::ReduceCorrelations() {
+  if (!do_imc_ || nframes_ == 0) {
+    return;
+  }
+
+  for (Imc::Worker *worker : workers_) {
+    std::lock_guard<std::mutex> lock(worker->correlations_mutex_);
+    for (auto &group : groups_) {
+      auto &grp = group.second;
+      correlation_batch_t &batch = worker->correlations_[grp->index_];
+      batch.Flush();
+      grp->corr_sum_ += batch.sum_;
+      batch.sum_.setZero();
+    }
+  }
+
+  for (auto &group : groups_) {
+    auto &grp = group.second;
+    group_matrix sum = grp->corr_sum_.selfadjointView<Eigen::Upper>();
     for (auto &pair : grp->pairs_) {
-      Eigen::VectorXd &a = worker->current_hists_[pair.i1_->index_].data().y();
-      Eigen::VectorXd &b = worker->current_hists_[pair.i2_->index_].data().y();
       pair_matrix &M = pair.corr_;
-
-      M = ((((double)nframes_ - 1.0) * M) + a * b.transpose()) /
+      M = sum.block(pair.offset_i_, pair.offset_j_, M.rows(), M.cols()) /
           (double)nframes_;
     }
   }
@@ -843,6 +884,16 @@ std::unique_ptr<CsgApplication::Worker> Imc::ForkWorker() {
   worker->current_hists_.resize(interactions_.size());
   worker->current_hists_force_.resize(interactions_.size());
   worker->imc_ = this;
+  workers_.push_back(worker.get());
+
+  worker->correlations_.resize(groups_.size());
+  for (auto &group : groups_) {
+    auto &grp = group.second;
+    correlation_batch_t &batch = worker->correlations_[grp->index_];
+    votca::Index n = grp->corr_.rows();
+    batch.frames_ = Eigen::MatrixXd::Zero(n, correlation_batch_size_);
+    batch.sum_ = Eigen::MatrixXd::Zero(n, n);
+  }
 
   for (auto &interaction : interactions_) {
     auto &i = interaction.second;
@@ -893,6 +944,7 @@ void Imc::MergeWorker(CsgApplication::Worker *worker_) {
       string suffix = string("_") + boost::lexical_cast<string>(nblock_) +
                       string(".") + extension_;
       WriteDist(suffix);
+      ReduceCorrelations();
       WriteIMCData(suffix);
       WriteIMCBlock(suffix);
       ClearAverages();
@@ -18,6 +18,10 @@
 #ifndef VOTCA_CSG_CSG_STAT_IMC_H
 #define VOTCA_CSG_CSG_STAT_IMC_H
 
+// Standard includes
+#include <mutex>
+#include <vector>
+
 // VOTCA includes
 #include <votca/tools/average.h>
 #include <votca/tools/histogramnew.h>
@@ -25,6 +29,7 @@
 
 // Local VOTCA includes
 #include "votca/csg/csgapplication.h"
+#include "votca/csg/nblist.h"
 
 namespace votca {
 namespace csg {
@@ -86,11 +91,29 @@ class Imc {
 
   /// struct to store collected information for groups (e.g. crosscorrelations)
   struct group_t {
+    votca::Index index_;
     std::vector<interaction_t *> interactions_;
+    /// average of h*h^T over the frames, only the pair blocks are set
     group_matrix corr_;
+    /// upper triangle of the sum of h*h^T over the frames reduced so far
+    group_matrix corr_sum_;
     std::vector<pair_t> pairs_;
   };
 
+  /// histograms of a group for several frames, one column per frame, which
+  /// are added to the correlations with a single rank-k update
+  struct correlation_batch_t {
+    group_matrix frames_;
+    votca::Index nframes_ = 0;
+    /// upper triangle of the sum of h*h^T over the flushed frames
+    group_matrix sum_;
+
+    bool full() const { return nframes_ == frames_.cols(); }
+    void Flush();
+  };
+  /// frames per rank-k update of the correlations
+  static constexpr votca::Index correlation_batch_size_ = 32;
+
   /// the options parsed from cg definition file
   tools::Property options_;
   // length of the block to write out and averages are clear after every write
@@ -141,6 +164,14 @@ class Imc {
     std::vector<tools::HistogramNew> current_hists_force_;
     Imc *imc_;
     double cur_vol_;
+    /// non-bonded neighbour lists per interaction, kept across frames such
+    /// that the Verlet candidates can be reused
+    std::map<Index, std::unique_ptr<NBList>> nblists_;
+    std::map<Index, std::unique_ptr<NBList>> nblists_force_;
+    /// correlations of the merged frames per group, only reduced at the end
+    /// of a block, guarded by correlations_mutex_
+    std::vector<correlation_batch_t> correlations_;
+    std::mutex correlations_mutex_;
 
     /// evaluate current conformation
     void EvalConfiguration(Topology *top, Topology *top_atom) override;
@@ -148,9 +179,18 @@ class Imc {
     void DoNonbonded(Topology *top);
     /// process bonded interactions for given frame
     void DoBonded(Topology *top);
+    /// get the persistent neighbour list of an interaction
+    NBList &getNBList(std::map<Index, std::unique_ptr<NBList>> &lists,
+                      const interaction_t &i);
   };
   /// update the correlations after interations were processed
   void DoCorrelations(Imc::Worker *worker);
+  /// add the correlations of all workers to the groups and update the
+  /// averages
+  void ReduceCorrelations();
+
+  /// all workers, their correlations are reduced at the end of a block
+  std::vector<Imc::Worker *> workers_;
 
   bool processed_some_frames_ = false;
 
@@ -39,6 +39,22 @@ Eigen::VectorXd linalg_constrained_qrsolve(const Eigen::MatrixXd& A,
                                            const Eigen::VectorXd& b,
                                            const Eigen::MatrixXd& constr);
 
+/**
+ * \brief solves A*x=b in the least squares sense under the constraint B*x = 0
+ * from the normal equations
+ * @return x
+ * @param AtA the product A^T*A
+ * @param Atb the product A^T*b
+ * @param constr constrained condition
+ *
+ * Same null space approach as linalg_constrained_qrsolve, but only needs the
+ * accumulated A^T*A and A^T*b instead of the full matrix A. constr may have
+ * zero rows for an unconstrained fit.
+ */
+Eigen::VectorXd linalg_constrained_normalsolve(const Eigen::MatrixXd& AtA,
+                                               const Eigen::VectorXd& Atb,
+                                               const Eigen::MatrixXd& constr);
+
 }  // namespace tools
 }  // namespace votca
 
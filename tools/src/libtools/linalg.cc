@@ -16,7 +16,9 @@
  */
 
 // Standard includes
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <sstream>
 
 // Local VOTCA includes
@@ -63,5 +65,44 @@ Eigen::VectorXd linalg_constrained_qrsolve(const Eigen::MatrixXd &A,
   return QR.householderQ() * result;
 }
 
+Eigen::VectorXd linalg_constrained_normalsolve(const Eigen::MatrixXd &AtA,
+                                               const Eigen::VectorXd &Atb,
+                                               const Eigen::MatrixXd &constr) {
+  // a zero column in A is a zero on the diagonal of A^T*A, relative to the
+  // largest diagonal element so the check does not depend on the units
+  const double zero = (AtA.cols() > 0)
+                          ? AtA.diagonal().cwiseAbs().maxCoeff() *
+                                std::numeric_limits<double>::epsilon()
+                          : 0.0;
+  for (Index j = 0; j < AtA.cols(); j++) {
+    if (std::abs(AtA(j, j)) <= zero) {
+      throw std::runtime_error("constrained_normalsolve_zero_column_in_matrix");
+    }
+  }
+
+  const Index NoVariables = AtA.cols();
+  const Index NoConstrains = constr.rows();
+  const Index deg_of_freedom = NoVariables - NoConstrains;
+
+  Eigen::HouseholderQR<Eigen::MatrixXd> QR(constr.transpose());
+  Eigen::MatrixXd Q = QR.householderQ();
+  // x = Q2 * z, with Q2 spanning the null space of constr, turns the problem
+  // into the unconstrained normal equations Q2^T*A^T*A*Q2 * z = Q2^T*A^T*b
+  const auto Q2 = Q.rightCols(deg_of_freedom);
+  Eigen::MatrixXd N = Q2.transpose() * AtA * Q2;
+  Eigen::VectorXd rhs = Q2.transpose() * Atb;
+
+  // scale to unit diagonal, which keeps the squared condition number of the
+  // normal equations within reach of the Cholesky decomposition
+  Eigen::VectorXd scale = N.diagonal().cwiseAbs().cwiseSqrt().cwiseInverse();
+  N = scale.asDiagonal() * N * scale.asDiagonal();
+  Eigen::LDLT<Eigen::MatrixXd> ldlt(N);
+  if (ldlt.info() != Eigen::Success) {
+    throw std::runtime_error("constrained_normalsolve_decomposition_failed");
+  }
+  Eigen::VectorXd z = scale.asDiagonal() * ldlt.solve(scale.asDiagonal() * rhs);
+  return Q2 * z;
+}
+
 }  // namespace tools
 }  // namespace votca
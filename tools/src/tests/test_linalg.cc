@@ -68,4 +68,39 @@ BOOST_AUTO_TEST_CASE(linalg_constrained_qrsolve_test) {
   BOOST_CHECK_EQUAL(equal, true);
 }
 
+BOOST_AUTO_TEST_CASE(linalg_constrained_normalsolve_test) {
+  // overdetermined system, the normal equations have to reproduce the qr
+  // solution
+  Eigen::MatrixXd A = Eigen::MatrixXd::Zero(5, 3);
+  A << 1, 1, 1, 1, -1, 0, 0, 1, 1, 2, 0, 1, 1, 3, -1;
+  Eigen::VectorXd b = Eigen::VectorXd::Zero(5);
+  b << 11, -3, 8, 4, 1;
+  Eigen::MatrixXd B = Eigen::MatrixXd::Zero(1, 3);
+  B(0, 1) = -1;
+  B(0, 2) = 3;
+
+  Eigen::MatrixXd AtA = A.transpose() * A;
+  Eigen::VectorXd Atb = A.transpose() * b;
+
+  Eigen::VectorXd x_ref = linalg_constrained_qrsolve(A, b, B);
+  Eigen::VectorXd x = linalg_constrained_normalsolve(AtA, Atb, B);
+  BOOST_CHECK(x_ref.isApprox(x, 1e-10));
+  BOOST_CHECK_SMALL((B * x).norm(), 1e-10);
+
+  // without constraints this is the plain least squares solution
+  Eigen::MatrixXd none = Eigen::MatrixXd::Zero(0, 3);
+  x_ref = A.householderQr().solve(b);
+  x = linalg_constrained_normalsolve(AtA, Atb, none);
+  BOOST_CHECK(x_ref.isApprox(x, 1e-10));
+
+  // the zero column check is relative, tiny units are fine
+  x = linalg_constrained_normalsolve(1e-24 * AtA, 1e-24 * Atb, none);
+  BOOST_CHECK(x_ref.isApprox(x, 1e-10));
+
+  AtA.col(1).setZero();
+  AtA.row(1).setZero();
+  BOOST_CHECK_THROW(linalg_constrained_normalsolve(AtA, Atb, B),
+                    std::runtime_error);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
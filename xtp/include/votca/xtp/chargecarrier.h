@@ -21,12 +21,12 @@
 #define VOTCA_XTP_CHARGECARRIER_H
 
 // Local VOTCA includes
-#include "glink.h"
-#include "gnode.h"
+#include "eigen.h"
 
 namespace votca {
 namespace xtp {
 
+/// a carrier only knows the index of its node in the KMCGraph
 class Chargecarrier {
  public:
   Chargecarrier(Index id)
@@ -34,10 +34,9 @@ class Chargecarrier {
         lifetime(0.0),
         steps(0),
         dr_travelled_(Eigen::Vector3d::Zero()),
-        node(nullptr){};
-  bool hasNode() { return (node != nullptr); }
+        node(-1){};
+  bool hasNode() const { return (node >= 0); }
   void updateLifetime(double dt) { lifetime += dt; }
-  void updateOccupationtime(double dt) { node->UpdateOccupationTime(dt); }
   void updateSteps(Index t) { steps += t; }
   void resetCarrier() {
     lifetime = 0;
@@ -46,23 +45,14 @@ class Chargecarrier {
   }
   double getLifetime() const { return lifetime; }
   Index getSteps() const { return steps; }
-  Index getCurrentNodeId() const { return node->getId(); }
-  double getCurrentEnergy() const { return node->getSitenergy(); }
-  const Eigen::Vector3d& getCurrentPosition() const { return node->getPos(); }
-  double getCurrentEscapeRate() const { return node->getEscapeRate(); }
-  GNode& getCurrentNode() const { return *node; }
+  Index getCurrentNodeId() const { return node; }
 
-  void ReleaseNode() { node->setOccupation(false); }
+  // the occupation of the nodes is kept by the KMCReplica
+  void settoNote(Index newnode) { node = newnode; }
 
-  void settoNote(GNode* newnode) {
-    node = newnode;
-    node->setOccupation(true);
-  }
-
-  void jumpAccordingEvent(const GLink& event) {
-    ReleaseNode();
-    settoNote(event.getDestination());
-    dr_travelled_ += event.getDeltaR();
+  void jumpAccordingEvent(Index destination, const Eigen::Vector3d& dr) {
+    settoNote(destination);
+    dr_travelled_ += dr;
   }
 
   const Eigen::Vector3d& get_dRtravelled() const { return dr_travelled_; }
@@ -75,7 +65,7 @@ class Chargecarrier {
   double lifetime;
   Index steps;
   Eigen::Vector3d dr_travelled_;
-  GNode* node;
+  Index node;
 };
 
 }  // namespace xtp
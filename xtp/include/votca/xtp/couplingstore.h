@@ -0,0 +1,81 @@
+/*
+ *            Copyright 2009-2021 The VOTCA Development Team
+ *                       (http://www.votca.org)
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+#ifndef VOTCA_XTP_COUPLINGSTORE_H
+#define VOTCA_XTP_COUPLINGSTORE_H
+
+// Standard includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// VOTCA includes
+#include <votca/tools/types.h>
+
+namespace votca {
+namespace xtp {
+
+/**
+ * \brief binary table of the couplings computed by the jobs of a job file
+ *
+ * Every finished pair job appends one fixed size record per coupling to job
+ * file + ".couplings", so the couplings can be read back into the state file
+ * as one array instead of parsing the outputs in the job file. The job store
+ * decides which jobs are complete, only complete jobs without records are
+ * read from their output. The records are appended under an interprocess
+ * lock, threads of one process have to be serialised by the caller.
+ */
+class CouplingStore {
+ public:
+  struct Coupling {
+    std::int64_t segA;
+    std::int64_t segB;
+    /// QMStateType::statetype
+    std::int32_t type;
+    std::int32_t padding;
+    /// index of the state on each segment, for holes counted down from the
+    /// homo, for electrons up from the lumo
+    std::int64_t stateA;
+    std::int64_t stateB;
+    /// coupling in Hartree
+    double j;
+  };
+
+  static std::string StoreName(const std::string &job_file) {
+    return job_file + ".couplings";
+  }
+
+  explicit CouplingStore(const std::string &job_file)
+      : file_(StoreName(job_file)) {}
+
+  bool exists() const;
+  void Append(const std::vector<Coupling> &couplings) const;
+  /// all couplings in the order they were appended
+  std::vector<Coupling> ReadAll() const;
+  void Remove() const;
+
+ private:
+  std::string file_;
+};
+
+}  // namespace xtp
+}  // namespace votca
+
+#endif  // VOTCA_XTP_COUPLINGSTORE_H
@@ -118,6 +118,9 @@ class DFTEngine {
 
   // numerical integration Vxc
   std::string grid_name_;
+  // memory for basis function values on the grid kept between iterations
+  double ao_cache_mb_ = 0.0;
+  bool ao_cache_single_ = false;
 
   // AO Matrices
   AOOverlap dftAOoverlap_;
@@ -19,9 +19,14 @@
 #ifndef VOTCA_XTP_DIPOLEDIPOLEINTERACTION_H
 #define VOTCA_XTP_DIPOLEDIPOLEINTERACTION_H
 
+// Standard includes
+#include <memory>
+
 // Local VOTCA includes
+#include "dipoletree.h"
 #include "eeinteractor.h"
 #include "eigen.h"
+#include "tholeblockcache.h"
 
 namespace votca {
 namespace xtp {
@@ -66,6 +71,23 @@ class DipoleDipoleInteraction
         sites_.push_back(&site);
       }
     }
+    SetupTiles();
+  }
+
+  const std::vector<const PolarSite*>& Sites() const { return sites_; }
+
+  /// products are evaluated with a Barnes-Hut tree code instead of all pairs
+  void UseTree(double opening_angle) {
+    tree_ = std::make_shared<DipoleTree>(interactor_, sites_, opening_angle);
+  }
+
+  /// pairs in the cache are not recomputed, the cache has to belong to the
+  /// same sites
+  void UseBlockCache(const TholeBlockCache& cache) {
+    if (cache.NumberOfSites() != Index(sites_.size())) {
+      throw std::runtime_error("Thole block cache belongs to other sites");
+    }
+    cache_ = &cache;
   }
 
   class InnerIterator {
@@ -123,26 +145,50 @@ class DipoleDipoleInteraction
     assert(v.size() == size_ &&
            "input vector has the wrong size for multiply with operator");
     const Index segment_size = Index(sites_.size());
+    if (tree_) {
+      Eigen::VectorXd result = tree_->Multiply(v);
+      for (Index i = 0; i < segment_size; i++) {
+        result.segment<3>(3 * i) += sites_[i]->getPInv() * v.segment<3>(3 * i);
+      }
+      return result;
+    }
     Eigen::VectorXd result = Eigen::VectorXd::Zero(size_);
-#pragma omp parallel for schedule(dynamic) reduction(+ : result)
+    double skip2 = 0.0;
+    if (cache_ != nullptr) {
+      cache_->Multiply(v, result);
+      skip2 = cache_->CutoffSquared();
+    }
+#pragma omp parallel for
     for (Index i = 0; i < segment_size; i++) {
-      const PolarSite& site1 = *sites_[i];
-      result.segment<3>(3 * i) += site1.getPInv() * v.segment<3>(3 * i);
-      for (Index j = i + 1; j < segment_size; j++) {
-        const PolarSite& site2 = *sites_[j];
-        Eigen::Matrix3d block = interactor_.FillTholeInteraction(site1, site2);
-        result.segment<3>(3 * i) += block * v.segment<3>(3 * j);
-        result.segment<3>(3 * j) += block.transpose() * v.segment<3>(3 * i);
-      }
+      result.segment<3>(3 * i) += sites_[i]->getPInv() * v.segment<3>(3 * i);
+    }
+    if (cache_ == nullptr || !cache_->isComplete()) {
+      MultiplyTiles(v, result, skip2);
     }
 
     return result;
   }
 
  private:
+  void SetupTiles();
+  /// adds the Thole interaction of all pairs further apart than sqrt(skip2)
+  void MultiplyTiles(const Eigen::VectorXd& v, Eigen::VectorXd& result,
+                     double skip2) const;
+  void MultiplyTilePair(Index tile1, Index tile2, const Eigen::MatrixX3d& v,
+                        Eigen::MatrixX3d& result, double skip2) const;
+
   const eeInteractor& interactor_;
   std::vector<const PolarSite*> sites_;
   Index size_;
+  std::shared_ptr<DipoleTree> tree_ = nullptr;
+  const TholeBlockCache* cache_ = nullptr;
+
+  // sites tile_begin_[t]..tile_begin_[t+1]-1 form tile t
+  std::vector<Index> tile_begin_;
+  // positions (columns x,y,z) and expdamping*getSqrtInvEigenDamp() of the
+  // sites next to each other, so the pair loops vectorise
+  Eigen::MatrixX3d pos_;
+  Eigen::VectorXd damp_;
 };
 }  // namespace xtp
 }  // namespace votca
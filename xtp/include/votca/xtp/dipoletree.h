@@ -0,0 +1,100 @@
+/*
+ *            Copyright 2009-2021 The VOTCA Development Team
+ *                       (http://www.votca.org)
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+#ifndef VOTCA_XTP_DIPOLETREE_H
+#define VOTCA_XTP_DIPOLETREE_H
+
+// Standard includes
+#include <vector>
+
+// Local VOTCA includes
+#include "eeinteractor.h"
+#include "eigen.h"
+
+namespace votca {
+namespace xtp {
+
+/**
+ * \brief Barnes-Hut tree code for the dipole-dipole interaction of many
+ * polar sites
+ *
+ * The sites are sorted into an octree. The dipoles of a box seen from a site
+ * under an angle radius/distance smaller than the opening angle are replaced
+ * by their sum and first moment around the centre of the box, all other pairs
+ * are evaluated directly with Thole damping. Boxes are only expanded if the
+ * Thole damping has died off for all their sites, so the far field is the bare
+ * dipole tensor. A product costs O(N log N) instead of O(N^2) and the error
+ * falls with the square of the opening angle. Every site decides on its own
+ * which boxes are far away, so the product is symmetrised with its transpose
+ * to keep the operator usable for conjugate gradients.
+ */
+class DipoleTree {
+ public:
+  DipoleTree(const eeInteractor& interactor,
+             const std::vector<const PolarSite*>& sites, double opening_angle);
+
+  /// symmetrised field tensor times dipoles, without the diagonal blocks
+  Eigen::VectorXd Multiply(const Eigen::VectorXd& dipoles) const;
+
+  Index NumberOfNodes() const { return Index(nodes_.size()); }
+
+ private:
+  struct Node {
+    Eigen::Vector3d center = Eigen::Vector3d::Zero();
+    // largest distance of a site from the center
+    double radius = 0.0;
+    // smallest getSqrtInvEigenDamp() of the sites, the strongest damping
+    double damp = 0.0;
+    // sites order_[begin]..order_[end-1]
+    Index begin = 0;
+    Index end = 0;
+    std::vector<Index> children;
+  };
+
+  struct Moments {
+    // sum of the dipoles and sum of (r-center)*dipole^T
+    Eigen::Vector3d dipole = Eigen::Vector3d::Zero();
+    Eigen::Matrix3d first = Eigen::Matrix3d::Zero();
+  };
+
+  void Split(Index node);
+  std::vector<Moments> CalcMoments(const Eigen::VectorXd& dipoles) const;
+  bool isFarField(const Node& node, const PolarSite& site) const;
+  static Eigen::Vector3d FarField(const Eigen::Vector3d& dr,
+                                  const Moments& moments);
+  // adds the derivative of dipole^T FarField(dr, moments) by the moments
+  static void AddFarFieldAdjoint(const Eigen::Vector3d& dr,
+                                 const Eigen::Vector3d& dipole,
+                                 Moments& adjoint);
+  Eigen::VectorXd DistributeAdjoint(std::vector<Moments>& adjoint) const;
+
+  const eeInteractor& interactor_;
+  std::vector<const PolarSite*> sites_;
+  double opening_angle_;
+  // children are always created after their parent
+  std::vector<Node> nodes_;
+  std::vector<Index> order_;
+  static constexpr Index leaf_size_ = 16;
+};
+
+}  // namespace xtp
+}  // namespace votca
+
+#endif  // VOTCA_XTP_DIPOLETREE_H
@@ -44,6 +44,8 @@ class eeInteractor {
   Eigen::Matrix3d FillTholeInteraction(const PolarSite& site1,
                                        const PolarSite& site2) const;
 
+  double getExpDamping() const { return expdamping_; }
+
   Eigen::VectorXd Cholesky_IntraSegment(const PolarSegment& seg) const;
 
   template <class T, enum Estatic>
@@ -34,7 +34,6 @@ class GLink {
 
   GLink(double rate) : rate_(rate), decayevent_(true){};
 
-  double getValue() const { return rate_; }
   double getRate() const { return rate_; }
   GNode* getDestination() const {
     assert(!decayevent_ && "Decay event has no destination");
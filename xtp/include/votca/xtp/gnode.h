@@ -21,7 +21,6 @@
 
 // Local VOTCA includes
 #include "glink.h"
-#include "huffmantree.h"
 #include "qmpair.h"
 #include "segment.h"
 
@@ -36,16 +35,12 @@ class GNode {
         position_(seg.getPos()),
         injectable_(injectable){};
 
-  bool isOccupied() const { return occupied_; }
-  void setOccupation(bool occupied) { occupied_ = occupied; }
   bool isInjectable() const { return injectable_; }
   bool canDecay() const { return hasdecay_; }
   const Eigen::Vector3d& getPos() const { return position_; }
   Index getId() const { return id_; }
-  void UpdateOccupationTime(double deltat) { occupationtime_ += deltat; }
 
   const std::vector<GLink>& Events() const { return events_; }
-  double OccupationTime() const { return occupationtime_; }
 
   double getEscapeRate() const { return escape_rate_; }
   void InitEscapeRate();
@@ -54,25 +49,16 @@ class GNode {
                           double rate);
   double getSitenergy() const { return siteenergy_; }
 
-  GLink* findHoppingDestination(double p) const;
-  void MakeHuffTree();
   void AddEvent(GNode* seg2, const Eigen::Vector3d& dr, double rate);
 
  private:
   Index id_ = 0;
-  bool occupied_ = false;
-  double occupationtime_ = 0.0;
   double escape_rate_ = 0.0;
   bool hasdecay_ = false;
   double siteenergy_;
   Eigen::Vector3d position_;
   bool injectable_ = true;
   std::vector<GLink> events_;
-
-  huffmanTree<GLink> hTree;
-
-  void organizeProbabilities(Index id, double add);
-  void moveProbabilities(Index id);
 };
 
 }  // namespace xtp
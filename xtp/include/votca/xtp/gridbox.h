@@ -21,6 +21,9 @@
 #ifndef VOTCA_XTP_GRIDBOX_H
 #define VOTCA_XTP_GRIDBOX_H
 
+// Standard includes
+#include <array>
+
 // Local VOTCA includes
 #include "aoshell.h"
 #include "grid_containers.h"
@@ -35,8 +38,16 @@ struct GridboxRange {
 class GridBox {
 
  public:
+  // values and derivatives of the significant functions at all points of the
+  // box, one row per gridpoint
+  struct AOValuesOnGrid {
+    Eigen::MatrixXd values;
+    std::array<Eigen::MatrixXd, 3> derivatives;
+  };
+
   void FindSignificantShells(const AOBasis& basis);
   AOShell::AOValues CalcAOValues(const Eigen::Vector3d& point) const;
+  AOValuesOnGrid CalcAOValuesOnGrid() const;
 
   const std::vector<Eigen::Vector3d>& getGridPoints() const { return grid_pos; }
 
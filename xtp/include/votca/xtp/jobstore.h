@@ -0,0 +1,123 @@
+/*
+ *            Copyright 2009-2021 The VOTCA Development Team
+ *                       (http://www.votca.org)
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+#ifndef VOTCA_XTP_JOBSTORE_H
+#define VOTCA_XTP_JOBSTORE_H
+
+// Standard includes
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Local VOTCA includes
+#include "job.h"
+
+namespace votca {
+namespace xtp {
+
+/**
+ * \brief shared progress of the jobs of a job file
+ *
+ * The job file (xml) stays the import and export format. During a run the
+ * status, host and time of every job live in a fixed size record of a binary
+ * file next to it (job file + ".store"), output and error of finished jobs are
+ * appended to job file + ".results". Claiming and completing a job only
+ * touches its own record, so many processes can share the store under the
+ * interprocess lock of the ProgObserver without parsing the whole job file.
+ *
+ * The store remembers the modification time of the job file it belongs to. A
+ * job file written by someone else, e.g. a new "-j write", starts a new store.
+ */
+class JobStore {
+ public:
+  static std::string StoreName(const std::string &job_file) {
+    return job_file + ".store";
+  }
+  static std::string ResultsName(const std::string &job_file) {
+    return job_file + ".results";
+  }
+
+  /// opens the store of job_file, creates it from jobs if there is no store
+  /// for this job file yet. Returns true if the store was created.
+  bool Open(const std::string &job_file, const std::vector<Job> &jobs);
+
+  Index size() const { return njobs_; }
+
+  /// copies status, host and time of the stored record into job
+  void Read(Index index, Job &job);
+  /// stores status, host and time of job
+  void WriteStatus(Index index, const Job &job);
+  /// appends output and error of job to the results and stores its status
+  void WriteResult(Index index, const Job &job);
+
+  /// jobs in front of the cursor are neither available nor being claimed
+  Index Cursor();
+  void AdvanceCursor(Index cursor);
+
+  /// updates all jobs from the records and the results
+  void ReadAll(std::vector<Job> &jobs);
+  /// has to be called after the job file was written from the store
+  void JobFileWritten();
+
+  /// status of the jobs by id, read from the records without loading the job
+  /// file. Empty if there is no store for the current job file.
+  static std::map<Index, Job::JobStatus> ReadStatus(
+      const std::string &job_file);
+
+ private:
+  struct Header {
+    char magic[24];
+    std::int64_t njobs;
+    std::int64_t job_file_time;
+    std::int64_t cursor;
+  };
+
+  struct Record {
+    std::int64_t id;
+    std::int32_t status;
+    std::int32_t flags;
+    char host[128];
+    char time[32];
+  };
+
+  enum RecordFlags { has_host = 1, has_time = 2 };
+
+  bool IsCurrent(const std::vector<Job> &jobs) const;
+  void Create(const std::vector<Job> &jobs);
+  Header ReadHeader();
+  void WriteHeader(const Header &header);
+  static Record ToRecord(const Job &job);
+  static void FromRecord(const Record &record, Job &job);
+  static std::int64_t FileTime(const std::string &file);
+  std::streamoff RecordOffset(Index index) const;
+
+  std::string job_file_;
+  std::string store_file_;
+  std::string results_file_;
+  std::fstream store_;
+  Index njobs_ = 0;
+};
+
+}  // namespace xtp
+}  // namespace votca
+
+#endif  // VOTCA_XTP_JOBSTORE_H
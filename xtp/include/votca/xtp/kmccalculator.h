@@ -19,14 +19,18 @@
 #ifndef VOTCA_XTP_KMCCALCULATOR_H
 #define VOTCA_XTP_KMCCALCULATOR_H
 
+// Standard includes
+#include <functional>
+
 // VOTCA includes
 #include <votca/tools/globals.h>
-#include <votca/tools/random.h>
 #include <votca/tools/tokenizer.h>
 
 // Local VOTCA includes
 #include "chargecarrier.h"
 #include "gnode.h"
+#include "kmcgraph.h"
+#include "kmcreplica.h"
 #include "logger.h"
 #include "qmcalculator.h"
 #include "qmstate.h"
@@ -53,25 +57,39 @@ class KMCCalculator : public QMCalculator {
 
   void ParseCommonOptions(const tools::Property& options);
 
-  double Promotetime(double cumulated_rate);
-  void ResetForbiddenlist(std::vector<GNode*>& forbiddenid) const;
-  void AddtoForbiddenlist(GNode& node, std::vector<GNode*>& forbiddenid) const;
-  bool CheckForbidden(const GNode& node,
-                      const std::vector<GNode*>& forbiddenlist) const;
-  bool CheckSurrounded(const GNode& node,
-                       const std::vector<GNode*>& forbiddendests) const;
-  const GLink& ChooseHoppingDest(const GNode& node);
-  Chargecarrier* ChooseAffectedCarrier(double cumulated_rate);
-
-  void WriteOccupationtoFile(double simtime, std::string filename);
+  double Promotetime(KMCReplica& replica, double cumulated_rate);
+  void ResetForbiddenlist(std::vector<Index>& forbiddenid) const;
+  void AddtoForbiddenlist(Index node, std::vector<Index>& forbiddenid) const;
+  bool CheckForbidden(Index node,
+                      const std::vector<Index>& forbiddenlist) const;
+  bool CheckSurrounded(Index node,
+                       const std::vector<Index>& forbiddendests) const;
+  /// returns the index of the event in graph_
+  Index ChooseHoppingDest(KMCReplica& replica, Index node);
+  Chargecarrier* ChooseAffectedCarrier(KMCReplica& replica);
+
+  void WriteOccupationtoFile(const std::vector<KMCReplica>& replicas,
+                             std::string filename);
   void WriteRatestoFile(std::string filename, const QMNBList& nblist);
 
-  void RandomlyCreateCharges();
-  void RandomlyAssignCarriertoSite(Chargecarrier& Charge);
+  /// replica r is seeded with seed+r, so replica 0 repeats a single run
+  std::vector<KMCReplica> CreateReplicas() const;
+  /// runs the replicas on the available threads
+  void RunReplicas(std::vector<KMCReplica>& replicas,
+                   const std::function<void(KMCReplica&)>& run) const;
+
+  /// moves the nodes into graph_, has to be called once all events are added
+  void FreezeGraph();
+
+  void RandomlyCreateCharges(KMCReplica& replica);
+  void RandomlyAssignCarriertoSite(KMCReplica& replica,
+                                   Chargecarrier& Charge) const;
+  // only used to set up the graph
   std::vector<GNode> nodes_;
-  std::vector<Chargecarrier> carriers_;
+  // only read during the runs, shared by all replicas
+  KMCGraph graph_;
 
-  tools::Random RandomVariable_;
+  Index replicas_ = 1;
   std::string injection_name_;
   std::string injectionmethod_;
   Index seed_;
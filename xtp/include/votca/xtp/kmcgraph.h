@@ -0,0 +1,92 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#pragma once
+#ifndef VOTCA_XTP_KMCGRAPH_H
+#define VOTCA_XTP_KMCGRAPH_H
+
+// Standard includes
+#include <algorithm>
+#include <vector>
+
+// Local VOTCA includes
+#include "eigen.h"
+#include "gnode.h"
+
+namespace votca {
+namespace xtp {
+
+/**
+ * \brief Read-only KMC graph in compressed sparse row layout
+ *
+ * The GNodes are only used to set up the graph. Once all events are added,
+ * they are frozen into dense arrays: the events of node i are
+ * EventsBegin(i)..EventsEnd(i)-1 and store destination, rate and dr next to
+ * each other. Every node carries an alias table (Walker's method), so a
+ * hopping destination is drawn in O(1) with a single random number.
+ */
+class KMCGraph {
+ public:
+  KMCGraph() = default;
+  explicit KMCGraph(const std::vector<GNode>& nodes);
+
+  Index size() const { return Index(escaperate_.size()); }
+
+  const Eigen::Vector3d& Position(Index node) const { return position_[node]; }
+  double SiteEnergy(Index node) const { return siteenergy_[node]; }
+  double EscapeRate(Index node) const { return escaperate_[node]; }
+  bool isInjectable(Index node) const { return injectable_[node]; }
+
+  Index EventsBegin(Index node) const { return event_begin_[node]; }
+  Index EventsEnd(Index node) const { return event_begin_[node + 1]; }
+
+  /// destination node of the event, -1 for a decay event
+  Index Destination(Index event) const { return destination_[event]; }
+  bool isDecayEvent(Index event) const { return destination_[event] < 0; }
+  double Rate(Index event) const { return rate_[event]; }
+  const Eigen::Vector3d& DeltaR(Index event) const { return dr_[event]; }
+
+  /// draws an event of node with probability proportional to its rate,
+  /// u uniform in [0,1). The node must have events.
+  Index SampleEvent(Index node, double u) const {
+    Index begin = event_begin_[node];
+    Index nevents = event_begin_[node + 1] - begin;
+    double x = u * double(nevents);
+    // rounding may give x == nevents for u close to 1
+    Index k = std::min(Index(x), nevents - 1);
+    Index event = begin + k;
+    return (x - double(k) < alias_probability_[event]) ? event : alias_[event];
+  }
+
+ private:
+  void MakeAliasTable(Index node);
+
+  std::vector<Eigen::Vector3d> position_;
+  std::vector<double> siteenergy_;
+  std::vector<double> escaperate_;
+  std::vector<bool> injectable_;
+
+  std::vector<Index> event_begin_;
+  std::vector<Index> destination_;
+  std::vector<double> rate_;
+  std::vector<Eigen::Vector3d> dr_;
+  std::vector<double> alias_probability_;
+  std::vector<Index> alias_;
+};
+
+}  // namespace xtp
+}  // namespace votca
+
+#endif  // VOTCA_XTP_KMCGRAPH_H
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#pragma once
+#ifndef VOTCA_XTP_KMCREPLICA_H
+#define VOTCA_XTP_KMCREPLICA_H
+
+// Standard includes
+#include <vector>
+
+// VOTCA includes
+#include <votca/tools/random.h>
+
+// Local VOTCA includes
+#include "chargecarrier.h"
+#include "kmcgraph.h"
+#include "ratetree.h"
+
+namespace votca {
+namespace xtp {
+
+/**
+ * \brief Everything a single KMC trajectory changes
+ *
+ * The KMCGraph is only read during a run, so independent replicas with their
+ * own seeds can share it and run on different threads. The occupations are
+ * dense arrays over the nodes of the graph.
+ */
+class KMCReplica {
+ public:
+  KMCReplica(Index id, Index seed, const KMCGraph& graph)
+      : id_(id), graph_(&graph) {
+    random_.init(seed);
+    random_.setMaxInt(graph.size());
+    occupied_ = std::vector<bool>(graph.size(), false);
+    occupationtime_ = std::vector<double>(graph.size(), 0.0);
+  }
+
+  Index getId() const { return id_; }
+
+  tools::Random& Random() { return random_; }
+
+  std::vector<Chargecarrier>& Carriers() { return carriers_; }
+  const std::vector<Chargecarrier>& Carriers() const { return carriers_; }
+
+  bool isOccupied(Index node) const { return occupied_[node]; }
+
+  /// has to be called once all carriers are placed
+  void InitEscapeRates() {
+    std::vector<double> rates;
+    for (const Chargecarrier& carrier : carriers_) {
+      rates.push_back(graph_->EscapeRate(carrier.getCurrentNodeId()));
+    }
+    escaperates_.Initialize(rates);
+  }
+
+  double TotalEscapeRate() const { return escaperates_.TotalRate(); }
+
+  /// the carrier with cumulated escape rates reaching u*TotalEscapeRate()
+  Chargecarrier& FindCarrier(double u) {
+    return carriers_[escaperates_.Find(u)];
+  }
+
+  void PlaceCarrier(Chargecarrier& carrier, Index node) {
+    if (carrier.hasNode()) {
+      occupied_[carrier.getCurrentNodeId()] = false;
+    }
+    carrier.settoNote(node);
+    occupied_[node] = true;
+    UpdateEscapeRate(carrier);
+  }
+
+  /// moves the carrier along a hopping event of its node
+  void JumpCarrier(Chargecarrier& carrier, Index event) {
+    Index destination = graph_->Destination(event);
+    occupied_[carrier.getCurrentNodeId()] = false;
+    carrier.jumpAccordingEvent(destination, graph_->DeltaR(event));
+    occupied_[destination] = true;
+    UpdateEscapeRate(carrier);
+  }
+
+  void UpdateOccupationTime(double dt) {
+    for (const Chargecarrier& carrier : carriers_) {
+      occupationtime_[carrier.getCurrentNodeId()] += dt;
+    }
+  }
+  double OccupationTime(Index node) const { return occupationtime_[node]; }
+
+  /// moves the clock by one KMC step of length dt
+  void Advance(double dt) {
+    simtime_ += dt;
+    step_++;
+  }
+  double SimTime() const { return simtime_; }
+  unsigned long Steps() const { return step_; }
+
+ private:
+  void UpdateEscapeRate(const Chargecarrier& carrier) {
+    Index i = Index(&carrier - carriers_.data());
+    if (i < escaperates_.size()) {
+      Index node = carrier.getCurrentNodeId();
+      escaperates_.setRate(i, graph_->EscapeRate(node));
+    }
+  }
+
+  Index id_;
+  const KMCGraph* graph_;
+  tools::Random random_;
+  std::vector<Chargecarrier> carriers_;
+  // escape rates of carriers_
+  RateTree escaperates_;
+  std::vector<bool> occupied_;
+  std::vector<double> occupationtime_;
+  double simtime_ = 0.0;
+  unsigned long step_ = 0;
+};
+
+}  // namespace xtp
+}  // namespace votca
+
+#endif  // VOTCA_XTP_KMCREPLICA_H
@@ -67,6 +67,9 @@ class ParallelXJobCalc : public JobCalculator {
   bool Evaluate(const Topology &top) final;
   virtual void CustomizeLogger(QMThread &thread);
   virtual Result EvalJob(const Topology &top, Job &job, QMThread &thread) = 0;
+  /// estimated cost of a job, expensive jobs are started first. By default
+  /// the number of atoms in the segments of the job input.
+  virtual double JobCost(const Topology &top, const Job &job) const;
 
   void LockCout() { coutMutex_.Lock(); }
   void UnlockCout() { coutMutex_.Unlock(); }
@@ -110,6 +113,14 @@ class ParallelXJobCalc : public JobCalculator {
 
  private:
   void ParseCommonOptions(const tools::Property &options);
+
+  // operators without jobs leave their openmp threads to the busy ones
+  Index ClaimIdleCores();
+  void ReleaseCores(Index cores);
+
+  tools::Mutex coreMutex_;
+  Index idle_cores_ = 0;
+  Index busy_operators_ = 0;
 };
 
 }  // namespace xtp
@@ -21,11 +21,15 @@
 #ifndef VOTCA_XTP_POLARREGION_H
 #define VOTCA_XTP_POLARREGION_H
 
+// Standard includes
+#include <memory>
+
 // Local VOTCA includes
 #include "eeinteractor.h"
 #include "energy_terms.h"
 #include "hist.h"
 #include "mmregion.h"
+#include "tholeblockcache.h"
 
 /**
  * \brief defines a polar region and of interacting electrostatic and induction
@@ -88,6 +92,12 @@ class PolarRegion : public MMRegion<PolarSegment> {
   double deltaD_ = 1e-5;
   Index max_iter_ = 100;
   double exp_damp_ = 0.39;
+  bool use_tree_ = false;
+  double opening_angle_ = 0.1;
+  double thole_cache_mb_ = 0.0;
+  double thole_cache_cutoff_ = 40.0;
+  // the geometry does not change, so the cache is kept for all iterations
+  std::unique_ptr<TholeBlockCache> thole_cache_ = nullptr;
 };
 
 }  // namespace xtp
@@ -24,6 +24,7 @@
 #define VOTCA_XTP_PROGRESSOBSERVER_H
 
 // Standard includes
+#include <functional>
 #include <vector>
 
 // Third party includes
@@ -34,6 +35,9 @@
 #include <votca/tools/mutex.h>
 #include <votca/tools/property.h>
 
+// Local VOTCA includes
+#include "jobstore.h"
+
 namespace votca {
 namespace xtp {
 
@@ -48,10 +52,16 @@ class ProgObserver {
  public:
   void InitCmdLineOpts(const boost::program_options::variables_map &optsMap);
   void InitFromProgFile(std::string progFile, QMThread &thread);
+  /// jobs are claimed in the order of decreasing cost, jobs of equal cost in
+  /// the order of the job file. All processes sharing the job file have to
+  /// use the same costs, so they agree on the order.
+  void OrderJobs(const std::function<double(const Job &)> &cost);
   ProgObserver::Job *RequestNextJob(QMThread &thread);
   void ReportJobDone(Job &job, Result &res, QMThread &thread);
 
   void SyncWithProgFile(QMThread &thread);
+  /// writes the progress of all processes from the job store to the job file
+  void ExportToProgFile(QMThread &thread);
   void LockProgFile(QMThread &thread);
   void ReleaseProgFile(QMThread &thread);
 
@@ -63,12 +73,16 @@ class ProgObserver {
   std::string progFile_ = "";
   Index cacheSize_ = -1;
   JobContainer jobs_;
+  JobStore store_;
 
   std::vector<Job *> jobsToProc_;
   std::vector<Job *> jobsToSync_;
 
-  using iterator = typename JobContainer::iterator;
-  iterator metajit_;
+  // indices of jobs_ in the order they are claimed and their positions in it
+  std::vector<Index> order_;
+  std::vector<Index> rank_;
+  // position in order_ of the next job to look at
+  Index metapos_ = 0;
   using iterator_vec = typename std::vector<Job *>::iterator;
   iterator_vec nextjit_;
   tools::Mutex lockThread_;
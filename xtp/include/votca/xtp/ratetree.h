@@ -0,0 +1,119 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#pragma once
+#ifndef VOTCA_XTP_RATETREE_H
+#define VOTCA_XTP_RATETREE_H
+
+// Standard includes
+#include <stdexcept>
+#include <vector>
+
+// VOTCA includes
+#include <votca/tools/types.h>
+
+namespace votca {
+namespace xtp {
+
+/**
+ * \brief Fenwick tree over the rates of a set of events
+ *
+ * Changing one rate, the total rate and selecting an event with probability
+ * proportional to its rate are O(log N). The tree is updated with the
+ * difference to the old rate, so it is rebuilt from the stored rates every N
+ * updates to keep the rounding errors from accumulating.
+ */
+class RateTree {
+ public:
+  void Initialize(const std::vector<double>& rates) {
+    rates_ = rates;
+    updates_ = 0;
+    Rebuild();
+  }
+
+  Index size() const { return Index(rates_.size()); }
+
+  double getRate(Index i) const { return rates_[i]; }
+
+  void setRate(Index i, double rate) {
+    if (i < 0 || i >= size()) {
+      throw std::runtime_error("RateTree::setRate index out of range");
+    }
+    double delta = rate - rates_[i];
+    rates_[i] = rate;
+    if (++updates_ >= size()) {
+      updates_ = 0;
+      Rebuild();
+      return;
+    }
+    for (Index k = i + 1; k <= size(); k += (k & -k)) {
+      tree_[k] += delta;
+    }
+  }
+
+  double TotalRate() const { return PartialSum(size()); }
+
+  /// sum of the rates 0..n-1
+  double PartialSum(Index n) const {
+    double sum = 0.0;
+    for (Index k = n; k > 0; k -= (k & -k)) {
+      sum += tree_[k];
+    }
+    return sum;
+  }
+
+  /// first event i with rates 0..i summing up to at least u*TotalRate(),
+  /// u in (0,1]
+  Index Find(double u) const {
+    double target = u * TotalRate();
+    Index pos = 0;
+    for (Index step = highest_bit_; step > 0; step >>= 1) {
+      Index next = pos + step;
+      if (next <= size() && tree_[next] < target) {
+        pos = next;
+        target -= tree_[next];
+      }
+    }
+    // rounding can push the target past the last event
+    return (pos < size()) ? pos : size() - 1;
+  }
+
+ private:
+  void Rebuild() {
+    tree_.assign(rates_.size() + 1, 0.0);
+    for (Index k = 1; k <= size(); k++) {
+      tree_[k] += rates_[k - 1];
+      Index parent = k + (k & -k);
+      if (parent <= size()) {
+        tree_[parent] += tree_[k];
+      }
+    }
+    highest_bit_ = 1;
+    while (2 * highest_bit_ <= size()) {
+      highest_bit_ *= 2;
+    }
+  }
+
+  std::vector<double> rates_;
+  // tree_[k] holds the sum of the rates k-(k&-k)..k-1
+  std::vector<double> tree_;
+  Index highest_bit_ = 1;
+  Index updates_ = 0;
+};
+
+}  // namespace xtp
+}  // namespace votca
+
+#endif  // VOTCA_XTP_RATETREE_H
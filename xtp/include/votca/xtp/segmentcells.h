@@ -0,0 +1,69 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#pragma once
+#ifndef VOTCA_XTP_SEGMENTCELLS_H
+#define VOTCA_XTP_SEGMENTCELLS_H
+
+// Standard includes
+#include <array>
+#include <vector>
+
+// Local VOTCA includes
+#include "eigen.h"
+#include "segment.h"
+
+namespace votca {
+namespace xtp {
+
+/**
+ * \brief cell list over the segment centers in a periodic box
+ *
+ * The cells are at least range wide in every direction, so all segments
+ * closer than range to a segment sit in its own cell or in one of the 26
+ * cells around it. Fractional coordinates are used, so triclinic boxes work
+ * as well.
+ */
+class SegmentCells {
+ public:
+  SegmentCells(const Eigen::Matrix3d& box, const std::vector<Segment*>& segs,
+               double range);
+
+  /// cell of the segment with the given index in segs
+  Index CellOf(Index segment) const { return cell_of_segment_[segment]; }
+
+  /// indices in segs of the segments in the cell
+  const std::vector<Index>& Segments(Index cell) const { return cells_[cell]; }
+
+  /// the cell and its periodic neighbours, each one only once
+  std::vector<Index> Neighbours(Index cell) const;
+
+  Index NumberOfCells(Index direction) const { return ncells_[direction]; }
+
+ private:
+  Index Wrap(Index c, Index d) const { return (c + ncells_[d]) % ncells_[d]; }
+  Index CellIndex(const std::array<Index, 3>& c) const {
+    return (c[0] * ncells_[1] + c[1]) * ncells_[2] + c[2];
+  }
+
+  std::array<Index, 3> ncells_;
+  std::vector<std::vector<Index>> cells_;
+  std::vector<Index> cell_of_segment_;
+};
+
+}  // namespace xtp
+}  // namespace votca
+
+#endif  // VOTCA_XTP_SEGMENTCELLS_H
@@ -24,16 +24,39 @@
 // Standard includes
 #include <cstdio>
 #include <map>
+#include <memory>
+
+// Third party includes
+#include <boost/interprocess/sync/file_lock.hpp>
 
 // Local VOTCA includes
+#include "checkpoint.h"
 #include "topology.h"
 
 namespace votca {
 namespace xtp {
 
+/**
+ * \brief reads and writes the frames of the hdf5 state file
+ *
+ * Every call opens the state file on its own, unless a session is active.
+ * A session keeps the file and its lock open until EndSession and collects
+ * the updates of the frame index, which are written once at its end. A READ
+ * session only takes a sharable lock, so any number of processes can read
+ * the state file at the same time. MODIFY and CREATE sessions hold the
+ * exclusive lock for their whole lifetime, also while the frames are
+ * evaluated between ReadFrame and WriteFrame, so other processes wait until
+ * the session ends. Only a CREATE session creates the file, READ and MODIFY
+ * sessions throw if it does not exist.
+ */
 class StateSaver {
  public:
   StateSaver(std::string file) : hdf5file_(file){};
+  ~StateSaver();
+
+  void BeginSession(CheckpointAccessLevel access);
+  void EndSession();
+  bool hasSession() const { return session_ != nullptr; }
 
   void WriteFrame(const Topology &top);
 
@@ -43,8 +66,17 @@ class StateSaver {
 
  private:
   bool TopStepisinFrames(Index frameid) const;
+  std::vector<Index> ReadFrames(CheckpointFile &cpf) const;
+  void WriteFrames(CheckpointFile &cpf, const std::vector<Index> &frames) const;
 
   std::string hdf5file_;
+
+  std::unique_ptr<CheckpointFile> session_ = nullptr;
+  std::unique_ptr<boost::interprocess::file_lock> session_lock_ = nullptr;
+  CheckpointAccessLevel session_access_ = CheckpointAccessLevel::READ;
+  /// frame index of the session, written in EndSession if changed
+  std::vector<Index> session_frames_;
+  bool session_frames_changed_ = false;
 };
 }  // namespace xtp
 }  // namespace votca
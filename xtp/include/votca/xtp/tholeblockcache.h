@@ -0,0 +1,94 @@
+/*
+ *            Copyright 2009-2021 The VOTCA Development Team
+ *                       (http://www.votca.org)
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+#ifndef VOTCA_XTP_THOLEBLOCKCACHE_H
+#define VOTCA_XTP_THOLEBLOCKCACHE_H
+
+// Standard includes
+#include <cmath>
+#include <vector>
+
+// Local VOTCA includes
+#include "eeinteractor.h"
+#include "eigen.h"
+
+namespace votca {
+namespace xtp {
+
+/**
+ * \brief Thole interaction blocks of nearby polar sites kept in memory
+ *
+ * The geometry of a polar region does not change between the iterations of a
+ * QMMM run, so the 3x3 blocks of all pairs closer than a cutoff are computed
+ * once and stored row by row (block sparse, both triangles). If they do not
+ * fit into the memory budget, the cutoff is lowered until they do, so the
+ * closest pairs, whose blocks are the most expensive ones, are cached first.
+ * Pairs beyond the cutoff have to be evaluated on the fly by the caller.
+ */
+class TholeBlockCache {
+ public:
+  TholeBlockCache(const eeInteractor& interactor,
+                  const std::vector<const PolarSite*>& sites, double cutoff,
+                  double memory_mb);
+
+  Index NumberOfSites() const { return Index(row_begin_.size()) - 1; }
+  /// number of stored blocks, every pair is stored twice
+  Index NumberOfBlocks() const { return Index(column_.size()); }
+  double MemoryMB() const;
+  /// cutoff after applying the memory budget
+  double Cutoff() const { return std::sqrt(cutoff2_); }
+  double CutoffSquared() const { return cutoff2_; }
+  /// true if the blocks of all pairs are cached
+  bool isComplete() const { return complete_; }
+
+  bool isCached(const PolarSite& site1, const PolarSite& site2) const {
+    return (site1.getPos() - site2.getPos()).squaredNorm() < cutoff2_;
+  }
+
+  /// adds the cached blocks times v to result
+  void Multiply(const Eigen::VectorXd& v, Eigen::VectorXd& result) const;
+
+ private:
+  struct Candidate {
+    Index site1;
+    Index site2;
+    double distance2;
+  };
+
+  /// squared distance below which more than max_pairs of the pairs closer
+  /// than cutoff2 lie, read from a histogram, cutoff2 if there are fewer
+  double BudgetLimit(const std::vector<const PolarSite*>& sites, double cutoff2,
+                     Index max_pairs) const;
+  /// all pairs closer than cutoff2
+  std::vector<Candidate> CollectPairs(
+      const std::vector<const PolarSite*>& sites, double cutoff2) const;
+
+  double cutoff2_ = 0.0;
+  bool complete_ = false;
+  std::vector<Index> row_begin_;
+  std::vector<Index> column_;
+  // upper triangle xx,xy,xz,yy,yz,zz of every block
+  std::vector<double> blocks_;
+};
+
+}  // namespace xtp
+}  // namespace votca
+
+#endif  // VOTCA_XTP_THOLEBLOCKCACHE_H
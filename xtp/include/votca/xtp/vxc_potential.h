@@ -21,6 +21,9 @@
 #ifndef VOTCA_XTP_VXC_POTENTIAL_H
 #define VOTCA_XTP_VXC_POTENTIAL_H
 
+// Standard includes
+#include <vector>
+
 // Third party includes
 #include <xc.h>
 
@@ -43,17 +46,38 @@ class Vxc_Potential {
   void setXCfunctional(const std::string& functional);
   Mat_p_Energy IntegrateVXC(const Eigen::MatrixXd& density_matrix) const;
 
+  /// keeps the basis function values of as many boxes as fit into memory_mb
+  /// for all following calls of IntegrateVXC, optionally in single precision
+  void SetupAOCache(double memory_mb, bool single_precision);
+  double AOCacheMB() const;
+  Index CachedBoxes() const;
+
  private:
+  struct CachedAOValues {
+    bool cached = false;
+    GridBox::AOValuesOnGrid values;
+    Eigen::MatrixXf values_single;
+    std::array<Eigen::MatrixXf, 3> derivatives_single;
+  };
+
+  // from the cache if the box is cached, otherwise evaluated into buffer
+  const GridBox::AOValuesOnGrid& AOValues(
+      Index box, GridBox::AOValuesOnGrid& buffer) const;
+
+  // one entry per gridpoint
   struct XC_entry {
-    double f_xc = 0;  // E_xc[n] = int{n(r)*eps_xc[n(r)] d3r} = int{ f_xc(r) d3r
-    double df_drho = 0;    // v_xc_rho(r) = df/drho
-    double df_dsigma = 0;  // df/dsigma ( df/dgrad(rho) = df/dsigma *
-                           // dsigma/dgrad(rho) = df/dsigma * 2*grad(rho))
+    Eigen::VectorXd f_xc;       // E_xc[n] = int{n(r)*eps_xc[n(r)] d3r} = int{
+                                // f_xc(r) d3r
+    Eigen::VectorXd df_drho;    // v_xc_rho(r) = df/drho
+    Eigen::VectorXd df_dsigma;  // df/dsigma ( df/dgrad(rho) = df/dsigma *
+                                // dsigma/dgrad(rho) = df/dsigma * 2*grad(rho))
   };
 
-  XC_entry EvaluateXC(double rho, double sigma) const;
+  XC_entry EvaluateXC(const Eigen::VectorXd& rho,
+                      const Eigen::VectorXd& sigma) const;
 
   const Grid grid_;
+  std::vector<CachedAOValues> ao_cache_;
   int xfunc_id;
   bool setXC_ = false;
   bool use_separate_;
@@ -16,6 +16,7 @@
  */
 
 // Standard includes
+#include <chrono>
 #include <exception>
 #include <fstream>
 
@@ -135,7 +136,6 @@ void KMCLifetime::ReadLifetimeFile(std::string filename) {
   }
   for (auto& node : nodes_) {
     node.InitEscapeRate();
-    node.MakeHuffTree();
   }
   return;
 }
@@ -155,36 +155,99 @@ void KMCLifetime::WriteToTraj(std::fstream& traj, unsigned long insertioncount,
 
 void KMCLifetime::RunVSSM() {
 
-  std::chrono::time_point<std::chrono::system_clock> realtime_start =
-      std::chrono::system_clock::now();
+  realtime_start_ = std::chrono::system_clock::now();
   XTP_LOG(Log::error, log_)
       << "\nAlgorithm: VSSM for Multiple Charges with finite Lifetime\n"
          "number of charges: "
-      << numberofcarriers_ << "\nnumber of nodes: " << nodes_.size()
+      << numberofcarriers_ << "\nnumber of nodes: " << graph_.size()
       << std::flush;
 
-  if (numberofcarriers_ > Index(nodes_.size())) {
+  if (numberofcarriers_ > graph_.size()) {
     throw std::runtime_error(
         "ERROR in kmclifetime: specified number of charges is greater than the "
         "number of nodes. This conflicts with single occupation.");
   }
 
-  std::fstream traj;
-  std::fstream energyfile;
+  std::vector<KMCReplica> replicas = CreateReplicas();
+  if (replicas_ > 1) {
+    XTP_LOG(Log::error, log_)
+        << "Running " << replicas_ << " independent replicas, which share the "
+        << "insertions. Only the first one writes the trajectory and the "
+        << "energies." << std::flush;
+  }
 
+  time_t now = time(nullptr);
+  tm* localtm = localtime(&now);
   XTP_LOG(Log::error, log_)
-      << "Writing trajectory to " << trajectoryfile_ << "." << std::flush;
+      << "Run started at " << asctime(localtm) << std::flush;
 
-  traj.open(trajectoryfile_, std::fstream::out);
-  if (!traj.is_open()) {
-    std::string error_msg = "Unable to write to file " + trajectoryfile_;
-    throw std::runtime_error(error_msg);
+  std::vector<LifetimeStatistics> statistics(replicas.size());
+  RunReplicas(replicas, [&](KMCReplica& replica) {
+    unsigned long nreplicas = static_cast<unsigned long>(replicas_);
+    unsigned long r = static_cast<unsigned long>(replica.getId());
+    unsigned long insertions =
+        insertions_ / nreplicas + (r < insertions_ % nreplicas ? 1 : 0);
+    statistics[r] = RunReplica(replica, insertions);
+  });
+
+  // the replicas are independent, so their decays are pooled
+  double simtime = 0.0;
+  unsigned long step = 0;
+  LifetimeStatistics total;
+  for (Index r = 0; r < replicas_; r++) {
+    simtime += replicas[r].SimTime();
+    step += replicas[r].Steps();
+    total.lifetime += statistics[r].lifetime;
+    total.freepath += statistics[r].freepath;
+    total.difflength_squared += statistics[r].difflength_squared;
+    total.insertions += statistics[r].insertions;
   }
 
-  traj << "#Simtime [s]\t Insertion\t Carrier ID\t Lifetime[s]\tSteps\t Last "
-          "Segment\t x_travelled[nm]\t y_travelled[nm]\t z_travelled[nm]\n";
+  XTP_LOG(Log::error, log_)
+      << "\nTotal runtime:\t\t\t\t\t" << simtime
+      << " s\n"
+         "Total KMC steps:\t\t\t\t"
+      << step << "\nAverage lifetime:\t\t\t\t"
+      << total.lifetime / double(total.insertions) << " s\n"
+      << "Mean freepath\t l=<|r_x-r_o|> :\t\t"
+      << (total.freepath * tools::conv::bohr2nm / double(total.insertions))
+      << " nm\n"
+      << "Average diffusionlength\t d=sqrt(<(r_x-r_o)^2>)\t"
+      << std::sqrt(total.difflength_squared.norm() / double(total.insertions)) *
+             tools::conv::bohr2nm
+      << " nm\n"
+      << std::flush;
+
+  WriteOccupationtoFile(replicas, occfile_);
+  return;
+}
+
+KMCLifetime::LifetimeStatistics KMCLifetime::RunReplica(
+    KMCReplica& replica, unsigned long insertions) {
+
+  // the replicas only differ by their seed, the first one reports
+  bool first = (replica.getId() == 0);
+  bool do_carrierenergy = (do_carrierenergy_ && first);
+
+  std::fstream traj;
+  std::fstream energyfile;
+
+  if (first) {
+    XTP_LOG(Log::error, log_)
+        << "Writing trajectory to " << trajectoryfile_ << "." << std::flush;
+
+    traj.open(trajectoryfile_, std::fstream::out);
+    if (!traj.is_open()) {
+      std::string error_msg = "Unable to write to file " + trajectoryfile_;
+      throw std::runtime_error(error_msg);
+    }
+
+    traj << "#Simtime [s]\t Insertion\t Carrier ID\t Lifetime[s]\tSteps\t "
+            "Last Segment\t x_travelled[nm]\t y_travelled[nm]\t "
+            "z_travelled[nm]\n";
+  }
 
-  if (do_carrierenergy_) {
+  if (do_carrierenergy) {
 
     XTP_LOG(Log::error, log_)
         << "Tracking the energy of one charge carrier and exponential average "
@@ -201,47 +264,39 @@ void KMCLifetime::RunVSSM() {
   }
 
   // Injection
-  XTP_LOG(Log::error, log_)
-      << "\ninjection method: " << injectionmethod_ << std::flush;
+  if (first) {
+    XTP_LOG(Log::error, log_)
+        << "\ninjection method: " << injectionmethod_ << std::flush;
+  }
 
-  RandomlyCreateCharges();
+  RandomlyCreateCharges(replica);
+  std::vector<Chargecarrier>& carriers = replica.Carriers();
 
   unsigned long insertioncount = 0;
-  unsigned long step = 0;
-  double simtime = 0.0;
 
-  std::vector<GNode*> forbiddennodes;
-  std::vector<GNode*> forbiddendests;
+  std::vector<Index> forbiddennodes;
+  std::vector<Index> forbiddendests;
 
-  time_t now = time(nullptr);
-  tm* localtm = localtime(&now);
-  XTP_LOG(Log::error, log_)
-      << "Run started at " << asctime(localtm) << std::flush;
-
-  double avlifetime = 0.0;
-  double meanfreepath = 0.0;
-  Eigen::Vector3d difflength_squared = Eigen::Vector3d::Zero();
+  LifetimeStatistics statistics;
 
-  double avgenergy = carriers_[0].getCurrentEnergy();
-  Index carrieridold = carriers_[0].getId();
+  double avgenergy = graph_.SiteEnergy(carriers[0].getCurrentNodeId());
+  Index carrieridold = carriers[0].getId();
 
-  while (insertioncount < insertions_) {
+  while (insertioncount < insertions) {
     std::chrono::duration<double> elapsed_time =
-        std::chrono::system_clock::now() - realtime_start;
+        std::chrono::system_clock::now() - realtime_start_;
     if (elapsed_time.count() > (maxrealtime_ * 60. * 60.)) {
-      XTP_LOG(Log::error, log_)
-          << "\nReal time limit of " << maxrealtime_ << " hours ("
-          << Index(maxrealtime_ * 60 * 60 + 0.5)
-          << " seconds) has been reached. Stopping here.\n"
-          << std::flush;
+      if (first) {
+        XTP_LOG(Log::error, log_)
+            << "\nReal time limit of " << maxrealtime_ << " hours ("
+            << Index(maxrealtime_ * 60 * 60 + 0.5)
+            << " seconds) has been reached. Stopping here.\n"
+            << std::flush;
+      }
       break;
     }
 
-    double cumulated_rate = 0;
-
-    for (const auto& carrier : carriers_) {
-      cumulated_rate += carrier.getCurrentEscapeRate();
-    }
+    double cumulated_rate = replica.TotalEscapeRate();
     if (cumulated_rate == 0) {  // this should not happen: no possible jumps
                                 // defined for a node
       throw std::runtime_error(
@@ -249,93 +304,96 @@ void KMCLifetime::RunVSSM() {
           "escape rates for the current setting are 0.");
     }
     // go forward in time
-    double dt = Promotetime(cumulated_rate);
+    double dt = Promotetime(replica, cumulated_rate);
 
-    if (do_carrierenergy_) {
+    if (do_carrierenergy) {
       bool print = false;
-      if (carriers_[0].getId() > carrieridold) {
-        avgenergy = carriers_[0].getCurrentEnergy();
+      if (carriers[0].getId() > carrieridold) {
+        avgenergy = graph_.SiteEnergy(carriers[0].getCurrentNodeId());
         print = true;
-        carrieridold = carriers_[0].getId();
-      } else if (step % outputsteps_ == 0) {
-        avgenergy =
-            alpha_ * carriers_[0].getCurrentEnergy() + (1 - alpha_) * avgenergy;
+        carrieridold = carriers[0].getId();
+      } else if (replica.Steps() % outputsteps_ == 0) {
+        avgenergy = alpha_ * graph_.SiteEnergy(carriers[0].getCurrentNodeId()) +
+                    (1 - alpha_) * avgenergy;
         print = true;
       }
       if (print) {
-        energyfile << simtime << "\t" << step << "\t" << carriers_[0].getId()
-                   << "\t" << avgenergy * tools::conv::hrt2ev << std::endl;
+        energyfile << replica.SimTime() << "\t" << replica.Steps() << "\t"
+                   << carriers[0].getId() << "\t"
+                   << avgenergy * tools::conv::hrt2ev << std::endl;
       }
     }
 
-    simtime += dt;
-    step++;
-    for (auto& carrier : carriers_) {
+    replica.Advance(dt);
+    for (auto& carrier : carriers) {
       carrier.updateLifetime(dt);
       carrier.updateSteps(1);
-      carrier.updateOccupationtime(dt);
     }
+    replica.UpdateOccupationTime(dt);
 
     ResetForbiddenlist(forbiddennodes);
     bool secondlevel = true;
     while (secondlevel) {
 
       // determine which carrier will escape
-      GNode* newnode = nullptr;
-      Chargecarrier* affectedcarrier = ChooseAffectedCarrier(cumulated_rate);
+      Index newnode = -1;
+      Chargecarrier* affectedcarrier = ChooseAffectedCarrier(replica);
 
-      if (CheckForbidden(affectedcarrier->getCurrentNode(), forbiddennodes)) {
+      if (CheckForbidden(affectedcarrier->getCurrentNodeId(), forbiddennodes)) {
         continue;
       }
 
       // determine where it will jump to
       ResetForbiddenlist(forbiddendests);
-      boost::progress_display progress(insertions_);
+      boost::progress_display progress(insertions);
 
       while (true) {
         // LEVEL 2
 
-        newnode = nullptr;
-        const GLink& event =
-            ChooseHoppingDest(affectedcarrier->getCurrentNode());
+        newnode = -1;
+        Index event =
+            ChooseHoppingDest(replica, affectedcarrier->getCurrentNodeId());
 
-        if (event.isDecayEvent()) {
+        if (graph_.isDecayEvent(event)) {
           const Eigen::Vector3d& dr_travelled =
               affectedcarrier->get_dRtravelled();
-          avlifetime += affectedcarrier->getLifetime();
-          meanfreepath += dr_travelled.norm();
-          difflength_squared += dr_travelled.cwiseAbs2();
-          WriteToTraj(traj, insertioncount, simtime, *affectedcarrier);
+          statistics.lifetime += affectedcarrier->getLifetime();
+          statistics.freepath += dr_travelled.norm();
+          statistics.difflength_squared += dr_travelled.cwiseAbs2();
+          if (first) {
+            WriteToTraj(traj, insertioncount, replica.SimTime(),
+                        *affectedcarrier);
+          }
           ++progress;
-          RandomlyAssignCarriertoSite(*affectedcarrier);
+          RandomlyAssignCarriertoSite(replica, *affectedcarrier);
           affectedcarrier->resetCarrier();
           insertioncount++;
           affectedcarrier->setId(numberofcarriers_ - 1 + insertioncount);
           secondlevel = false;
           break;
         } else {
-          newnode = event.getDestination();
+          newnode = graph_.Destination(event);
         }
 
         // check after the event if this was allowed
-        if (CheckForbidden(*newnode, forbiddendests)) {
+        if (CheckForbidden(newnode, forbiddendests)) {
           continue;
         }
 
         // if the new segment is unoccupied: jump; if not: add to forbidden list
         // and choose new hopping destination
-        if (newnode->isOccupied()) {
-          if (CheckSurrounded(affectedcarrier->getCurrentNode(),
+        if (replica.isOccupied(newnode)) {
+          if (CheckSurrounded(affectedcarrier->getCurrentNodeId(),
                               forbiddendests)) {
-            AddtoForbiddenlist(affectedcarrier->getCurrentNode(),
+            AddtoForbiddenlist(affectedcarrier->getCurrentNodeId(),
                                forbiddennodes);
             break;  // select new escape node (ends level 2 but without setting
                     // level1step to 1)
           }
-          AddtoForbiddenlist(*newnode, forbiddendests);
+          AddtoForbiddenlist(newnode, forbiddendests);
           continue;  // select new destination
         } else {
-          affectedcarrier->jumpAccordingEvent(event);
+          replica.JumpCarrier(*affectedcarrier, event);
           secondlevel = false;
 
           break;  // this ends LEVEL 2 , so that the time is updated and the
@@ -347,28 +405,15 @@ void KMCLifetime::RunVSSM() {
       // END LEVEL 1
     }
   }
+  statistics.insertions = insertioncount;
 
-  XTP_LOG(Log::error, log_)
-      << "\nTotal runtime:\t\t\t\t\t" << simtime
-      << " s\n"
-         "Total KMC steps:\t\t\t\t"
-      << step << "\nAverage lifetime:\t\t\t\t"
-      << avlifetime / double(insertioncount) << " s\n"
-      << "Mean freepath\t l=<|r_x-r_o|> :\t\t"
-      << (meanfreepath * tools::conv::bohr2nm / double(insertioncount))
-      << " nm\n"
-      << "Average diffusionlength\t d=sqrt(<(r_x-r_o)^2>)\t"
-      << std::sqrt(difflength_squared.norm() / double(insertioncount)) *
-             tools::conv::bohr2nm
-      << " nm\n"
-      << std::flush;
-
-  WriteOccupationtoFile(simtime, occfile_);
-  traj.close();
-  if (do_carrierenergy_) {
+  if (first) {
+    traj.close();
+  }
+  if (do_carrierenergy) {
     energyfile.close();
   }
-  return;
+  return statistics;
 }
 
 bool KMCLifetime::Evaluate(Topology& top) {
@@ -377,16 +422,13 @@ bool KMCLifetime::Evaluate(Topology& top) {
                                "\n-----------------------------------\n"
                             << std::flush;
 
-  XTP_LOG(Log::info, log_) << "\nInitialising random number generator"
-                           << std::flush;
-
-  RandomVariable_.init(seed_);
   LoadGraph(top);
   ReadLifetimeFile(lifetimefile_);
 
   if (!probfile_.empty()) {
     WriteDecayProbability(probfile_);
   }
+  FreezeGraph();
   RunVSSM();
 
   time_t now = time(nullptr);
@@ -19,6 +19,9 @@
 #ifndef VOTCA_XTP_KMCLIFETIME_H
 #define VOTCA_XTP_KMCLIFETIME_H
 
+// Standard includes
+#include <chrono>
+
 // Local VOTCA includes
 #include "votca/xtp/kmccalculator.h"
 
@@ -39,7 +42,15 @@ class KMCLifetime final : public KMCCalculator {
  private:
   void WriteDecayProbability(std::string filename);
 
+  struct LifetimeStatistics {
+    double lifetime = 0.0;
+    double freepath = 0.0;
+    Eigen::Vector3d difflength_squared = Eigen::Vector3d::Zero();
+    unsigned long insertions = 0;
+  };
+
   void RunVSSM();
+  LifetimeStatistics RunReplica(KMCReplica& replica, unsigned long insertions);
   void WriteToTraj(std::fstream& traj, unsigned long insertioncount,
                    double simtime, const Chargecarrier& affectedcarrier) const;
 
@@ -51,6 +62,7 @@ class KMCLifetime final : public KMCCalculator {
   unsigned long outputsteps_;
   unsigned long insertions_;
   std::string lifetimefile_;
+  std::chrono::time_point<std::chrono::system_clock> realtime_start_;
 };
 
 }  // namespace xtp
@@ -58,26 +58,41 @@ void KMCMultiple::ParseSpecificOptions(const tools::Property& options) {
   log_.setCommonPreface("\n ...");
 }
 
-void KMCMultiple::PrintDiffandMu(const Eigen::Matrix3d& avgdiffusiontensor,
-                                 double simtime, unsigned long step) {
+Eigen::Matrix3d KMCMultiple::DiffusionTensor(
+    const Eigen::Matrix3d& avgdiffusiontensor,
+    const KMCReplica& replica) const {
+  unsigned long diffusionsteps = replica.Steps() / diffusionresolution_;
+  return avgdiffusiontensor / (double(diffusionsteps) * 2.0 *
+                               replica.SimTime() * double(numberofcarriers_));
+}
+
+std::vector<Eigen::Vector3d> KMCMultiple::Velocities(
+    const KMCReplica& replica) const {
+  std::vector<Eigen::Vector3d> velocities;
+  for (const auto& carrier : replica.Carriers()) {
+    velocities.push_back(carrier.get_dRtravelled() / replica.SimTime());
+  }
+  return velocities;
+}
+
+void KMCMultiple::PrintDiffandMu(const Eigen::Matrix3d& diffusiontensor,
+                                 const std::vector<Eigen::Vector3d>& velocities,
+                                 unsigned long step) {
   double absolute_field = field_.norm();
 
   if (absolute_field == 0) {
-    unsigned long diffusionsteps = step / diffusionresolution_;
-    Eigen::Matrix3d result =
-        avgdiffusiontensor /
-        (double(diffusionsteps) * 2.0 * simtime * double(numberofcarriers_));
     XTP_LOG(Log::error, log_)
         << "\nStep: " << step
         << " Diffusion tensor averaged over all carriers (nm^2/s):\n"
-        << result * tools::conv::bohr2nm * tools::conv::bohr2nm << std::flush;
+        << diffusiontensor * tools::conv::bohr2nm * tools::conv::bohr2nm
+        << std::flush;
   } else {
     double average_mobility = 0;
     double bohr2Hrts_to_nm2Vs =
         tools::conv::bohr2nm * tools::conv::bohr2nm / tools::conv::hrt2ev;
     XTP_LOG(Log::error, log_) << "\nMobilities (nm^2/Vs): " << std::flush;
-    for (Index i = 0; i < numberofcarriers_; i++) {
-      Eigen::Vector3d velocity = carriers_[i].get_dRtravelled() / simtime;
+    for (Index i = 0; i < Index(velocities.size()); i++) {
+      const Eigen::Vector3d& velocity = velocities[i];
       double mobility =
           velocity.dot(field_) / (absolute_field * absolute_field);
       XTP_LOG(Log::error, log_)
@@ -86,7 +101,7 @@ void KMCMultiple::PrintDiffandMu(const Eigen::Matrix3d& avgdiffusiontensor,
       average_mobility +=
           velocity.dot(field_) / (absolute_field * absolute_field);
     }
-    average_mobility /= double(numberofcarriers_);
+    average_mobility /= double(velocities.size());
     XTP_LOG(Log::error, log_)
         << std::scientific
         << "  Overall average mobility in field direction <mu>="
@@ -96,11 +111,12 @@ void KMCMultiple::PrintDiffandMu(const Eigen::Matrix3d& avgdiffusiontensor,
 
 void KMCMultiple::WriteToTrajectory(std::fstream& traj,
                                     std::vector<Eigen::Vector3d>& startposition,
-                                    double simtime, unsigned long step) const {
-  traj << simtime << "\t";
-  traj << step << "\t";
+                                    const KMCReplica& replica) const {
+  traj << replica.SimTime() << "\t";
+  traj << replica.Steps() << "\t";
   for (Index i = 0; i < numberofcarriers_; i++) {
-    Eigen::Vector3d pos = startposition[i] + carriers_[i].get_dRtravelled();
+    Eigen::Vector3d pos =
+        startposition[i] + replica.Carriers()[i].get_dRtravelled();
     traj << pos.x() * tools::conv::bohr2nm << "\t";
     traj << pos.y() * tools::conv::bohr2nm << "\t";
     traj << pos.z() * tools::conv::bohr2nm;
@@ -112,8 +128,8 @@ void KMCMultiple::WriteToTrajectory(std::fstream& traj,
   }
 }
 
-void KMCMultiple::WriteToEnergyFile(std::fstream& tfile, double simtime,
-                                    unsigned long step) const {
+void KMCMultiple::WriteToEnergyFile(std::fstream& tfile,
+                                    const KMCReplica& replica) const {
   double absolute_field = field_.norm();
   double currentenergy = 0;
   double currentmobility = 0;
@@ -121,20 +137,20 @@ void KMCMultiple::WriteToEnergyFile(std::fstream& tfile, double simtime,
   double dr_travelled_field = 0.0;
   Eigen::Vector3d avgvelocity_current = Eigen::Vector3d::Zero();
   if (absolute_field != 0) {
-    for (const auto& carrier : carriers_) {
+    for (const auto& carrier : replica.Carriers()) {
       dr_travelled_current += carrier.get_dRtravelled();
-      currentenergy += carrier.getCurrentEnergy();
+      currentenergy += graph_.SiteEnergy(carrier.getCurrentNodeId());
     }
     dr_travelled_current /= double(numberofcarriers_);
     currentenergy /= double(numberofcarriers_);
-    avgvelocity_current = dr_travelled_current / simtime;
+    avgvelocity_current = dr_travelled_current / replica.SimTime();
     currentmobility =
         avgvelocity_current.dot(field_) / (absolute_field * absolute_field);
     dr_travelled_field = dr_travelled_current.dot(field_) / absolute_field;
   }
   double bohr2Hrts_to_nm2Vs =
       tools::conv::bohr2nm * tools::conv::bohr2nm / tools::conv::hrt2ev;
-  tfile << simtime << "\t" << step << "\t"
+  tfile << replica.SimTime() << "\t" << replica.Steps() << "\t"
         << currentenergy * tools::conv::hrt2ev << "\t"
         << currentmobility * bohr2Hrts_to_nm2Vs << "\t"
         << dr_travelled_field * tools::conv::bohr2nm << "\t"
@@ -142,15 +158,9 @@ void KMCMultiple::WriteToEnergyFile(std::fstream& tfile, double simtime,
         << std::endl;
 }
 
-void KMCMultiple::PrintDiagDandMu(const Eigen::Matrix3d& avgdiffusiontensor,
-                                  double simtime, unsigned long step) {
-  unsigned long diffusionsteps = step / diffusionresolution_;
-  Eigen::Matrix3d result =
-      avgdiffusiontensor /
-      (double(diffusionsteps) * 2.0 * simtime * double(numberofcarriers_));
-
+void KMCMultiple::PrintDiagDandMu(const Eigen::Matrix3d& diffusiontensor) {
   Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> es;
-  es.computeDirect(result);
+  es.computeDirect(diffusiontensor);
   double bohr2_nm2 = tools::conv::bohr2nm * tools::conv::bohr2nm;
   XTP_LOG(Log::error, log_) << "\nEigenvalues:\n " << std::flush;
   for (Index i = 0; i < 3; i++) {
@@ -177,19 +187,24 @@ void KMCMultiple::PrintDiagDandMu(const Eigen::Matrix3d& avgdiffusiontensor,
   }
 }
 
-void KMCMultiple::PrintChargeVelocity(double simtime) {
-  Eigen::Vector3d avg_dr_travelled = Eigen::Vector3d::Zero();
-  for (Index i = 0; i < numberofcarriers_; i++) {
-    XTP_LOG(Log::error, log_)
-        << std::scientific << "    carrier " << i + 1 << ": "
-        << carriers_[i].get_dRtravelled().transpose() / simtime *
-               tools::conv::bohr2nm
-        << std::flush;
-    avg_dr_travelled += carriers_[i].get_dRtravelled();
+void KMCMultiple::PrintChargeVelocity(const std::vector<KMCReplica>& replicas) {
+  Eigen::Vector3d avgvelocity = Eigen::Vector3d::Zero();
+  Index carrier_number = 0;
+  for (const KMCReplica& replica : replicas) {
+    Eigen::Vector3d avg_dr_travelled = Eigen::Vector3d::Zero();
+    for (const auto& carrier : replica.Carriers()) {
+      XTP_LOG(Log::error, log_)
+          << std::scientific << "    carrier " << ++carrier_number << ": "
+          << carrier.get_dRtravelled().transpose() / replica.SimTime() *
+                 tools::conv::bohr2nm
+          << std::flush;
+      avg_dr_travelled += carrier.get_dRtravelled();
+    }
+    avg_dr_travelled /= double(numberofcarriers_);
+    avgvelocity += avg_dr_travelled / replica.SimTime();
   }
-  avg_dr_travelled /= double(numberofcarriers_);
+  avgvelocity /= double(replicas.size());
 
-  Eigen::Vector3d avgvelocity = avg_dr_travelled / simtime;
   XTP_LOG(Log::error, log_)
       << std::scientific << "  Overall average velocity (nm/s): "
       << avgvelocity.transpose() * tools::conv::bohr2nm << std::flush;
@@ -197,32 +212,30 @@ void KMCMultiple::PrintChargeVelocity(double simtime) {
 
 void KMCMultiple::RunVSSM() {
 
-  std::chrono::time_point<std::chrono::system_clock> realtime_start =
-      std::chrono::system_clock::now();
+  realtime_start_ = std::chrono::system_clock::now();
   XTP_LOG(Log::error, log_)
       << "\nAlgorithm: VSSM for Multiple Charges" << std::flush;
   XTP_LOG(Log::error, log_)
       << "number of carriers: " << numberofcarriers_ << std::flush;
   XTP_LOG(Log::error, log_)
-      << "number of nodes: " << nodes_.size() << std::flush;
+      << "number of nodes: " << graph_.size() << std::flush;
 
   bool checkifoutput = (outputtime_ != 0);
-  double nexttrajoutput = 0;
-  unsigned long maxsteps = boost::numeric_cast<unsigned long>(runtime_);
-  unsigned long outputstep = boost::numeric_cast<unsigned long>(outputtime_);
-  bool stopontime = false;
+  maxsteps_ = boost::numeric_cast<unsigned long>(runtime_);
+  outputstep_ = boost::numeric_cast<unsigned long>(outputtime_);
+  stopontime_ = false;
 
   if (runtime_ > 100) {
     XTP_LOG(Log::error, log_)
-        << "stop condition: " << maxsteps << " steps." << std::flush;
+        << "stop condition: " << maxsteps_ << " steps." << std::flush;
 
     if (checkifoutput) {
       XTP_LOG(Log::error, log_) << "output frequency: ";
       XTP_LOG(Log::error, log_)
-          << "every " << outputstep << " steps." << std::flush;
+          << "every " << outputstep_ << " steps." << std::flush;
     }
   } else {
-    stopontime = true;
+    stopontime_ = true;
     XTP_LOG(Log::error, log_)
         << "stop condition: " << runtime_ << " seconds runtime." << std::flush;
 
@@ -238,20 +251,84 @@ void KMCMultiple::RunVSSM() {
          "outputtime.)"
       << std::flush;
 
-  if (!stopontime && outputtime_ != 0 && floor(outputtime_) != outputtime_) {
+  if (!stopontime_ && outputtime_ != 0 && floor(outputtime_) != outputtime_) {
     throw std::runtime_error(
         "ERROR in kmcmultiple: runtime was specified in steps (>100) and "
         "outputtime in seconds (not an integer). Please use the same units for "
         "both input parameters.");
   }
 
-  if (numberofcarriers_ > Index(nodes_.size())) {
+  if (numberofcarriers_ > graph_.size()) {
     throw std::runtime_error(
         "ERROR in kmcmultiple: specified number of carriers is greater than "
         "the "
         "number of nodes. This conflicts with single occupation.");
   }
 
+  std::vector<KMCReplica> replicas = CreateReplicas();
+  if (replicas_ > 1) {
+    XTP_LOG(Log::error, log_)
+        << "Running " << replicas_ << " independent replicas, only the first "
+        << "one writes trajectory and intermediate output." << std::flush;
+  }
+  std::vector<Eigen::Matrix3d> avgdiffusiontensors(replicas.size());
+  RunReplicas(replicas, [&](KMCReplica& replica) {
+    avgdiffusiontensors[replica.getId()] = RunReplica(replica);
+  });
+
+  WriteOccupationtoFile(replicas, occfile_);
+
+  unsigned long steps = 0;
+  for (const KMCReplica& replica : replicas) {
+    std::string name =
+        (replicas_ > 1) ? " of replica " + std::to_string(replica.getId()) : "";
+    XTP_LOG(Log::error, log_)
+        << "\nfinished KMC simulation" << name << " after " << replica.Steps()
+        << " steps.\n"
+           "simulated time "
+        << replica.SimTime() << " seconds.\n"
+        << std::flush;
+    steps += replica.Steps();
+  }
+
+  PrintChargeVelocity(replicas);
+
+  XTP_LOG(Log::error, log_) << "\nDistances travelled (nm): " << std::flush;
+  Index carrier_number = 0;
+  for (const KMCReplica& replica : replicas) {
+    for (const auto& carrier : replica.Carriers()) {
+      XTP_LOG(Log::error, log_)
+          << std::scientific << "    carrier " << ++carrier_number << ": "
+          << carrier.get_dRtravelled().transpose() * tools::conv::bohr2nm
+          << std::flush;
+    }
+  }
+
+  // the replicas are equivalent, so their results are averaged
+  Eigen::Matrix3d diffusiontensor = Eigen::Matrix3d::Zero();
+  std::vector<Eigen::Vector3d> velocities;
+  for (const KMCReplica& replica : replicas) {
+    diffusiontensor +=
+        DiffusionTensor(avgdiffusiontensors[replica.getId()], replica);
+    std::vector<Eigen::Vector3d> replica_velocities = Velocities(replica);
+    velocities.insert(velocities.end(), replica_velocities.begin(),
+                      replica_velocities.end());
+  }
+  diffusiontensor /= double(replicas.size());
+
+  PrintDiffandMu(diffusiontensor, velocities, steps);
+  PrintDiagDandMu(diffusiontensor);
+
+  return;
+}
+
+Eigen::Matrix3d KMCMultiple::RunReplica(KMCReplica& replica) {
+
+  // the replicas only differ by their seed, the first one reports
+  bool first = (replica.getId() == 0);
+  bool checkifoutput = (outputtime_ != 0 && first);
+  double nexttrajoutput = 0;
+
   std::fstream traj;
   std::fstream tfile;
 
@@ -282,52 +359,51 @@ void KMCMultiple::RunVSSM() {
             << std::endl;
     }
   }
-  RandomlyCreateCharges();
+  RandomlyCreateCharges(replica);
+  std::vector<Chargecarrier>& carriers = replica.Carriers();
   std::vector<Eigen::Vector3d> startposition(numberofcarriers_,
                                              Eigen::Vector3d::Zero());
   for (Index i = 0; i < numberofcarriers_; i++) {
-    startposition[i] = carriers_[i].getCurrentPosition();
+    startposition[i] = graph_.Position(carriers[i].getCurrentNodeId());
   }
 
-  traj << 0 << "\t";
-  traj << 0 << "\t";
-  for (Index i = 0; i < numberofcarriers_; i++) {
-    traj << startposition[i].x() * tools::conv::bohr2nm << "\t";
-    traj << startposition[i].y() * tools::conv::bohr2nm << "\t";
-    traj << startposition[i].z() * tools::conv::bohr2nm;
-    if (i < numberofcarriers_ - 1) {
-      traj << "\t";
-    } else {
-      traj << std::endl;
+  if (checkifoutput) {
+    traj << 0 << "\t";
+    traj << 0 << "\t";
+    for (Index i = 0; i < numberofcarriers_; i++) {
+      traj << startposition[i].x() * tools::conv::bohr2nm << "\t";
+      traj << startposition[i].y() * tools::conv::bohr2nm << "\t";
+      traj << startposition[i].z() * tools::conv::bohr2nm;
+      if (i < numberofcarriers_ - 1) {
+        traj << "\t";
+      } else {
+        traj << std::endl;
+      }
     }
   }
 
-  std::vector<GNode*> forbiddennodes;
-  std::vector<GNode*> forbiddendests;
+  std::vector<Index> forbiddennodes;
+  std::vector<Index> forbiddendests;
 
   Eigen::Matrix3d avgdiffusiontensor = Eigen::Matrix3d::Zero();
 
-  double simtime = 0.0;
-  unsigned long step = 0;
-
-  while (((stopontime && simtime < runtime_) ||
-          (!stopontime && step < maxsteps))) {
+  while (((stopontime_ && replica.SimTime() < runtime_) ||
+          (!stopontime_ && replica.Steps() < maxsteps_))) {
 
     std::chrono::duration<double> elapsed_time =
-        std::chrono::system_clock::now() - realtime_start;
+        std::chrono::system_clock::now() - realtime_start_;
     if (elapsed_time.count() > (maxrealtime_ * 60. * 60.)) {
-      XTP_LOG(Log::error, log_)
-          << "\nReal time limit of " << maxrealtime_ << " hours ("
-          << Index(maxrealtime_ * 60 * 60 + 0.5)
-          << " seconds) has been reached. Stopping here.\n"
-          << std::flush;
+      if (first) {
+        XTP_LOG(Log::error, log_)
+            << "\nReal time limit of " << maxrealtime_ << " hours ("
+            << Index(maxrealtime_ * 60 * 60 + 0.5)
+            << " seconds) has been reached. Stopping here.\n"
+            << std::flush;
+      }
       break;
     }
 
-    double cumulated_rate = 0;
-    for (const auto& carrier : carriers_) {
-      cumulated_rate += carrier.getCurrentEscapeRate();
-    }
+    double cumulated_rate = replica.TotalEscapeRate();
     if (cumulated_rate <= 0) {  // this should not happen: no possible jumps
                                 // defined for a node
       throw std::runtime_error(
@@ -335,59 +411,56 @@ void KMCMultiple::RunVSSM() {
           "the escape rates for the current setting are 0.");
     }
 
-    double dt = Promotetime(cumulated_rate);
+    double dt = Promotetime(replica, cumulated_rate);
 
-    simtime += dt;
-    step++;
-
-    for (auto& carrier : carriers_) {
-      carrier.updateOccupationtime(dt);
-    }
+    replica.Advance(dt);
+    replica.UpdateOccupationTime(dt);
 
     ResetForbiddenlist(forbiddennodes);
     bool level1step = true;
     while (level1step) {
 
       // determine which electron will escape
-      GNode* newnode = nullptr;
-      Chargecarrier* affectedcarrier = ChooseAffectedCarrier(cumulated_rate);
+      Index newnode = -1;
+      Chargecarrier* affectedcarrier = ChooseAffectedCarrier(replica);
 
-      if (CheckForbidden(affectedcarrier->getCurrentNode(), forbiddennodes)) {
+      if (CheckForbidden(affectedcarrier->getCurrentNodeId(), forbiddennodes)) {
         continue;
       }
       ResetForbiddenlist(forbiddendests);
       while (true) {
         // LEVEL 2
 
-        const GLink& event =
-            ChooseHoppingDest(affectedcarrier->getCurrentNode());
-        newnode = event.getDestination();
-
-        if (newnode == nullptr) {
-          AddtoForbiddenlist(affectedcarrier->getCurrentNode(), forbiddennodes);
+        Index event =
+            ChooseHoppingDest(replica, affectedcarrier->getCurrentNodeId());
+        if (graph_.isDecayEvent(event)) {
+          AddtoForbiddenlist(affectedcarrier->getCurrentNodeId(),
+                             forbiddennodes);
           break;  // select new escape node (ends level 2 but without setting
                   // level1step to 1)
         }
 
+        newnode = graph_.Destination(event);
+
         // check after the event if this was allowed
-        if (CheckForbidden(*newnode, forbiddendests)) {
+        if (CheckForbidden(newnode, forbiddendests)) {
           continue;
         }
 
         // if the new segment is unoccupied: jump; if not: add to forbidden
         // list and choose new hopping destination
-        if (newnode->isOccupied()) {
-          if (CheckSurrounded(affectedcarrier->getCurrentNode(),
+        if (replica.isOccupied(newnode)) {
+          if (CheckSurrounded(affectedcarrier->getCurrentNodeId(),
                               forbiddendests)) {
-            AddtoForbiddenlist(affectedcarrier->getCurrentNode(),
+            AddtoForbiddenlist(affectedcarrier->getCurrentNodeId(),
                                forbiddennodes);
             break;  // select new escape node (ends level 2 but without
                     // setting level1step to 1)
           }
-          AddtoForbiddenlist(*newnode, forbiddendests);
+          AddtoForbiddenlist(newnode, forbiddendests);
           continue;  // select new destination
         } else {
-          affectedcarrier->jumpAccordingEvent(event);
+          replica.JumpCarrier(*affectedcarrier, event);
           level1step = false;
           break;  // this ends LEVEL 2 , so that the time is updated and the
                   // next MC step started
@@ -397,26 +470,28 @@ void KMCMultiple::RunVSSM() {
       // END LEVEL 1
     }
 
+    unsigned long step = replica.Steps();
     if (step % diffusionresolution_ == 0) {
-      for (const auto& carrier : carriers_) {
+      for (const auto& carrier : carriers) {
         avgdiffusiontensor += (carrier.get_dRtravelled()) *
                               (carrier.get_dRtravelled()).transpose();
       }
     }
 
-    if (step != 0 && step % intermediateoutput_frequency_ == 0) {
-      PrintDiffandMu(avgdiffusiontensor, simtime, step);
+    if (first && step != 0 && step % intermediateoutput_frequency_ == 0) {
+      PrintDiffandMu(DiffusionTensor(avgdiffusiontensor, replica),
+                     Velocities(replica), step);
     }
 
     if (checkifoutput) {
-      bool outputsteps = (!stopontime && step % outputstep == 0);
-      bool outputtime = (stopontime && simtime > nexttrajoutput);
+      bool outputsteps = (!stopontime_ && step % outputstep_ == 0);
+      bool outputtime = (stopontime_ && replica.SimTime() > nexttrajoutput);
       if (outputsteps || outputtime) {
         // write to trajectory file
-        nexttrajoutput = simtime + outputtime_;
-        WriteToTrajectory(traj, startposition, simtime, step);
+        nexttrajoutput = replica.SimTime() + outputtime_;
+        WriteToTrajectory(traj, startposition, replica);
         if (!timefile_.empty()) {
-          WriteToEnergyFile(tfile, simtime, step);
+          WriteToEnergyFile(tfile, replica);
         }
       }
     }
@@ -428,29 +503,7 @@ void KMCMultiple::RunVSSM() {
       tfile.close();
     }
   }
-
-  WriteOccupationtoFile(simtime, occfile_);
-
-  XTP_LOG(Log::error, log_) << "\nfinished KMC simulation after " << step
-                            << " steps.\n"
-                               "simulated time "
-                            << simtime << " seconds.\n"
-                            << std::flush;
-
-  PrintChargeVelocity(simtime);
-
-  XTP_LOG(Log::error, log_) << "\nDistances travelled (nm): " << std::flush;
-  for (Index i = 0; i < numberofcarriers_; i++) {
-    XTP_LOG(Log::error, log_)
-        << std::scientific << "    carrier " << i + 1 << ": "
-        << carriers_[i].get_dRtravelled().transpose() * tools::conv::bohr2nm
-        << std::flush;
-  }
-
-  PrintDiffandMu(avgdiffusiontensor, simtime, step);
-  PrintDiagDandMu(avgdiffusiontensor, simtime, step);
-
-  return;
+  return avgdiffusiontensor;
 }
 
 bool KMCMultiple::Evaluate(Topology& top) {
@@ -460,11 +513,8 @@ bool KMCMultiple::Evaluate(Topology& top) {
                                "\n-----------------------------------\n"
                             << std::flush;
 
-  XTP_LOG(Log::info, log_) << "\nInitialising random number generator"
-                           << std::flush;
-  RandomVariable_.init(seed_);
-
   LoadGraph(top);
+  FreezeGraph();
   RunVSSM();
   std::cout << log_;
   return true;
@@ -20,6 +20,7 @@
 #define VOTCA_XTP_KMCMULTIPLE_H
 
 // Standard includes
+#include <chrono>
 #include <fstream>
 
 // Local VOTCA includes
@@ -41,21 +42,30 @@ class KMCMultiple final : public KMCCalculator {
 
  private:
   void RunVSSM();
-  void PrintChargeVelocity(double simtime);
+  /// returns the sum of the squared displacements of the carriers
+  Eigen::Matrix3d RunReplica(KMCReplica& replica);
+  void PrintChargeVelocity(const std::vector<KMCReplica>& replicas);
 
-  void PrintDiagDandMu(const Eigen::Matrix3d& avgdiffusiontensor,
-                       double simtime, unsigned long step);
+  Eigen::Matrix3d DiffusionTensor(const Eigen::Matrix3d& avgdiffusiontensor,
+                                  const KMCReplica& replica) const;
+  std::vector<Eigen::Vector3d> Velocities(const KMCReplica& replica) const;
 
-  void WriteToEnergyFile(std::fstream& tfile, double simtime,
-                         unsigned long step) const;
+  void PrintDiagDandMu(const Eigen::Matrix3d& diffusiontensor);
+
+  void WriteToEnergyFile(std::fstream& tfile, const KMCReplica& replica) const;
 
   void WriteToTrajectory(std::fstream& traj,
                          std::vector<Eigen::Vector3d>& startposition,
-                         double simtime, unsigned long step) const;
+                         const KMCReplica& replica) const;
 
-  void PrintDiffandMu(const Eigen::Matrix3d& avgdiffusiontensor, double simtime,
+  void PrintDiffandMu(const Eigen::Matrix3d& diffusiontensor,
+                      const std::vector<Eigen::Vector3d>& velocities,
                       unsigned long step);
 
+  std::chrono::time_point<std::chrono::system_clock> realtime_start_;
+  bool stopontime_ = false;
+  unsigned long maxsteps_ = 0;
+  unsigned long outputstep_ = 0;
   double runtime_;
   double outputtime_;
   std::string timefile_ = "";
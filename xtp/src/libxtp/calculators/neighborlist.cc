@@ -15,10 +15,17 @@
  *
  */
 
+// Standard includes
+#include <algorithm>
+#include <tuple>
+
 // Third party includes
 #include <boost/format.hpp>
 #include <boost/progress.hpp>
 
+// Local VOTCA includes
+#include "votca/xtp/segmentcells.h"
+
 // Local private VOTCA includes
 #include "neighborlist.h"
 
@@ -72,16 +79,41 @@ void Neighborlist::ParseOptions(const tools::Property& options) {
   }
 }
 
+double Neighborlist::MaxCutoff(const std::vector<Segment*>& segs) const {
+  if (useConstantCutoff_) {
+    return constantCutoff_;
+  }
+  std::vector<std::string> types;
+  for (const Segment* seg : segs) {
+    if (!InVector(types, seg->getType())) {
+      types.push_back(seg->getType());
+    }
+  }
+  double maxcutoff = 0.0;
+  for (const std::string& type1 : types) {
+    for (const std::string& type2 : types) {
+      auto cutoffs = cutoffs_.find(type1);
+      if (cutoffs == cutoffs_.end()) {
+        continue;
+      }
+      auto cutoff = cutoffs->second.find(type2);
+      if (cutoff != cutoffs->second.end()) {
+        maxcutoff = std::max(maxcutoff, cutoff->second);
+      }
+    }
+  }
+  return maxcutoff;
+}
+
 Index Neighborlist::DetClassicalPairs(Topology& top) {
   Index classical_pairs = 0;
-#pragma omp parallel for
+#pragma omp parallel for reduction(+ : classical_pairs)
   for (Index i = 0; i < top.NBList().size(); i++) {
     const Segment* seg1 = top.NBList()[i]->Seg1();
     const Segment* seg2 = top.NBList()[i]->Seg2();
     if (top.GetShortestDist(*seg1, *seg2) > excitonqmCutoff_) {
       top.NBList()[i]->setType(QMPair::Excitoncl);
-#pragma omp critical
-      { classical_pairs++; }
+      classical_pairs++;
     } else {
       top.NBList()[i]->setType(QMPair::Hopping);
     }
@@ -120,72 +152,111 @@ bool Neighborlist::Evaluate(Topology& top) {
   }
 
   std::cout << "\r ... ... Evaluating " << std::flush;
-  std::vector<std::string> skippedpairs;
 
   top.NBList().Cleanup();
 
-  boost::progress_display progress(segs.size());
   // cache approx sizes
   std::vector<double> approxsize = std::vector<double>(segs.size(), 0.0);
 #pragma omp parallel for
   for (Index i = 0; i < Index(segs.size()); i++) {
     approxsize[i] = segs[i]->getApproxSize();
   }
+
+  double maxcutoff = MaxCutoff(segs);
+  if (segs.size() > 1 && maxcutoff > 0.5 * min) {
+    throw std::runtime_error(
+        (boost::format("Cutoff is larger than half the box size. Maximum "
+                       "allowed cutoff is %1$1.1f (nm)") %
+         (tools::conv::bohr2nm * 0.5 * min))
+            .str());
+  }
+  double maxsize = 0.0;
+  for (double size : approxsize) {
+    maxsize = std::max(maxsize, size);
+  }
+  // no pair further apart than that can be within the cutoff
+  SegmentCells cells(top.getBox(), segs, maxcutoff + 2 * maxsize);
+
+  // every thread collects its own pairs, they are added afterwards
+  struct Candidate {
+    Index seg1;
+    Index seg2;
+    Eigen::Vector3d distance;
+  };
+  std::vector<std::vector<Candidate>> candidates(OPENMP::getMaxThreads());
+  std::vector<std::vector<std::string>> skipped(OPENMP::getMaxThreads());
+
+  boost::progress_display progress(segs.size());
 #pragma omp parallel for schedule(guided)
   for (Index i = 0; i < Index(segs.size()); i++) {
+    Index thread = OPENMP::getThreadId();
     const Segment* seg1 = segs[i];
     double cutoff = constantCutoff_;
-    for (Index j = i + 1; j < Index(segs.size()); j++) {
-      const Segment* seg2 = segs[j];
-      if (!useConstantCutoff_) {
-        try {
-          cutoff = cutoffs_.at(seg1->getType()).at(seg2->getType());
-        } catch (const std::exception&) {
-          std::string pairstring = seg1->getType() + "/" + seg2->getType();
-          if (!InVector(skippedpairs, pairstring)) {
-#pragma omp critical
-            if (!InVector(skippedpairs, pairstring)) {  // nedded because other
-                                                        // thread may have
-                                                        // pushed back in the
-                                                        // meantime.
-              skippedpairs.push_back(pairstring);
+    for (Index cell : cells.Neighbours(cells.CellOf(i))) {
+      for (Index j : cells.Segments(cell)) {
+        if (j <= i) {
+          continue;
+        }
+        const Segment* seg2 = segs[j];
+        if (!useConstantCutoff_) {
+          try {
+            cutoff = cutoffs_.at(seg1->getType()).at(seg2->getType());
+          } catch (const std::exception&) {
+            std::string pairstring = seg1->getType() + "/" + seg2->getType();
+            if (!InVector(skipped[thread], pairstring)) {
+              skipped[thread].push_back(pairstring);
             }
+            continue;
           }
-          continue;
         }
-      }
 
-      if (cutoff > 0.5 * min) {
-        throw std::runtime_error(
-            (boost::format("Cutoff is larger than half the box size. Maximum "
-                           "allowed cutoff is %1$1.1f (nm)") %
-             (tools::conv::bohr2nm * 0.5 * min))
-                .str());
-      }
-      double cutoff2 = cutoff * cutoff;
-      Eigen::Vector3d segdistance =
-          top.PbShortestConnect(seg1->getPos(), seg2->getPos());
-      double segdistance2 = segdistance.squaredNorm();
-      double outside = cutoff + approxsize[i] + approxsize[j];
-
-      if (segdistance2 < cutoff2) {
-#pragma omp critical
-        { top.NBList().Add(*seg1, *seg2, segdistance); }
+        double cutoff2 = cutoff * cutoff;
+        Eigen::Vector3d segdistance =
+            top.PbShortestConnect(seg1->getPos(), seg2->getPos());
+        double segdistance2 = segdistance.squaredNorm();
+        double outside = cutoff + approxsize[i] + approxsize[j];
 
-      } else if (segdistance2 > (outside * outside)) {
-        continue;
-      } else {
-        double R = top.GetShortestDist(*seg1, *seg2);
-        if ((R * R) < cutoff2) {
-#pragma omp critical
-          { top.NBList().Add(*seg1, *seg2, segdistance); }
+        if (segdistance2 < cutoff2) {
+          candidates[thread].push_back({i, j, segdistance});
+        } else if (segdistance2 > (outside * outside)) {
+          continue;
+        } else {
+          double R = top.GetShortestDist(*seg1, *seg2);
+          if ((R * R) < cutoff2) {
+            candidates[thread].push_back({i, j, segdistance});
+          }
         }
-      }
-    } /* exit loop seg2 */
+      } /* exit loop seg2 */
+    }
 #pragma omp critical
     { ++progress; }
   } /* exit loop seg1 */
 
+  // which thread found a pair depends on the scheduling, the pairs are added
+  // in a fixed order, such that the pair ids do not depend on the OpenMP
+  // scheduling
+  std::vector<Candidate> pairs;
+  for (const std::vector<Candidate>& thread_candidates : candidates) {
+    pairs.insert(pairs.end(), thread_candidates.begin(),
+                 thread_candidates.end());
+  }
+  std::sort(pairs.begin(), pairs.end(),
+            [](const Candidate& a, const Candidate& b) {
+              return std::tie(a.seg1, a.seg2) < std::tie(b.seg1, b.seg2);
+            });
+  for (const Candidate& c : pairs) {
+    top.NBList().Add(*segs[c.seg1], *segs[c.seg2], c.distance);
+  }
+  std::vector<std::string> skippedpairs;
+  for (const std::vector<std::string>& thread_skipped : skipped) {
+    for (const std::string& pairstring : thread_skipped) {
+      if (!InVector(skippedpairs, pairstring)) {
+        skippedpairs.push_back(pairstring);
+      }
+    }
+  }
+  std::sort(skippedpairs.begin(), skippedpairs.end());
+
   if (skippedpairs.size() > 0) {
     std::cout << "WARNING: No cut-off specified for segment pairs of type "
               << std::endl;
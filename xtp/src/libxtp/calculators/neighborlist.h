@@ -44,6 +44,8 @@ class Neighborlist final : public QMCalculator {
 
  private:
   Index DetClassicalPairs(Topology& top);
+  /// largest cutoff between any of the segments
+  double MaxCutoff(const std::vector<Segment*>& segs) const;
 
   std::vector<std::string> included_segments_;
   std::map<std::string, std::map<std::string, double> > cutoffs_;
@@ -0,0 +1,78 @@
+/*
+ *            Copyright 2009-2021 The VOTCA Development Team
+ *                       (http://www.votca.org)
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Standard includes
+#include <fstream>
+#include <stdexcept>
+
+// Third party includes
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/sync/file_lock.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+// Local VOTCA includes
+#include "votca/xtp/couplingstore.h"
+
+namespace votca {
+namespace xtp {
+
+bool CouplingStore::exists() const { return boost::filesystem::exists(file_); }
+
+void CouplingStore::Append(const std::vector<Coupling> &couplings) const {
+  if (couplings.empty()) {
+    return;
+  }
+  // opening for appending creates the file without truncating it
+  std::ofstream out(file_, std::ios::out | std::ios::app | std::ios::binary);
+  if (!out.is_open()) {
+    throw std::runtime_error("Bad file handle: " + file_);
+  }
+  boost::interprocess::file_lock flock(file_.c_str());
+  boost::interprocess::scoped_lock<boost::interprocess::file_lock> lock(flock);
+  out.write(reinterpret_cast<const char *>(couplings.data()),
+            std::streamsize(couplings.size() * sizeof(Coupling)));
+  out.flush();
+  if (!out) {
+    throw std::runtime_error("Could not write " + file_);
+  }
+}
+
+std::vector<CouplingStore::Coupling> CouplingStore::ReadAll() const {
+  std::ifstream in(file_, std::ios::in | std::ios::binary);
+  if (!in.is_open()) {
+    throw std::runtime_error("Bad file handle: " + file_);
+  }
+  in.seekg(0, std::ios::end);
+  std::streamoff size = in.tellg();
+  if (size % std::streamoff(sizeof(Coupling)) != 0) {
+    throw std::runtime_error(file_ + " is truncated or not a coupling store");
+  }
+  std::vector<Coupling> couplings(std::size_t(size) / sizeof(Coupling));
+  in.seekg(0);
+  in.read(reinterpret_cast<char *>(couplings.data()), size);
+  if (!in) {
+    throw std::runtime_error("Could not read " + file_);
+  }
+  return couplings;
+}
+
+void CouplingStore::Remove() const { boost::filesystem::remove(file_); }
+
+}  // namespace xtp
+}  // namespace votca
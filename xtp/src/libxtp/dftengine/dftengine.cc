@@ -61,6 +61,11 @@ void DFTEngine::Initialize(tools::Property& options) {
   initial_guess_ = options.get(".initial_guess").as<std::string>();
 
   grid_name_ = options.get(key_xtpdft + ".integration_grid").as<std::string>();
+  if (options.exists(key_xtpdft + ".ao_cache")) {
+    ao_cache_mb_ = options.get(key_xtpdft + ".ao_cache.memory").as<double>();
+    ao_cache_single_ =
+        options.get(key_xtpdft + ".ao_cache.single_precision").as<bool>();
+  }
   xc_functional_name_ = options.get(".functional").as<std::string>();
 
   if (options.exists(key_xtpdft + ".externaldensity")) {
@@ -873,6 +878,13 @@ Vxc_Potential<Vxc_Grid> DFTEngine::SetupVxc(const QMMolecule& mol) {
       << "\t\t "
       << " with " << grid.getGridSize() << " points"
       << " divided into " << grid.getBoxesSize() << " boxes" << std::flush;
+  if (ao_cache_mb_ > 0) {
+    vxc.SetupAOCache(ao_cache_mb_, ao_cache_single_);
+    XTP_LOG(Log::info, *pLog_)
+        << TimeStamp() << " Cached basis function values of "
+        << vxc.CachedBoxes() << " boxes in " << vxc.AOCacheMB() << " MB"
+        << std::flush;
+  }
   return vxc;
 }
 
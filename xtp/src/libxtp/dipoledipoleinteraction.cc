@@ -0,0 +1,146 @@
+/*
+ *            Copyright 2009-2021 The VOTCA Development Team
+ *                       (http://www.votca.org)
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Standard includes
+#include <algorithm>
+#include <cmath>
+
+// Local VOTCA includes
+#include "votca/xtp/dipoledipoleinteraction.h"
+
+namespace votca {
+namespace xtp {
+
+using RowMatrixX3d = Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>;
+
+void DipoleDipoleInteraction::SetupTiles() {
+  const Index nsites = Index(sites_.size());
+  pos_.resize(nsites, 3);
+  damp_.resize(nsites);
+  for (Index i = 0; i < nsites; i++) {
+    pos_.row(i) = sites_[i]->getPos().transpose();
+    damp_(i) = sites_[i]->getSqrtInvEigenDamp();
+  }
+  // enough tiles for a few pairs per thread in every round, small enough
+  // that the data of two tiles stays in the cache
+  Index tile_size = nsites / (4 * OPENMP::getMaxThreads());
+  tile_size = std::max(Index(16), std::min(Index(128), tile_size));
+  for (Index begin = 0; begin < nsites; begin += tile_size) {
+    tile_begin_.push_back(begin);
+  }
+  tile_begin_.push_back(nsites);
+}
+
+void DipoleDipoleInteraction::MultiplyTiles(const Eigen::VectorXd& v,
+                                            Eigen::VectorXd& result,
+                                            double skip2) const {
+  const Index nsites = Index(sites_.size());
+  const Index ntiles = Index(tile_begin_.size()) - 1;
+  // x, y and z components in separate columns
+  const Eigen::MatrixX3d v_xyz =
+      Eigen::Map<const RowMatrixX3d>(v.data(), nsites, 3);
+  Eigen::MatrixX3d result_xyz = Eigen::MatrixX3d::Zero(nsites, 3);
+
+  // round robin over the pairs of tiles: in every round each tile is part of
+  // at most one pair, so the threads never write to the same sites
+  const Index n = ntiles + (ntiles % 2);
+#pragma omp parallel
+  {
+#pragma omp for schedule(dynamic)
+    for (Index tile = 0; tile < ntiles; tile++) {
+      MultiplyTilePair(tile, tile, v_xyz, result_xyz, skip2);
+    }
+    for (Index round = 0; round < n - 1; round++) {
+#pragma omp for schedule(dynamic)
+      for (Index k = 0; k < n / 2; k++) {
+        Index tile1 = (k == 0) ? n - 1 : (round + k) % (n - 1);
+        Index tile2 = (k == 0) ? round : (round - k + n - 1) % (n - 1);
+        // for an odd number of tiles the last one is a dummy
+        if (tile1 < ntiles && tile2 < ntiles) {
+          MultiplyTilePair(tile1, tile2, v_xyz, result_xyz, skip2);
+        }
+      }
+    }
+  }
+  Eigen::Map<RowMatrixX3d>(result.data(), nsites, 3) += result_xyz;
+}
+
+void DipoleDipoleInteraction::MultiplyTilePair(Index tile1, Index tile2,
+                                               const Eigen::MatrixX3d& v,
+                                               Eigen::MatrixX3d& result,
+                                               double skip2) const {
+  const double* x = pos_.col(0).data();
+  const double* y = pos_.col(1).data();
+  const double* z = pos_.col(2).data();
+  const double* damp = damp_.data();
+  const double* vx = v.col(0).data();
+  const double* vy = v.col(1).data();
+  const double* vz = v.col(2).data();
+  double* rx = result.col(0).data();
+  double* ry = result.col(1).data();
+  double* rz = result.col(2).data();
+  const double expdamping = interactor_.getExpDamping();
+
+  for (Index i = tile_begin_[tile1]; i < tile_begin_[tile1 + 1]; i++) {
+    const double xi = x[i];
+    const double yi = y[i];
+    const double zi = z[i];
+    const double vxi = vx[i];
+    const double vyi = vy[i];
+    const double vzi = vz[i];
+    const double dampi = expdamping * damp[i];
+    double rxi = 0.0;
+    double ryi = 0.0;
+    double rzi = 0.0;
+    const Index begin = (tile1 == tile2) ? i + 1 : tile_begin_[tile2];
+    const Index end = tile_begin_[tile2 + 1];
+#pragma omp simd reduction(+ : rxi, ryi, rzi)
+    for (Index j = begin; j < end; j++) {
+      const double ax = x[j] - xi;
+      const double ay = y[j] - yi;
+      const double az = z[j] - zi;
+      const double R2 = ax * ax + ay * ay + az * az;
+      const double R = std::sqrt(R2);
+      // same damping as in eeInteractor::FillTholeInteraction
+      const double fac3 = 1 / (R2 * R);
+      const double au3 = dampi * damp[j] * R2 * R;
+      const double exp_ua = (au3 < 40) ? std::exp(-au3) : 0.0;
+      // pairs within skip2 are taken from the block cache
+      const double factor = (R2 < skip2) ? 0.0 : fac3;
+      const double lambda3 = factor * (1 - exp_ua);
+      const double lambda5 = factor * (1 - (1 + au3) * exp_ua);
+      // T = lambda3 - 3 lambda5 a a^T / R^2 is symmetric
+      const double c5 = 3 * lambda5 / R2;
+      const double avj = ax * vx[j] + ay * vy[j] + az * vz[j];
+      const double avi = ax * vxi + ay * vyi + az * vzi;
+      rxi += lambda3 * vx[j] - c5 * ax * avj;
+      ryi += lambda3 * vy[j] - c5 * ay * avj;
+      rzi += lambda3 * vz[j] - c5 * az * avj;
+      rx[j] += lambda3 * vxi - c5 * ax * avi;
+      ry[j] += lambda3 * vyi - c5 * ay * avi;
+      rz[j] += lambda3 * vzi - c5 * az * avi;
+    }
+    rx[i] += rxi;
+    ry[i] += ryi;
+    rz[i] += rzi;
+  }
+}
+
+}  // namespace xtp
+}  // namespace votca
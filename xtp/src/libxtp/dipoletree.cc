@@ -0,0 +1,276 @@
+/*
+ *            Copyright 2009-2021 The VOTCA Development Team
+ *                       (http://www.votca.org)
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Standard includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+// Local VOTCA includes
+#include "votca/xtp/dipoletree.h"
+
+namespace votca {
+namespace xtp {
+
+DipoleTree::DipoleTree(const eeInteractor& interactor,
+                       const std::vector<const PolarSite*>& sites,
+                       double opening_angle)
+    : interactor_(interactor), sites_(sites), opening_angle_(opening_angle) {
+  if (opening_angle_ <= 0.0 || opening_angle_ >= 1.0) {
+    throw std::runtime_error(
+        "Opening angle of the dipole tree has to be in (0,1)");
+  }
+  order_.resize(sites_.size());
+  std::iota(order_.begin(), order_.end(), 0);
+  if (sites_.empty()) {
+    return;
+  }
+  Node root;
+  root.begin = 0;
+  root.end = Index(sites_.size());
+  nodes_.push_back(root);
+  // nodes_ grows while it is traversed, so children follow their parents
+  for (Index node = 0; node < Index(nodes_.size()); node++) {
+    Split(node);
+  }
+}
+
+void DipoleTree::Split(Index node) {
+  Index begin = nodes_[node].begin;
+  Index end = nodes_[node].end;
+
+  Eigen::Vector3d center = Eigen::Vector3d::Zero();
+  Eigen::Vector3d min = sites_[order_[begin]]->getPos();
+  Eigen::Vector3d max = min;
+  double damp = std::numeric_limits<double>::infinity();
+  for (Index i = begin; i < end; i++) {
+    const PolarSite& site = *sites_[order_[i]];
+    center += site.getPos();
+    min = min.cwiseMin(site.getPos());
+    max = max.cwiseMax(site.getPos());
+    damp = std::min(damp, site.getSqrtInvEigenDamp());
+  }
+  center /= double(end - begin);
+  double radius = 0.0;
+  for (Index i = begin; i < end; i++) {
+    radius = std::max(radius, (sites_[order_[i]]->getPos() - center).norm());
+  }
+  nodes_[node].center = center;
+  nodes_[node].radius = radius;
+  nodes_[node].damp = damp;
+
+  // sites on top of each other cannot be separated
+  if (end - begin <= leaf_size_ || (max - min).maxCoeff() < 1e-8) {
+    return;
+  }
+
+  // sort the sites into the octants of the bounding box
+  Eigen::Vector3d mid = 0.5 * (min + max);
+  auto octant = [&](Index i) {
+    const Eigen::Vector3d& pos = sites_[i]->getPos();
+    return Index(pos.x() > mid.x()) + 2 * Index(pos.y() > mid.y()) +
+           4 * Index(pos.z() > mid.z());
+  };
+  std::stable_sort(order_.begin() + begin, order_.begin() + end,
+                   [&](Index a, Index b) { return octant(a) < octant(b); });
+
+  Index child_begin = begin;
+  while (child_begin < end) {
+    Index oct = octant(order_[child_begin]);
+    Index child_end = child_begin;
+    while (child_end < end && octant(order_[child_end]) == oct) {
+      child_end++;
+    }
+    Node child;
+    child.begin = child_begin;
+    child.end = child_end;
+    nodes_[node].children.push_back(Index(nodes_.size()));
+    nodes_.push_back(child);
+    child_begin = child_end;
+  }
+}
+
+std::vector<DipoleTree::Moments> DipoleTree::CalcMoments(
+    const Eigen::VectorXd& dipoles) const {
+  std::vector<Moments> moments(nodes_.size());
+  // children first
+  for (Index node = Index(nodes_.size()) - 1; node >= 0; node--) {
+    const Node& n = nodes_[node];
+    Moments& m = moments[node];
+    if (n.children.empty()) {
+      for (Index i = n.begin; i < n.end; i++) {
+        Index site = order_[i];
+        const Eigen::Vector3d dipole = dipoles.segment<3>(3 * site);
+        m.dipole += dipole;
+        m.first += (sites_[site]->getPos() - n.center) * dipole.transpose();
+      }
+    } else {
+      for (Index child : n.children) {
+        const Moments& c = moments[child];
+        m.dipole += c.dipole;
+        m.first +=
+            c.first + (nodes_[child].center - n.center) * c.dipole.transpose();
+      }
+    }
+  }
+  return moments;
+}
+
+bool DipoleTree::isFarField(const Node& node, const PolarSite& site) const {
+  double distance = (site.getPos() - node.center).norm();
+  if (node.radius >= opening_angle_ * distance) {
+    return false;
+  }
+  // same criterion as in eeInteractor::FillTholeInteraction for the closest
+  // and most polarisable site of the box, which is damped the most
+  double closest = distance - node.radius;
+  double au3 = interactor_.getExpDamping() * std::pow(closest, 3) *
+               site.getSqrtInvEigenDamp() * node.damp;
+  return au3 >= 40;
+}
+
+Eigen::Vector3d DipoleTree::FarField(const Eigen::Vector3d& dr,
+                                     const Moments& moments) {
+  // T(dr-s) ~ T(dr) - s_k d_k T(dr) with the dipole tensor
+  // T_ab = delta_ab/R^3 - 3 R_a R_b/R^5
+  const double R2 = dr.squaredNorm();
+  const double R = std::sqrt(R2);
+  const double fac3 = 1 / (R2 * R);
+  const double fac5 = fac3 / R2;
+  const double fac7 = fac5 / R2;
+  const Eigen::Matrix3d& M = moments.first;
+  Eigen::Vector3d result =
+      fac3 * moments.dipole - 3 * fac5 * dr * dr.dot(moments.dipole);
+  Eigen::Vector3d gradient =
+      -3 * fac5 * (M.transpose() * dr + M * dr + M.trace() * dr) +
+      15 * fac7 * dr.dot(M * dr) * dr;
+  return result - gradient;
+}
+
+void DipoleTree::AddFarFieldAdjoint(const Eigen::Vector3d& dr,
+                                    const Eigen::Vector3d& dipole,
+                                    Moments& adjoint) {
+  // derivatives of dipole^T FarField(dr, moments) with respect to the
+  // moments, FarField is linear in them
+  const double R2 = dr.squaredNorm();
+  const double R = std::sqrt(R2);
+  const double fac3 = 1 / (R2 * R);
+  const double fac5 = fac3 / R2;
+  const double fac7 = fac5 / R2;
+  const double dr_dipole = dr.dot(dipole);
+  adjoint.dipole += fac3 * dipole - 3 * fac5 * dr_dipole * dr;
+  Eigen::Matrix3d first =
+      3 * fac5 * (dr * dipole.transpose() + dipole * dr.transpose()) -
+      15 * fac7 * dr_dipole * dr * dr.transpose();
+  first.diagonal().array() += 3 * fac5 * dr_dipole;
+  adjoint.first += first;
+}
+
+Eigen::VectorXd DipoleTree::DistributeAdjoint(
+    std::vector<Moments>& adjoint) const {
+  Eigen::VectorXd result = Eigen::VectorXd::Zero(3 * Index(sites_.size()));
+  // parents first, the transpose of CalcMoments
+  for (Index node = 0; node < Index(nodes_.size()); node++) {
+    const Node& n = nodes_[node];
+    const Moments& a = adjoint[node];
+    if (n.children.empty()) {
+      for (Index i = n.begin; i < n.end; i++) {
+        Index site = order_[i];
+        result.segment<3>(3 * site) +=
+            a.dipole +
+            a.first.transpose() * (sites_[site]->getPos() - n.center);
+      }
+    } else {
+      for (Index child : n.children) {
+        Moments& c = adjoint[child];
+        c.dipole +=
+            a.dipole + a.first.transpose() * (nodes_[child].center - n.center);
+        c.first += a.first;
+      }
+    }
+  }
+  return result;
+}
+
+Eigen::VectorXd DipoleTree::Multiply(const Eigen::VectorXd& dipoles) const {
+  assert(dipoles.size() == 3 * Index(sites_.size()) &&
+         "input vector has the wrong size for the dipole tree");
+  Eigen::VectorXd result = Eigen::VectorXd::Zero(dipoles.size());
+  if (nodes_.empty()) {
+    return result;
+  }
+  const std::vector<Moments> moments = CalcMoments(dipoles);
+  const Index nsites = Index(sites_.size());
+  // the walk of every site decides on its own which pairs are far field, so
+  // the transposed product is collected alongside and the mean of both is
+  // returned, conjugate gradients needs a symmetric operator
+  Eigen::VectorXd transposed = Eigen::VectorXd::Zero(dipoles.size());
+  std::vector<Moments> adjoint(nodes_.size());
+#pragma omp parallel
+  {
+    Eigen::VectorXd transposed_thread = Eigen::VectorXd::Zero(dipoles.size());
+    std::vector<Moments> adjoint_thread(nodes_.size());
+#pragma omp for schedule(dynamic, 32)
+    for (Index i = 0; i < nsites; i++) {
+      const PolarSite& site = *sites_[i];
+      const Eigen::Vector3d dipole = dipoles.segment<3>(3 * i);
+      Eigen::Vector3d field = Eigen::Vector3d::Zero();
+      std::vector<Index> stack = {0};
+      while (!stack.empty()) {
+        const Index node = stack.back();
+        stack.pop_back();
+        const Node& n = nodes_[node];
+        if (isFarField(n, site)) {
+          const Eigen::Vector3d dr = site.getPos() - n.center;
+          field += FarField(dr, moments[node]);
+          AddFarFieldAdjoint(dr, dipole, adjoint_thread[node]);
+        } else if (n.children.empty()) {
+          for (Index k = n.begin; k < n.end; k++) {
+            Index j = order_[k];
+            if (j == i) {
+              continue;
+            }
+            const Eigen::Matrix3d block =
+                interactor_.FillTholeInteraction(site, *sites_[j]);
+            field += block * dipoles.segment<3>(3 * j);
+            transposed_thread.segment<3>(3 * j) += block.transpose() * dipole;
+          }
+        } else {
+          stack.insert(stack.end(), n.children.begin(), n.children.end());
+        }
+      }
+      result.segment<3>(3 * i) = field;
+    }
+#pragma omp critical
+    {
+      transposed += transposed_thread;
+      for (Index node = 0; node < Index(nodes_.size()); node++) {
+        adjoint[node].dipole += adjoint_thread[node].dipole;
+        adjoint[node].first += adjoint_thread[node].first;
+      }
+    }
+  }
+  transposed += DistributeAdjoint(adjoint);
+  return 0.5 * (result + transposed);
+}
+
+}  // namespace xtp
+}  // namespace votca
@@ -15,9 +15,6 @@
  *
  */
 
-// Standard includes
-#include <queue>
-
 // Local VOTCA includes
 #include "votca/xtp/gnode.h"
 
@@ -41,15 +38,6 @@ void GNode::InitEscapeRate() {
   }
 }
 
-GLink* GNode::findHoppingDestination(double p) const {
-  return hTree.findHoppingDestination(p);
-}
-
-void GNode::MakeHuffTree() {
-  hTree.setEvents(&events_);
-  hTree.makeTree();
-}
-
 void GNode::AddEventfromQmPair(const QMPair& pair, std::vector<GNode>& nodes,
                                double rate) {
   Index destination = 0;
@@ -52,6 +52,27 @@ AOShell::AOValues GridBox::CalcAOValues(const Eigen::Vector3d& point) const {
   return result;
 }
 
+GridBox::AOValuesOnGrid GridBox::CalcAOValuesOnGrid() const {
+  AOValuesOnGrid result;
+  result.values = Eigen::MatrixXd::Zero(size(), Matrixsize());
+  for (Eigen::MatrixXd& derivative : result.derivatives) {
+    derivative = Eigen::MatrixXd::Zero(size(), Matrixsize());
+  }
+  for (Index p = 0; p < size(); ++p) {
+    for (Index j = 0; j < Shellsize(); ++j) {
+      const AOShell::AOValues val =
+          significant_shells[j]->EvalAOspace(grid_pos[p]);
+      const GridboxRange& range = aoranges[j];
+      result.values.row(p).segment(range.start, range.size) = val.values;
+      for (Index k = 0; k < 3; ++k) {
+        result.derivatives[k].row(p).segment(range.start, range.size) =
+            val.derivatives.col(k);
+      }
+    }
+  }
+  return result;
+}
+
 void GridBox::AddtoBigMatrix(Eigen::MatrixXd& bigmatrix,
                              const Eigen::MatrixXd& smallmatrix) const {
   for (Index i = 0; i < Index(ranges.size()); i++) {
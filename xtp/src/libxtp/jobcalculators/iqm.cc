@@ -17,6 +17,11 @@
  *
  */
 
+// Standard includes
+#include <map>
+#include <tuple>
+#include <utility>
+
 // Third party includes
 #include <boost/algorithm/string/split.hpp>
 #include <boost/filesystem.hpp>
@@ -549,16 +554,102 @@ Job::JobResult IQM::EvalJob(const Topology& top, Job& job, QMThread& opThread) {
         << "Orb file is not saved according to options " << std::flush;
   }
 
+  try {
+    StoreCouplings(CouplingsFromOutput(ID_A, ID_B, job_output));
+  } catch (std::runtime_error& error) {
+    std::string errormessage(error.what());
+    SetJobToFailed(jres, pLog, errormessage);
+    return jres;
+  }
+
   jres.setOutput(job_summary);
   jres.setStatus(Job::COMPLETE);
 
   return jres;
 }
 
+std::vector<CouplingStore::Coupling> IQM::CouplingsFromOutput(
+    Index segA, Index segB, const tools::Property& job_output) const {
+  std::vector<CouplingStore::Coupling> couplings;
+  auto add_coupling = [&](QMStateType type, Index stateA, Index stateB,
+                          double j) {
+    CouplingStore::Coupling coupling;
+    coupling.segA = std::int64_t(segA);
+    coupling.segB = std::int64_t(segB);
+    coupling.type = std::int32_t(type.Type());
+    coupling.padding = 0;
+    coupling.stateA = std::int64_t(stateA);
+    coupling.stateB = std::int64_t(stateB);
+    coupling.j = j * tools::conv::ev2hrt;
+    couplings.push_back(coupling);
+  };
+
+  if (job_output.exists("dftcoupling")) {
+    const tools::Property& dftprop = job_output.get("dftcoupling");
+    Index homoA = dftprop.getAttribute<Index>("homoA");
+    Index homoB = dftprop.getAttribute<Index>("homoB");
+    QMStateType hole = QMStateType(QMStateType::Hole);
+    if (dftprop.exists(hole.ToLongString())) {
+      const tools::Property& holes = dftprop.get(hole.ToLongString());
+      for (const tools::Property* state : holes.Select("coupling")) {
+        add_coupling(hole, homoA - state->getAttribute<Index>("levelA"),
+                     homoB - state->getAttribute<Index>("levelB"),
+                     state->getAttribute<double>("j"));
+      }
+    }
+    QMStateType electron = QMStateType(QMStateType::Electron);
+    if (dftprop.exists(electron.ToLongString())) {
+      const tools::Property& electrons = dftprop.get(electron.ToLongString());
+      for (const tools::Property* state : electrons.Select("coupling")) {
+        add_coupling(electron, state->getAttribute<Index>("levelA") - homoA - 1,
+                     state->getAttribute<Index>("levelB") - homoB - 1,
+                     state->getAttribute<double>("j"));
+      }
+    }
+  }
+  if (job_output.exists("bsecoupling")) {
+    const tools::Property& bseprop = job_output.get("bsecoupling");
+    for (QMStateType type : {QMStateType(QMStateType::Singlet),
+                             QMStateType(QMStateType::Triplet)}) {
+      if (!bseprop.exists(type.ToLongString())) {
+        continue;
+      }
+      const tools::Property& states = bseprop.get(type.ToLongString());
+      std::string algorithm = states.getAttribute<std::string>("algorithm");
+      for (const tools::Property* state : states.Select("coupling")) {
+        QMState stateA = state->getAttribute<QMState>("stateA");
+        QMState stateB = state->getAttribute<QMState>("stateB");
+        // the record only keeps the index, states of another type could
+        // never match the levels of this type
+        if (stateA.Type() != type || stateB.Type() != type) {
+          continue;
+        }
+        add_coupling(type, stateA.StateIdx(), stateB.StateIdx(),
+                     state->getAttribute<double>(algorithm));
+      }
+    }
+  }
+  return couplings;
+}
+
+void IQM::StoreCouplings(
+    const std::vector<CouplingStore::Coupling>& couplings) {
+  couplingMutex_.Lock();
+  try {
+    CouplingStore(jobfile_).Append(couplings);
+  } catch (std::runtime_error&) {
+    couplingMutex_.Unlock();
+    throw;
+  }
+  couplingMutex_.Unlock();
+}
+
 void IQM::WriteJobFile(const Topology& top) {
 
   std::cout << std::endl
             << "... ... Writing job file " << jobfile_ << std::flush;
+  // couplings of an older job file must not be read back
+  CouplingStore(jobfile_).Remove();
   std::ofstream ofs;
   ofs.open(jobfile_, std::ofstream::out);
   if (!ofs.is_open()) {
@@ -608,45 +699,19 @@ void IQM::WriteJobFile(const Topology& top) {
   return;
 }
 
-double IQM::GetDFTCouplingFromProp(const tools::Property& dftprop, Index stateA,
-                                   Index stateB) {
-  double J = 0;
-  bool found = false;
-  for (const tools::Property* state : dftprop.Select("coupling")) {
-    Index state1 = state->getAttribute<Index>("levelA");
-    Index state2 = state->getAttribute<Index>("levelB");
-    if (state1 == stateA && state2 == stateB) {
-      J = state->getAttribute<double>("j") * tools::conv::ev2hrt;
-      found = true;
-      break;
-    }
-  }
-  if (found) {
-    return J * J;
-  } else {
-    return -1;
-  }
-}
-
-double IQM::GetBSECouplingFromProp(const tools::Property& bseprop,
-                                   const QMState& stateA,
-                                   const QMState& stateB) {
-  double J = 0;
-  std::string algorithm = bseprop.getAttribute<std::string>("algorithm");
-  bool found = false;
-  for (const tools::Property* state : bseprop.Select("coupling")) {
-    QMState state1 = state->getAttribute<QMState>("stateA");
-    QMState state2 = state->getAttribute<QMState>("stateB");
-    if (state1 == stateA && state2 == stateB) {
-      J = state->getAttribute<double>(algorithm) * tools::conv::ev2hrt;
-      found = true;
-      break;
-    }
-  }
-  if (found) {
-    return J * J;
-  } else {
-    return -1;
+const std::map<std::string, QMState>& IQM::LevelMap(QMStateType type) const {
+  switch (type.Type()) {
+    case QMStateType::Hole:
+      return hole_levels_;
+    case QMStateType::Electron:
+      return electron_levels_;
+    case QMStateType::Singlet:
+      return singlet_levels_;
+    case QMStateType::Triplet:
+      return triplet_levels_;
+    default:
+      throw std::runtime_error("No coupling levels for states of type " +
+                               type.ToLongString());
   }
 }
 
@@ -671,128 +736,169 @@ void IQM::ReadJobFile(Topology& top) {
   // gets the neighborlist from the topology
   QMNBList& nblist = top.NBList();
   Index number_of_pairs = nblist.size();
-  Index dft_h = 0;
-  Index dft_e = 0;
-  Index bse_s = 0;
-  Index bse_t = 0;
   Index incomplete_jobs = 0;
+  Index jobs_from_output = 0;
   Logger log;
   log.setReportLevel(Log::current_level);
 
-  tools::Property xml;
-  // load the QC results in a vector indexed by the pair ID
-  xml.LoadFromXML(jobfile_);
-
-  // loop over all jobs = pair records in the job file
-  for (tools::Property* job : xml.Select("jobs.job")) {
-    if (!job->exists("status")) {
-      throw std::runtime_error(
-          "Jobfile is malformed. <status> tag missing on job.");
-    }
-    if (job->get("status").as<std::string>() != "COMPLETE" ||
-        !job->exists("output")) {
-      incomplete_jobs++;
-      continue;
+  // the status of the jobs of the last run, without it the job file decides
+  std::map<Index, Job::JobStatus> status = JobStore::ReadStatus(jobfile_);
+  Index complete_jobs = 0;
+  for (const auto& job : status) {
+    if (job.second == Job::COMPLETE) {
+      complete_jobs++;
     }
+  }
 
-    // job file is stupid, because segment ids are only in input have to get
-    // them out l
-    std::vector<Index> id;
-    for (tools::Property* segment : job->Select("input.segment")) {
-      id.push_back(segment->getAttribute<Index>("id"));
-    }
-    if (id.size() != 2) {
-      throw std::runtime_error(
-          "Getting pair ids from jobfile failed, check jobfile.");
+  // couplings the jobs appended to the store, by segment pair. A job that ran
+  // more than once appended its couplings again, the last record of a pair
+  // and state wins.
+  std::map<std::tuple<Index, Index, Index, Index, Index>,
+           CouplingStore::Coupling>
+      latest;
+  CouplingStore store(jobfile_);
+  if (store.exists()) {
+    for (const CouplingStore::Coupling& coupling : store.ReadAll()) {
+      latest[std::make_tuple(Index(coupling.segA), Index(coupling.segB),
+                             Index(coupling.type), Index(coupling.stateA),
+                             Index(coupling.stateB))] = coupling;
     }
+  }
+  std::map<std::pair<Index, Index>, std::vector<CouplingStore::Coupling>>
+      stored_couplings;
+  for (const auto& coupling : latest) {
+    stored_couplings[{Index(coupling.second.segA), Index(coupling.second.segB)}]
+        .push_back(coupling.second);
+  }
+  if (!stored_couplings.empty()) {
+    XTP_LOG(Log::error, log)
+        << "Read " << latest.size() << " couplings of "
+        << stored_couplings.size() << " pairs from "
+        << CouplingStore::StoreName(jobfile_) << std::flush;
+  }
 
-    // segments which correspond to these ids
-    Segment& segA = top.getSegment(id[0]);
-    Segment& segB = top.getSegment(id[1]);
-    // pair that corresponds to the two segments
-    QMPair* qmp = nblist.FindPair(&segA, &segB);
-
-    if (qmp == nullptr) {  // there is no pair in the neighbor list with this
-                           // name
-      XTP_LOG(Log::error, log)
-          << "No pair " << id[0] << ":" << id[1]
-          << " found in the neighbor list. Ignoring" << std::flush;
-      continue;
-    }
-    if (qmp->getType() != QMPair::PairType::Hopping) {
-      XTP_LOG(Log::error, log) << "WARNING Pair " << qmp->getId()
-                               << " is not of any of the "
-                                  "Hopping type. Skipping pair"
-                               << std::flush;
-      continue;
+  std::map<QMStateType::statetype, Index> updated;
+  for (const auto& pair : stored_couplings) {
+    QMPair* qmp =
+        FindHoppingPair(top, pair.first.first, pair.first.second, log);
+    if (qmp != nullptr) {
+      SetCouplings(*qmp, top.getSegment(pair.first.first),
+                   top.getSegment(pair.first.second), pair.second, updated);
     }
+  }
 
-    const tools::Property& pair_property = job->get("output");
-
-    if (pair_property.exists("dftcoupling")) {
-      const tools::Property& dftprop = pair_property.get("dftcoupling");
-      Index homoA = dftprop.getAttribute<Index>("homoA");
-      Index homoB = dftprop.getAttribute<Index>("homoB");
-      QMStateType hole = QMStateType(QMStateType::Hole);
-      if (dftprop.exists(hole.ToLongString())) {
-        const tools::Property& holes = dftprop.get(hole.ToLongString());
-        QMState stateA = GetElementFromMap(hole_levels_, segA.getType());
-        QMState stateB = GetElementFromMap(hole_levels_, segB.getType());
-        Index levelA = homoA - stateA.StateIdx();  // h1 is is homo;
-        Index levelB = homoB - stateB.StateIdx();
-        double J2 = GetDFTCouplingFromProp(holes, levelA, levelB);
-        if (J2 >= 0) {
-          qmp->setJeff2(J2, hole);
-          dft_h++;
-        }
+  // jobs which finished before the store existed or were merged from another
+  // job file only have their output in the job file
+  bool read_output =
+      status.empty() || complete_jobs > Index(stored_couplings.size());
+  if (!status.empty()) {
+    incomplete_jobs = Index(status.size()) - complete_jobs;
+  }
+  if (read_output) {
+    tools::Property xml;
+    xml.LoadFromXML(jobfile_);
+    for (tools::Property* job : xml.Select("jobs.job")) {
+      if (!job->exists("status")) {
+        throw std::runtime_error(
+            "Jobfile is malformed. <status> tag missing on job.");
       }
-      QMStateType electron = QMStateType(QMStateType::Electron);
-      if (dftprop.exists(electron.ToLongString())) {
-        const tools::Property& electrons = dftprop.get(electron.ToLongString());
-        QMState stateA = GetElementFromMap(electron_levels_, segA.getType());
-        QMState stateB = GetElementFromMap(electron_levels_, segB.getType());
-        Index levelA = homoA + 1 + stateA.StateIdx();  // e1 is lumo;
-        Index levelB = homoB + 1 + stateB.StateIdx();
-        double J2 = GetDFTCouplingFromProp(electrons, levelA, levelB);
-        if (J2 >= 0) {
-          qmp->setJeff2(J2, electron);
-          dft_e++;
-        }
+      bool complete = job->get("status").as<std::string>() == "COMPLETE";
+      auto stored_status = status.find(job->get("id").as<Index>());
+      if (stored_status != status.end()) {
+        complete = (stored_status->second == Job::COMPLETE);
+      } else if (!complete || !job->exists("output")) {
+        incomplete_jobs++;
       }
-    }
-    if (pair_property.exists("bsecoupling")) {
-      const tools::Property& bseprop = pair_property.get("bsecoupling");
-      QMStateType singlet = QMStateType(QMStateType::Singlet);
-      if (bseprop.exists(singlet.ToLongString())) {
-        const tools::Property& singlets = bseprop.get(singlet.ToLongString());
-        QMState stateA = GetElementFromMap(singlet_levels_, segA.getType());
-        QMState stateB = GetElementFromMap(singlet_levels_, segB.getType());
-        double J2 = GetBSECouplingFromProp(singlets, stateA, stateB);
-        if (J2 >= 0) {
-          qmp->setJeff2(J2, singlet);
-          bse_s++;
-        }
+      if (!complete || !job->exists("output")) {
+        continue;
       }
-      QMStateType triplet = QMStateType(QMStateType::Triplet);
-      if (bseprop.exists(triplet.ToLongString())) {
-        const tools::Property& triplets = bseprop.get(triplet.ToLongString());
-        QMState stateA = GetElementFromMap(triplet_levels_, segA.getType());
-        QMState stateB = GetElementFromMap(triplet_levels_, segB.getType());
-        double J2 = GetBSECouplingFromProp(triplets, stateA, stateB);
-        if (J2 >= 0) {
-          qmp->setJeff2(J2, triplet);
-          bse_t++;
-        }
+
+      // job file is stupid, because segment ids are only in input have to
+      // get them out l
+      std::vector<Index> id;
+      for (tools::Property* segment : job->Select("input.segment")) {
+        id.push_back(segment->getAttribute<Index>("id"));
+      }
+      if (id.size() != 2) {
+        throw std::runtime_error(
+            "Getting pair ids from jobfile failed, check jobfile.");
+      }
+      if (stored_couplings.count({id[0], id[1]})) {
+        continue;
       }
+      QMPair* qmp = FindHoppingPair(top, id[0], id[1], log);
+      if (qmp == nullptr) {
+        continue;
+      }
+      jobs_from_output++;
+      SetCouplings(*qmp, top.getSegment(id[0]), top.getSegment(id[1]),
+                   CouplingsFromOutput(id[0], id[1], job->get("output")),
+                   updated);
     }
   }
   XTP_LOG(Log::error, log) << "Pairs [total:updated(e,h,s,t)] "
-                           << number_of_pairs << ":(" << dft_e << "," << dft_h
-                           << "," << bse_s << "," << bse_t
-                           << ") Incomplete jobs: " << incomplete_jobs << "\n"
+                           << number_of_pairs << ":("
+                           << updated[QMStateType::Electron] << ","
+                           << updated[QMStateType::Hole] << ","
+                           << updated[QMStateType::Singlet] << ","
+                           << updated[QMStateType::Triplet]
+                           << ") Incomplete jobs: " << incomplete_jobs
+                           << " Jobs read from output: " << jobs_from_output
+                           << "\n"
                            << std::flush;
   std::cout << log;
   return;
 }
+
+QMPair* IQM::FindHoppingPair(Topology& top, Index idA, Index idB,
+                             Logger& log) const {
+  // segments which correspond to these ids
+  Segment& segA = top.getSegment(idA);
+  Segment& segB = top.getSegment(idB);
+  // pair that corresponds to the two segments
+  QMPair* qmp = top.NBList().FindPair(&segA, &segB);
+
+  if (qmp == nullptr) {  // there is no pair in the neighbor list with this
+                         // name
+    XTP_LOG(Log::error, log)
+        << "No pair " << idA << ":" << idB
+        << " found in the neighbor list. Ignoring" << std::flush;
+    return nullptr;
+  }
+  if (qmp->getType() != QMPair::PairType::Hopping) {
+    XTP_LOG(Log::error, log) << "WARNING Pair " << qmp->getId()
+                             << " is not of any of the "
+                                "Hopping type. Skipping pair"
+                             << std::flush;
+    return nullptr;
+  }
+  return qmp;
+}
+
+void IQM::SetCouplings(QMPair& qmp, const Segment& segA, const Segment& segB,
+                       const std::vector<CouplingStore::Coupling>& couplings,
+                       std::map<QMStateType::statetype, Index>& updated) {
+  for (const CouplingStore::Coupling& coupling : couplings) {
+    QMStateType type = QMStateType(QMStateType::statetype(coupling.type));
+    const std::map<std::string, QMState>& levels = LevelMap(type);
+    QMState stateA = GetElementFromMap(levels, segA.getType());
+    QMState stateB = GetElementFromMap(levels, segB.getType());
+    bool match = false;
+    if (type.isExciton()) {
+      match = QMState(type, Index(coupling.stateA), false) == stateA &&
+              QMState(type, Index(coupling.stateB), false) == stateB;
+    } else {
+      // the levels of holes and electrons are only given as offsets from the
+      // homo and lumo
+      match = coupling.stateA == std::int64_t(stateA.StateIdx()) &&
+              coupling.stateB == std::int64_t(stateB.StateIdx());
+    }
+    if (match) {
+      qmp.setJeff2(coupling.j * coupling.j, type);
+      updated[type.Type()]++;
+    }
+  }
+}
+
 }  // namespace xtp
 }  // namespace votca
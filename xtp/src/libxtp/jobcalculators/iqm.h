@@ -30,8 +30,10 @@
 
 // Local VOTCA includes
 #include "votca/xtp/bsecoupling.h"
+#include "votca/xtp/couplingstore.h"
 #include "votca/xtp/dftcoupling.h"
 #include "votca/xtp/gwbse.h"
+#include "votca/xtp/jobstore.h"
 #include "votca/xtp/orbitals.h"
 #include "votca/xtp/parallelxjobcalc.h"
 
@@ -59,10 +61,16 @@ class IQM final : public ParallelXJobCalc<std::vector<Job> > {
   void ParseSpecificOptions(const tools::Property& user_options);
 
  private:
-  double GetBSECouplingFromProp(const tools::Property& bseprop,
-                                const QMState& stateA, const QMState& stateB);
-  double GetDFTCouplingFromProp(const tools::Property& dftprop, Index stateA,
-                                Index stateB);
+  std::vector<CouplingStore::Coupling> CouplingsFromOutput(
+      Index segA, Index segB, const tools::Property& job_output) const;
+  void StoreCouplings(const std::vector<CouplingStore::Coupling>& couplings);
+  /// pair of the two segments in the neighbor list if it is a hopping pair
+  QMPair* FindHoppingPair(Topology& top, Index idA, Index idB,
+                          Logger& log) const;
+  void SetCouplings(QMPair& qmp, const Segment& segA, const Segment& segB,
+                    const std::vector<CouplingStore::Coupling>& couplings,
+                    std::map<QMStateType::statetype, Index>& updated);
+  const std::map<std::string, QMState>& LevelMap(QMStateType type) const;
   void SetJobToFailed(Job::JobResult& jres, Logger& pLog,
                       const std::string& errormessage);
   void WriteLoggerToFile(const std::string& logfile, Logger& logger);
@@ -98,6 +106,9 @@ class IQM final : public ParallelXJobCalc<std::vector<Job> > {
 
   std::map<std::string, QMState> hole_levels_;
   std::map<std::string, QMState> electron_levels_;
+
+  // serialises the threads writing to the coupling store
+  tools::Mutex couplingMutex_;
 };
 
 }  // namespace xtp
@@ -0,0 +1,283 @@
+/*
+ *            Copyright 2009-2021 The VOTCA Development Team
+ *                       (http://www.votca.org)
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Standard includes
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+// Third party includes
+#include <boost/filesystem.hpp>
+
+// Local VOTCA includes
+#include "votca/xtp/jobstore.h"
+
+namespace votca {
+namespace xtp {
+
+namespace {
+// identifies the record layout, has to change with it
+const char store_magic[] = "VOTCA-XTP-JOBSTORE-1";
+}  // namespace
+
+bool JobStore::Open(const std::string &job_file, const std::vector<Job> &jobs) {
+  job_file_ = job_file;
+  store_file_ = StoreName(job_file);
+  results_file_ = ResultsName(job_file);
+  njobs_ = Index(jobs.size());
+
+  bool created = false;
+  if (!IsCurrent(jobs)) {
+    Create(jobs);
+    created = true;
+  }
+  store_.close();
+  store_.open(store_file_, std::ios::in | std::ios::out | std::ios::binary);
+  if (!store_.is_open()) {
+    throw std::runtime_error("Bad file handle: " + store_file_);
+  }
+  return created;
+}
+
+bool JobStore::IsCurrent(const std::vector<Job> &jobs) const {
+  std::ifstream in(store_file_, std::ios::binary);
+  if (!in.is_open() || !boost::filesystem::exists(results_file_)) {
+    return false;
+  }
+  Header header;
+  in.read(reinterpret_cast<char *>(&header), sizeof(Header));
+  if (!in || std::strncmp(header.magic, store_magic, sizeof(header.magic)) ||
+      header.njobs != std::int64_t(jobs.size()) ||
+      header.job_file_time != FileTime(job_file_)) {
+    return false;
+  }
+  // the records have to belong to the same jobs in the same order
+  Record record;
+  for (const Job &job : jobs) {
+    in.read(reinterpret_cast<char *>(&record), sizeof(Record));
+    if (!in || record.id != std::int64_t(job.getId())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void JobStore::Create(const std::vector<Job> &jobs) {
+  std::ofstream out(store_file_, std::ios::out | std::ios::binary);
+  if (!out.is_open()) {
+    throw std::runtime_error("Bad file handle: " + store_file_);
+  }
+  Header header;
+  std::memset(&header, 0, sizeof(Header));
+  std::strncpy(header.magic, store_magic, sizeof(header.magic) - 1);
+  header.njobs = std::int64_t(jobs.size());
+  header.job_file_time = FileTime(job_file_);
+  header.cursor = 0;
+  out.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+  for (const Job &job : jobs) {
+    Record record = ToRecord(job);
+    out.write(reinterpret_cast<const char *>(&record), sizeof(Record));
+  }
+  if (!out) {
+    throw std::runtime_error("Could not write " + store_file_);
+  }
+
+  // the outputs already in the job file are not repeated
+  std::ofstream results(results_file_, std::ios::out);
+  if (!results.is_open()) {
+    throw std::runtime_error("Bad file handle: " + results_file_);
+  }
+  results << "<jobs>" << std::endl;
+}
+
+void JobStore::Read(Index index, Job &job) {
+  Record record;
+  store_.seekg(RecordOffset(index));
+  store_.read(reinterpret_cast<char *>(&record), sizeof(Record));
+  if (!store_ || record.id != std::int64_t(job.getId())) {
+    throw std::runtime_error("Job store out of sync (::id), abort.");
+  }
+  FromRecord(record, job);
+}
+
+void JobStore::WriteStatus(Index index, const Job &job) {
+  Record record = ToRecord(job);
+  store_.seekp(RecordOffset(index));
+  store_.write(reinterpret_cast<const char *>(&record), sizeof(Record));
+  // other processes read the record as soon as the lock is released
+  store_.flush();
+  if (!store_) {
+    throw std::runtime_error("Could not write " + store_file_);
+  }
+}
+
+void JobStore::WriteResult(Index index, const Job &job) {
+  if (job.hasOutput() || job.hasError()) {
+    std::ofstream results(results_file_, std::ios::out | std::ios::app);
+    if (!results.is_open()) {
+      throw std::runtime_error("Bad file handle: " + results_file_);
+    }
+    job.ToStream(results);
+  }
+  WriteStatus(index, job);
+}
+
+Index JobStore::Cursor() { return Index(ReadHeader().cursor); }
+
+void JobStore::AdvanceCursor(Index cursor) {
+  Header header = ReadHeader();
+  if (std::int64_t(cursor) > header.cursor) {
+    header.cursor = std::int64_t(cursor);
+    WriteHeader(header);
+  }
+}
+
+void JobStore::ReadAll(std::vector<Job> &jobs) {
+  if (Index(jobs.size()) != njobs_) {
+    throw std::runtime_error("Job store out of sync (::size), abort.");
+  }
+
+  // results in the order they were reported, a later attempt wins
+  std::string closed_results = results_file_ + ".xml";
+  {
+    std::ifstream in(results_file_);
+    std::ofstream out(closed_results);
+    if (!in.is_open() || !out.is_open()) {
+      throw std::runtime_error("Bad file handle: " + closed_results);
+    }
+    out << in.rdbuf() << "</jobs>" << std::endl;
+  }
+  std::vector<Job> results = LOAD_JOBS(closed_results);
+  std::remove(closed_results.c_str());
+
+  std::map<Index, Index> index_of_id;
+  for (Index i = 0; i < njobs_; i++) {
+    index_of_id[jobs[i].getId()] = i;
+  }
+  for (const Job &result : results) {
+    auto found = index_of_id.find(result.getId());
+    if (found == index_of_id.end()) {
+      throw std::runtime_error("Job store out of sync (::id), abort.");
+    }
+    jobs[found->second].UpdateFrom(result);
+  }
+
+  // the records are the current status
+  std::vector<Record> records(njobs_);
+  store_.seekg(RecordOffset(0));
+  store_.read(reinterpret_cast<char *>(records.data()),
+              std::streamsize(records.size() * sizeof(Record)));
+  if (!store_) {
+    throw std::runtime_error("Could not read " + store_file_);
+  }
+  for (Index i = 0; i < njobs_; i++) {
+    if (records[i].id != std::int64_t(jobs[i].getId())) {
+      throw std::runtime_error("Job store out of sync (::id), abort.");
+    }
+    FromRecord(records[i], jobs[i]);
+  }
+}
+
+void JobStore::JobFileWritten() {
+  Header header = ReadHeader();
+  header.job_file_time = FileTime(job_file_);
+  WriteHeader(header);
+}
+
+std::map<Index, Job::JobStatus> JobStore::ReadStatus(
+    const std::string &job_file) {
+  std::map<Index, Job::JobStatus> status;
+  std::ifstream in(StoreName(job_file), std::ios::binary);
+  if (!in.is_open()) {
+    return status;
+  }
+  Header header;
+  in.read(reinterpret_cast<char *>(&header), sizeof(Header));
+  if (!in || std::strncmp(header.magic, store_magic, sizeof(header.magic)) ||
+      header.job_file_time != FileTime(job_file)) {
+    return status;
+  }
+  std::vector<Record> records(header.njobs);
+  in.read(reinterpret_cast<char *>(records.data()),
+          std::streamsize(records.size() * sizeof(Record)));
+  if (!in) {
+    throw std::runtime_error("Could not read " + StoreName(job_file));
+  }
+  for (const Record &record : records) {
+    status[Index(record.id)] = Job::JobStatus(record.status);
+  }
+  return status;
+}
+
+JobStore::Header JobStore::ReadHeader() {
+  Header header;
+  store_.seekg(0);
+  store_.read(reinterpret_cast<char *>(&header), sizeof(Header));
+  if (!store_) {
+    throw std::runtime_error("Could not read " + store_file_);
+  }
+  return header;
+}
+
+void JobStore::WriteHeader(const Header &header) {
+  store_.seekp(0);
+  store_.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+  store_.flush();
+  if (!store_) {
+    throw std::runtime_error("Could not write " + store_file_);
+  }
+}
+
+JobStore::Record JobStore::ToRecord(const Job &job) {
+  Record record;
+  std::memset(&record, 0, sizeof(Record));
+  record.id = std::int64_t(job.getId());
+  record.status = std::int32_t(job.getStatus());
+  if (job.hasHost()) {
+    record.flags |= has_host;
+    std::strncpy(record.host, job.getHost().c_str(), sizeof(record.host) - 1);
+  }
+  if (job.hasTime()) {
+    record.flags |= has_time;
+    std::strncpy(record.time, job.getTime().c_str(), sizeof(record.time) - 1);
+  }
+  return record;
+}
+
+void JobStore::FromRecord(const Record &record, Job &job) {
+  job.setStatus(Job::JobStatus(record.status));
+  if (record.flags & has_host) {
+    job.setHost(std::string(record.host));
+  }
+  if (record.flags & has_time) {
+    job.setTime(std::string(record.time));
+  }
+}
+
+std::int64_t JobStore::FileTime(const std::string &file) {
+  return std::int64_t(boost::filesystem::last_write_time(file));
+}
+
+std::streamoff JobStore::RecordOffset(Index index) const {
+  return std::streamoff(sizeof(Header)) +
+         std::streamoff(index) * std::streamoff(sizeof(Record));
+}
+
+}  // namespace xtp
+}  // namespace votca
@@ -16,6 +16,7 @@
  */
 
 // Standard includes
+#include <exception>
 #include <locale>
 
 // Third party includes
@@ -51,6 +52,10 @@ void KMCCalculator::ParseCommonOptions(const tools::Property& options) {
   ratefile_ = options.get(".ratefile").as<std::string>();
 
   injectionmethod_ = options.get(".injectionmethod").as<std::string>();
+  replicas_ = options.get(".replicas").as<Index>();
+  if (replicas_ < 1) {
+    throw std::runtime_error("KMC needs at least one replica.");
+  }
 }
 
 void KMCCalculator::LoadGraph(Topology& top) {
@@ -92,7 +97,6 @@ void KMCCalculator::LoadGraph(Topology& top) {
     nodes_[pair->Seg2()->getId()].AddEventfromQmPair(*pair, nodes_,
                                                      rates.rate21);
   }
-  RandomVariable_.setMaxInt(Index(nodes_.size()));
   XTP_LOG(Log::error, log_) << "    Rates for " << nodes_.size()
                             << " sites are computed." << std::flush;
   WriteRatestoFile(ratefile_, nblist);
@@ -151,28 +155,27 @@ void KMCCalculator::LoadGraph(Topology& top) {
 
   for (auto& node : nodes_) {
     node.InitEscapeRate();
-    node.MakeHuffTree();
   }
   return;
 }
 
 void KMCCalculator::ResetForbiddenlist(
-    std::vector<GNode*>& forbiddenlist) const {
+    std::vector<Index>& forbiddenlist) const {
   forbiddenlist.clear();
   return;
 }
 
 void KMCCalculator::AddtoForbiddenlist(
-    GNode& node, std::vector<GNode*>& forbiddenlist) const {
-  forbiddenlist.push_back(&node);
+    Index node, std::vector<Index>& forbiddenlist) const {
+  forbiddenlist.push_back(node);
   return;
 }
 
 bool KMCCalculator::CheckForbidden(
-    const GNode& node, const std::vector<GNode*>& forbiddenlist) const {
+    Index node, const std::vector<Index>& forbiddenlist) const {
   bool forbidden = false;
-  for (const GNode* fnode : forbiddenlist) {
-    if (&node == fnode) {
+  for (Index fnode : forbiddenlist) {
+    if (node == fnode) {
       forbidden = true;
       break;
     }
@@ -181,12 +184,13 @@ bool KMCCalculator::CheckForbidden(
 }
 
 bool KMCCalculator::CheckSurrounded(
-    const GNode& node, const std::vector<GNode*>& forbiddendests) const {
+    Index node, const std::vector<Index>& forbiddendests) const {
   bool surrounded = true;
-  for (const auto& event : node.Events()) {
+  for (Index event = graph_.EventsBegin(node); event < graph_.EventsEnd(node);
+       event++) {
     bool thisevent_possible = true;
-    for (const GNode* fnode : forbiddendests) {
-      if (event.getDestination() == fnode) {
+    for (Index fnode : forbiddendests) {
+      if (graph_.Destination(event) == fnode) {
         thisevent_possible = false;
         break;
       }
@@ -199,62 +203,94 @@ bool KMCCalculator::CheckSurrounded(
   return surrounded;
 }
 
-void KMCCalculator::RandomlyCreateCharges() {
+void KMCCalculator::FreezeGraph() {
+  graph_ = KMCGraph(nodes_);
+  // the events of the nodes point into nodes_, they all go together
+  nodes_ = std::vector<GNode>();
+}
 
-  XTP_LOG(Log::error, log_) << "looking for injectable nodes..." << std::flush;
-  for (Index i = 0; i < numberofcarriers_; i++) {
-    Chargecarrier newCharge(i);
-    RandomlyAssignCarriertoSite(newCharge);
+std::vector<KMCReplica> KMCCalculator::CreateReplicas() const {
+  std::vector<KMCReplica> replicas;
+  for (Index r = 0; r < replicas_; r++) {
+    replicas.push_back(KMCReplica(r, seed_ + r, graph_));
+  }
+  return replicas;
+}
+
+void KMCCalculator::RunReplicas(
+    std::vector<KMCReplica>& replicas,
+    const std::function<void(KMCReplica&)>& run) const {
+  std::exception_ptr error = nullptr;
+#pragma omp parallel for schedule(dynamic)
+  for (Index r = 0; r < Index(replicas.size()); r++) {
+    try {
+      run(replicas[r]);
+    } catch (...) {
+#pragma omp critical
+      {
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
 
+void KMCCalculator::RandomlyCreateCharges(KMCReplica& replica) {
+
+  bool print = (replica.getId() == 0);
+  if (print) {
     XTP_LOG(Log::error, log_)
-        << "starting position for charge " << i << ": segment "
-        << newCharge.getCurrentNodeId() << std::flush;
-    carriers_.push_back(newCharge);
+        << "looking for injectable nodes..." << std::flush;
+  }
+  std::vector<Chargecarrier>& carriers = replica.Carriers();
+  for (Index i = 0; i < numberofcarriers_; i++) {
+    carriers.push_back(Chargecarrier(i));
+    RandomlyAssignCarriertoSite(replica, carriers.back());
+    if (print) {
+      XTP_LOG(Log::error, log_)
+          << "starting position for charge " << i << ": segment "
+          << carriers.back().getCurrentNodeId() << std::flush;
+    }
   }
+  replica.InitEscapeRates();
   return;
 }
 
-void KMCCalculator::RandomlyAssignCarriertoSite(Chargecarrier& Charge) {
+void KMCCalculator::RandomlyAssignCarriertoSite(KMCReplica& replica,
+                                                Chargecarrier& Charge) const {
   Index nodeId_guess = -1;
   do {
-    nodeId_guess = RandomVariable_.rand_uniform_int();
-  } while (nodes_[nodeId_guess].isOccupied() ||
-           nodes_[nodeId_guess].isInjectable() ==
+    nodeId_guess = replica.Random().rand_uniform_int();
+  } while (replica.isOccupied(nodeId_guess) ||
+           graph_.isInjectable(nodeId_guess) ==
                false);  // maybe already occupied? or maybe not injectable?
-  if (Charge.hasNode()) {
-    Charge.ReleaseNode();
-  }
-  Charge.settoNote(&nodes_[nodeId_guess]);
+  replica.PlaceCarrier(Charge, nodeId_guess);
 
   return;
 }
 
-double KMCCalculator::Promotetime(double cumulated_rate) {
+double KMCCalculator::Promotetime(KMCReplica& replica, double cumulated_rate) {
   double dt = 0;
-  double rand_u = 1 - RandomVariable_.rand_uniform();
+  double rand_u = 1 - replica.Random().rand_uniform();
   dt = -1 / cumulated_rate * std::log(rand_u);
   return dt;
 }
 
-const GLink& KMCCalculator::ChooseHoppingDest(const GNode& node) {
-  double u = 1 - RandomVariable_.rand_uniform();
-  return *(node.findHoppingDestination(u));
+Index KMCCalculator::ChooseHoppingDest(KMCReplica& replica, Index node) {
+  double u = replica.Random().rand_uniform();
+  return graph_.SampleEvent(node, u);
 }
 
-Chargecarrier* KMCCalculator::ChooseAffectedCarrier(double cumulated_rate) {
-  if (carriers_.size() == 1) {
-    return &carriers_[0];
+Chargecarrier* KMCCalculator::ChooseAffectedCarrier(KMCReplica& replica) {
+  if (replica.Carriers().size() == 1) {
+    return &replica.Carriers()[0];
   }
-  Chargecarrier* carrier = nullptr;
-  double u = 1 - RandomVariable_.rand_uniform();
-  for (Index i = 0; i < numberofcarriers_; i++) {
-    u -= carriers_[i].getCurrentEscapeRate() / cumulated_rate;
-    if (u <= 0 || i == numberofcarriers_ - 1) {
-      carrier = &carriers_[i];
-      break;
-    }
-  }
-  return carrier;
+  double u = 1 - replica.Random().rand_uniform();
+  return &replica.FindCarrier(u);
 }
 void KMCCalculator::WriteRatestoFile(std::string filename,
                                      const QMNBList& nblist) {
@@ -277,8 +313,8 @@ void KMCCalculator::WriteRatestoFile(std::string filename,
   ratefs.close();
 }
 
-void KMCCalculator::WriteOccupationtoFile(double simtime,
-                                          std::string filename) {
+void KMCCalculator::WriteOccupationtoFile(
+    const std::vector<KMCReplica>& replicas, std::string filename) {
   XTP_LOG(Log::error, log_)
       << "\nOccupations are written to " << filename << std::flush;
   fstream probs;
@@ -286,9 +322,18 @@ void KMCCalculator::WriteOccupationtoFile(double simtime,
   probs << "#SiteID, Occupation prob at "
         << temperature_ * tools::conv::hrt2ev / tools::conv::kB
         << "K for carrier:" << carriertype_.ToString() << endl;
-  for (const GNode& node : nodes_) {
-    double occupationprobability = node.OccupationTime() / simtime;
-    probs << node.getId() << "\t" << occupationprobability << endl;
+  // the replicas together have run for the sum of their times
+  double simtime = 0.0;
+  for (const KMCReplica& replica : replicas) {
+    simtime += replica.SimTime();
+  }
+  for (Index node = 0; node < graph_.size(); node++) {
+    double occupationtime = 0.0;
+    for (const KMCReplica& replica : replicas) {
+      occupationtime += replica.OccupationTime(node);
+    }
+    double occupationprobability = occupationtime / simtime;
+    probs << node << "\t" << occupationprobability << endl;
   }
   probs.close();
 }
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Local VOTCA includes
+#include "votca/xtp/kmcgraph.h"
+
+namespace votca {
+namespace xtp {
+
+KMCGraph::KMCGraph(const std::vector<GNode>& nodes) {
+  Index nevents = 0;
+  for (const GNode& node : nodes) {
+    nevents += Index(node.Events().size());
+  }
+  position_.reserve(nodes.size());
+  siteenergy_.reserve(nodes.size());
+  escaperate_.reserve(nodes.size());
+  injectable_.reserve(nodes.size());
+  event_begin_.reserve(nodes.size() + 1);
+  destination_.reserve(nevents);
+  rate_.reserve(nevents);
+  dr_.reserve(nevents);
+
+  event_begin_.push_back(0);
+  for (const GNode& node : nodes) {
+    if (node.getId() != size()) {
+      throw std::runtime_error("KMCGraph: node ids have to be their index");
+    }
+    double escaperate = 0.0;
+    for (const GLink& event : node.Events()) {
+      destination_.push_back(
+          event.isDecayEvent() ? -1 : event.getDestination()->getId());
+      rate_.push_back(event.getRate());
+      dr_.push_back(event.getDeltaR());
+      escaperate += event.getRate();
+    }
+    event_begin_.push_back(Index(destination_.size()));
+    position_.push_back(node.getPos());
+    siteenergy_.push_back(node.getSitenergy());
+    escaperate_.push_back(escaperate);
+    injectable_.push_back(node.isInjectable());
+  }
+
+  alias_probability_.resize(nevents);
+  alias_.resize(nevents);
+  for (Index i = 0; i < size(); i++) {
+    MakeAliasTable(i);
+  }
+}
+
+void KMCGraph::MakeAliasTable(Index node) {
+  Index begin = EventsBegin(node);
+  Index nevents = EventsEnd(node) - begin;
+  if (nevents == 0) {
+    return;
+  }
+  // Vose's variant, every column gets the probability to keep its own event
+  // and the event it hands the remainder to
+  std::vector<double> scaled(nevents);
+  std::vector<Index> small;
+  std::vector<Index> large;
+  for (Index k = 0; k < nevents; k++) {
+    scaled[k] = rate_[begin + k] * double(nevents) / escaperate_[node];
+    if (scaled[k] < 1.0) {
+      small.push_back(k);
+    } else {
+      large.push_back(k);
+    }
+  }
+  while (!small.empty() && !large.empty()) {
+    Index s = small.back();
+    small.pop_back();
+    Index l = large.back();
+    alias_probability_[begin + s] = scaled[s];
+    alias_[begin + s] = begin + l;
+    scaled[l] -= 1.0 - scaled[s];
+    if (scaled[l] < 1.0) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // whatever is left over is 1 up to rounding
+  for (Index k : large) {
+    alias_probability_[begin + k] = 1.0;
+    alias_[begin + k] = begin + k;
+  }
+  for (Index k : small) {
+    alias_probability_[begin + k] = 1.0;
+    alias_[begin + k] = begin + k;
+  }
+}
+
+}  // namespace xtp
+}  // namespace votca
@@ -17,6 +17,9 @@
  *
  */
 
+// Standard includes
+#include <algorithm>
+
 // Third party includes
 #include <boost/format.hpp>
 
@@ -121,30 +124,41 @@ void Vxc_Potential<Grid>::setXCfunctional(const std::string& functional) {
 }
 template <class Grid>
 typename Vxc_Potential<Grid>::XC_entry Vxc_Potential<Grid>::EvaluateXC(
-    double rho, double sigma) const {
+    const Eigen::VectorXd& rho, const Eigen::VectorXd& sigma) const {
 
+  const Index npoints = rho.size();
   Vxc_Potential<Grid>::XC_entry result;
+  result.f_xc = Eigen::VectorXd::Zero(npoints);
+  result.df_drho = Eigen::VectorXd::Zero(npoints);
+  result.df_dsigma = Eigen::VectorXd::Zero(npoints);
   switch (xfunc.info->family) {
     case XC_FAMILY_LDA:
-      xc_lda_exc_vxc(&xfunc, 1, &rho, &result.f_xc, &result.df_drho);
+      xc_lda_exc_vxc(&xfunc, npoints, rho.data(), result.f_xc.data(),
+                     result.df_drho.data());
       break;
     case XC_FAMILY_GGA:
     case XC_FAMILY_HYB_GGA:
-      xc_gga_exc_vxc(&xfunc, 1, &rho, &sigma, &result.f_xc, &result.df_drho,
-                     &result.df_dsigma);
+      xc_gga_exc_vxc(&xfunc, npoints, rho.data(), sigma.data(),
+                     result.f_xc.data(), result.df_drho.data(),
+                     result.df_dsigma.data());
       break;
   }
   if (use_separate_) {
     typename Vxc_Potential<Grid>::XC_entry temp;
+    temp.f_xc = Eigen::VectorXd::Zero(npoints);
+    temp.df_drho = Eigen::VectorXd::Zero(npoints);
+    temp.df_dsigma = Eigen::VectorXd::Zero(npoints);
     // via libxc correlation part only
     switch (cfunc.info->family) {
       case XC_FAMILY_LDA:
-        xc_lda_exc_vxc(&cfunc, 1, &rho, &temp.f_xc, &temp.df_drho);
+        xc_lda_exc_vxc(&cfunc, npoints, rho.data(), temp.f_xc.data(),
+                       temp.df_drho.data());
         break;
       case XC_FAMILY_GGA:
       case XC_FAMILY_HYB_GGA:
-        xc_gga_exc_vxc(&cfunc, 1, &rho, &sigma, &temp.f_xc, &temp.df_drho,
-                       &temp.df_dsigma);
+        xc_gga_exc_vxc(&cfunc, npoints, rho.data(), sigma.data(),
+                       temp.f_xc.data(), temp.df_drho.data(),
+                       temp.df_dsigma.data());
         break;
     }
 
@@ -169,7 +183,6 @@ Mat_p_Energy Vxc_Potential<Grid>::IntegrateVXC(
     if (!box.Matrixsize()) {
       continue;
     }
-    double EXC_box = 0.0;
     // two because we have to use the density matrix and its transpose
     const Eigen::MatrixXd DMAT_here = 2 * box.ReadFromBigMatrix(density_matrix);
     double cutoff =
@@ -177,30 +190,53 @@ Mat_p_Energy Vxc_Potential<Grid>::IntegrateVXC(
     if (DMAT_here.cwiseAbs2().maxCoeff() < cutoff) {
       continue;
     }
-    Eigen::MatrixXd Vxc_here =
-        Eigen::MatrixXd::Zero(DMAT_here.rows(), DMAT_here.cols());
-    const std::vector<Eigen::Vector3d>& points = box.getGridPoints();
-    const std::vector<double>& weights = box.getGridWeights();
+    // all gridpoints of the box at once, one row per point
+    GridBox::AOValuesOnGrid buffer;
+    const GridBox::AOValuesOnGrid& ao = AOValues(i, buffer);
+    const Eigen::Map<const Eigen::VectorXd> weights(box.getGridWeights().data(),
+                                                    box.size());
+    const Eigen::MatrixXd temp = ao.values * DMAT_here;
+    const Eigen::VectorXd rho =
+        0.5 * temp.cwiseProduct(ao.values).rowwise().sum();
+    Eigen::MatrixX3d rho_grad(box.size(), 3);
+    for (Index k = 0; k < 3; k++) {
+      rho_grad.col(k) = temp.cwiseProduct(ao.derivatives[k]).rowwise().sum();
+    }
 
-    // iterate over gridpoints
+    // skip points, where the density is very small
+    std::vector<Index> significant;
     for (Index p = 0; p < box.size(); p++) {
-      AOShell::AOValues ao = box.CalcAOValues(points[p]);
-      Eigen::VectorXd temp = ao.values.transpose() * DMAT_here;
-      double rho = 0.5 * temp.dot(ao.values);
-      const double weight = weights[p];
-      if (rho * weight < 1.e-20) {
-        continue;  // skip the rest, if density is very small
+      if (rho(p) * weights(p) >= 1.e-20) {
+        significant.push_back(p);
       }
-      const Eigen::Vector3d rho_grad = temp.transpose() * ao.derivatives;
+    }
+    if (significant.empty()) {
+      continue;
+    }
+    const Index nsignificant = Index(significant.size());
+    Eigen::VectorXd rho_sig(nsignificant);
+    Eigen::VectorXd sigma_sig(nsignificant);
+    for (Index s = 0; s < nsignificant; s++) {
+      rho_sig(s) = rho(significant[s]);
+      sigma_sig(s) = rho_grad.row(significant[s]).squaredNorm();
+    }
+    typename Vxc_Potential<Grid>::XC_entry xc = EvaluateXC(rho_sig, sigma_sig);
 
-      typename Vxc_Potential<Grid>::XC_entry xc =
-          EvaluateXC(rho, rho_grad.squaredNorm());
-      EXC_box += weight * rho * xc.f_xc;
-      auto grad = ao.derivatives * rho_grad;
-      temp.noalias() =
-          weight * (0.5 * xc.df_drho * ao.values + 2.0 * xc.df_dsigma * grad);
-      Vxc_here.noalias() += temp * ao.values.transpose();
+    // prefactors of the functions and their derivatives for every point
+    double EXC_box = 0.0;
+    Eigen::VectorXd value_factor = Eigen::VectorXd::Zero(box.size());
+    Eigen::MatrixX3d grad_factor = Eigen::MatrixX3d::Zero(box.size(), 3);
+    for (Index s = 0; s < nsignificant; s++) {
+      const Index p = significant[s];
+      EXC_box += weights(p) * rho(p) * xc.f_xc(s);
+      value_factor(p) = weights(p) * 0.5 * xc.df_drho(s);
+      grad_factor.row(p) = weights(p) * 2.0 * xc.df_dsigma(s) * rho_grad.row(p);
     }
+    Eigen::MatrixXd weighted = value_factor.asDiagonal() * ao.values;
+    for (Index k = 0; k < 3; k++) {
+      weighted.noalias() += grad_factor.col(k).asDiagonal() * ao.derivatives[k];
+    }
+    const Eigen::MatrixXd Vxc_here = weighted.transpose() * ao.values;
     box.AddtoBigMatrix(vxc.matrix(), Vxc_here);
     vxc.energy() += EXC_box;
   }
@@ -208,6 +244,82 @@ Mat_p_Energy Vxc_Potential<Grid>::IntegrateVXC(
   return Mat_p_Energy(vxc.energy(), vxc.matrix() + vxc.matrix().transpose());
 }
 
+template <class Grid>
+void Vxc_Potential<Grid>::SetupAOCache(double memory_mb,
+                                       bool single_precision) {
+  ao_cache_ = std::vector<CachedAOValues>(grid_.getBoxesSize());
+  const double bytes =
+      single_precision ? double(sizeof(float)) : double(sizeof(double));
+  // values and three derivatives per point and function
+  double budget = memory_mb * 1e6;
+  for (Index i = 0; i < grid_.getBoxesSize(); ++i) {
+    const GridBox& box = grid_[i];
+    double size = 4 * bytes * double(box.size()) * double(box.Matrixsize());
+    if (size > 0 && size <= budget) {
+      ao_cache_[i].cached = true;
+      budget -= size;
+    }
+  }
+
+#pragma omp parallel for schedule(guided)
+  for (Index i = 0; i < grid_.getBoxesSize(); ++i) {
+    CachedAOValues& entry = ao_cache_[i];
+    if (!entry.cached) {
+      continue;
+    }
+    GridBox::AOValuesOnGrid ao = grid_[i].CalcAOValuesOnGrid();
+    if (single_precision) {
+      entry.values_single = ao.values.cast<float>();
+      for (Index k = 0; k < 3; k++) {
+        entry.derivatives_single[k] = ao.derivatives[k].cast<float>();
+      }
+    } else {
+      entry.values = std::move(ao);
+    }
+  }
+}
+
+template <class Grid>
+double Vxc_Potential<Grid>::AOCacheMB() const {
+  double bytes = 0.0;
+  for (const CachedAOValues& entry : ao_cache_) {
+    bytes += double(sizeof(double)) * double(entry.values.values.size());
+    bytes += double(sizeof(float)) * double(entry.values_single.size());
+    for (Index k = 0; k < 3; k++) {
+      bytes +=
+          double(sizeof(double)) * double(entry.values.derivatives[k].size());
+      bytes +=
+          double(sizeof(float)) * double(entry.derivatives_single[k].size());
+    }
+  }
+  return bytes * 1e-6;
+}
+
+template <class Grid>
+Index Vxc_Potential<Grid>::CachedBoxes() const {
+  return Index(
+      std::count_if(ao_cache_.begin(), ao_cache_.end(),
+                    [](const CachedAOValues& entry) { return entry.cached; }));
+}
+
+template <class Grid>
+const GridBox::AOValuesOnGrid& Vxc_Potential<Grid>::AOValues(
+    Index box, GridBox::AOValuesOnGrid& buffer) const {
+  if (ao_cache_.empty() || !ao_cache_[box].cached) {
+    buffer = grid_[box].CalcAOValuesOnGrid();
+    return buffer;
+  }
+  const CachedAOValues& entry = ao_cache_[box];
+  if (entry.values_single.size() == 0) {
+    return entry.values;
+  }
+  buffer.values = entry.values_single.template cast<double>();
+  for (Index k = 0; k < 3; k++) {
+    buffer.derivatives[k] = entry.derivatives_single[k].template cast<double>();
+  }
+  return buffer;
+}
+
 template class Vxc_Potential<Vxc_Grid>;
 
 }  // namespace xtp
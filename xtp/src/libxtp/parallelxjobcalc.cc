@@ -46,6 +46,7 @@ bool ParallelXJobCalc<JobContainer>::Evaluate(const Topology &top) {
   master->getLogger().setPreface(Log::warning, "\nMST WAR");
   master->getLogger().setPreface(Log::debug, "\nMST DBG");
   progObs_->InitFromProgFile(progFile, *(master.get()));
+  progObs_->OrderJobs([&](const Job &job) { return JobCost(top, job); });
 
   // CREATE + EXECUTE THREADS (XJOB HANDLERS)
   std::vector<std::unique_ptr<JobOperator>> jobOps;
@@ -63,6 +64,8 @@ bool ParallelXJobCalc<JobContainer>::Evaluate(const Topology &top) {
     std::cout << std::endl;  // REQUIRED FOR PROGRESS BAR IN OBSERVER
   }
 
+  idle_cores_ = 0;
+  busy_operators_ = nThreads_;
   for (Index id = 0; id < nThreads_; id++) {
     jobOps[id]->Start();
   }
@@ -79,25 +82,67 @@ bool ParallelXJobCalc<JobContainer>::Evaluate(const Topology &top) {
 
   jobOps.clear();
 
-  // SYNC REMAINING COMPLETE JOBS
-  progObs_->SyncWithProgFile(*(master.get()));
+  // WRITE THE PROGRESS OF ALL PROCESSES TO THE JOB FILE
+  progObs_->ExportToProgFile(*(master.get()));
   libint2::finalize();
   return true;
 }
 
 template <typename JobContainer>
 void ParallelXJobCalc<JobContainer>::JobOperator::Run() {
-  OPENMP::setMaxThreads(openmp_threads_);
+  Index cores = openmp_threads_;
   while (true) {
     Job *job = master_.progObs_->RequestNextJob(*this);
 
     if (job == nullptr) {
       break;
     } else {
+      Index extra_cores = master_.ClaimIdleCores();
+      if (extra_cores > 0) {
+        cores += extra_cores;
+        XTP_LOG(Log::error, getLogger())
+            << "Using " << cores << " openmp threads" << std::flush;
+      }
+      OPENMP::setMaxThreads(cores);
       Result res = this->master_.EvalJob(top_, *job, *this);
       this->master_.progObs_->ReportJobDone(*job, res, *this);
     }
   }
+  master_.ReleaseCores(cores);
+}
+
+template <typename JobContainer>
+Index ParallelXJobCalc<JobContainer>::ClaimIdleCores() {
+  coreMutex_.Lock();
+  // share the idle cores among the operators which are still busy
+  Index cores = (idle_cores_ + busy_operators_ - 1) / busy_operators_;
+  idle_cores_ -= cores;
+  coreMutex_.Unlock();
+  return cores;
+}
+
+template <typename JobContainer>
+void ParallelXJobCalc<JobContainer>::ReleaseCores(Index cores) {
+  coreMutex_.Lock();
+  busy_operators_--;
+  idle_cores_ += cores;
+  coreMutex_.Unlock();
+}
+
+template <typename JobContainer>
+double ParallelXJobCalc<JobContainer>::JobCost(const Topology &top,
+                                               const Job &job) const {
+  double atoms = 0.0;
+  for (const tools::Property *segment : job.getInput().Select("segment")) {
+    if (!segment->hasAttribute("id")) {
+      continue;
+    }
+    Index id = segment->getAttribute<Index>("id");
+    if (id >= 0 && id < Index(top.Segments().size())) {
+      atoms += double(top.getSegment(id).size());
+    }
+  }
+  return atoms;
 }
 
 template <typename JobContainer>
@@ -36,6 +36,10 @@ void PolarRegion::Initialize(const tools::Property& prop) {
   deltaD_ = prop.get("tolerance_dipole").as<double>();
   deltaE_ = prop.get("tolerance_energy").as<double>();
   exp_damp_ = prop.get("exp_damp").as<double>();
+  use_tree_ = (prop.get("dipole_operator").as<std::string>() == "tree");
+  opening_angle_ = prop.get("opening_angle").as<double>();
+  thole_cache_mb_ = prop.get("thole_cache").as<double>();
+  thole_cache_cutoff_ = prop.get("thole_cache_cutoff").as<double>();
 }
 
 bool PolarRegion::Converged() const {
@@ -192,6 +196,19 @@ Eigen::VectorXd PolarRegion::CalcInducedDipolesViaPCG(
   }
   eeInteractor interactor(exp_damp_);
   DipoleDipoleInteraction A(interactor, segments_);
+  if (use_tree_) {
+    A.UseTree(opening_angle_);
+  } else if (thole_cache_mb_ > 0) {
+    if (!thole_cache_) {
+      thole_cache_ = std::make_unique<TholeBlockCache>(
+          interactor, A.Sites(), thole_cache_cutoff_, thole_cache_mb_);
+      XTP_LOG(Log::error, log_)
+          << TimeStamp() << " Cached " << thole_cache_->NumberOfBlocks()
+          << " Thole blocks within " << thole_cache_->Cutoff() << " bohr ("
+          << thole_cache_->MemoryMB() << " MB)" << std::flush;
+    }
+    A.UseBlockCache(*thole_cache_);
+  }
   Eigen::ConjugateGradient<DipoleDipoleInteraction, Eigen::Lower | Eigen::Upper,
                            Eigen::DiagonalPreconditioner<double>>
       cg;
@@ -356,6 +373,7 @@ void PolarRegion::WriteToCpt(CheckpointWriter& w) const {
 
 void PolarRegion::ReadFromCpt(CheckpointReader& r) {
   MMRegion<PolarSegment>::ReadFromCpt(r);
+  thole_cache_ = nullptr;
 }
 
 }  // namespace xtp
@@ -20,7 +20,9 @@
 /// 77795ea591b29e664153f9404c8655ba28dc14e9
 
 // Standard includes
+#include <algorithm>
 #include <fstream>
+#include <numeric>
 #include <unistd.h>
 
 // Third party includes
@@ -81,7 +83,7 @@ typename ProgObserver<JobContainer>::Job *
   }
 
   if (!thread.isMaverick() && jobToProc != nullptr) {
-    Index idx = jobToProc->getId();
+    Index idx = rank_[Index(jobToProc - &*jobs_.begin())];
     Index frac = (jobs_.size() >= 10) ? 10 : jobs_.size();
     Index rounded = Index(double(jobs_.size()) / double(frac)) * frac;
     Index tenth = rounded / frac;
@@ -105,6 +107,10 @@ void ProgObserver<JobContainer>::ReportJobDone(Job &job, Result &res,
   job.UpdateFromResult(res);
   job.setTime(GenerateTime());
   job.setHost(GenerateHost());
+  // only this job's record and the end of the results are written
+  this->LockProgFile(thread);
+  store_.WriteResult(Index(&job - &*jobs_.begin()), job);
+  this->ReleaseProgFile(thread);
   // PRINT PROGRESS BAR
   jobsReported_ += 1;
   if (!thread.isMaverick()) {
@@ -134,60 +140,81 @@ void ProgObserver<JobContainer>::SyncWithProgFile(QMThread &thread) {
   // INTERPROCESS FILE LOCKING (THREAD LOCK IN ::RequestNextJob)
   this->LockProgFile(thread);
 
-  std::string progFile = progFile_;
-  std::string progBackFile = progFile_ + "~";
-
-  // LOAD EXTERNAL JOBS FROM SHARED XML & UPDATE INTERNAL JOBS
-  XTP_LOG(Log::info, thread.getLogger())
-      << "Update internal structures from job file" << std::flush;
-  JobContainer jobs_ext = LOAD_JOBS(progFile);
-  UPDATE_JOBS(jobs_ext, jobs_, GenerateHost());
-
-  // GENERATE BACK-UP FOR SHARED XML
-  XTP_LOG(Log::info, thread.getLogger())
-      << "Create job-file back-up" << std::flush;
-  WRITE_JOBS(jobs_, progBackFile);
-
-  // ASSIGN NEW JOBS IF AVAILABLE
+  // ASSIGN NEW JOBS IF AVAILABLE, ONLY THE RECORDS OF THE VISITED JOBS ARE
+  // READ FROM THE JOB STORE
   XTP_LOG(Log::error, thread.getLogger())
       << "Assign jobs from stack" << std::flush;
   jobsToProc_.clear();
 
+  // without restart patterns, jobs in front of the shared cursor have all
+  // been claimed already
+  if (!restartMode_) {
+    metapos_ = std::max(metapos_, store_.Cursor());
+  }
+
   Index cacheSize = cacheSize_;
   while (int(jobsToProc_.size()) < cacheSize) {
-    if (metajit_ == jobs_.end() || startJobsCount_ == maxJobs_) {
+    if (metapos_ == Index(order_.size()) || startJobsCount_ == maxJobs_) {
       break;
     }
 
+    Index index = order_[metapos_];
+    Job &job = jobs_[index];
+    store_.Read(index, job);
     bool startJob = false;
 
     // Start if job available or restart patterns matched
-    if ((metajit_->isAvailable()) ||
-        (restartMode_ && restart_stats_.count(metajit_->getStatusStr())) ||
-        (restartMode_ && restart_hosts_.count(metajit_->getHost()))) {
+    if ((job.isAvailable()) ||
+        (restartMode_ && restart_stats_.count(job.getStatusStr())) ||
+        (restartMode_ && restart_hosts_.count(job.getHost()))) {
       startJob = true;
     }
 
     if (startJob) {
-      metajit_->Reset();
-      metajit_->setStatus("ASSIGNED");
-      metajit_->setHost(GenerateHost());
-      metajit_->setTime(GenerateTime());
-      jobsToProc_.push_back(&*metajit_);
+      job.Reset();
+      job.setStatus("ASSIGNED");
+      job.setHost(GenerateHost());
+      job.setTime(GenerateTime());
+      store_.WriteStatus(index, job);
+      jobsToProc_.push_back(&job);
       startJobsCount_ += 1;
     }
 
-    ++metajit_;
+    ++metapos_;
+  }
+  if (!restartMode_) {
+    store_.AdvanceCursor(metapos_);
   }
-
-  // UPDATE PROGRESS STATUS FILE
-  WRITE_JOBS(jobs_, progFile);
 
   // RELEASE PROGRESS STATUS FILE
   this->ReleaseProgFile(thread);
   return;
 }
 
+template <typename JobContainer>
+void ProgObserver<JobContainer>::ExportToProgFile(QMThread &thread) {
+
+  this->LockProgFile(thread);
+
+  // THE JOB STORE HOLDS THE PROGRESS OF ALL PROCESSES
+  XTP_LOG(Log::info, thread.getLogger())
+      << "Update internal structures from job store" << std::flush;
+  store_.ReadAll(jobs_);
+
+  // GENERATE BACK-UP FOR SHARED XML
+  XTP_LOG(Log::info, thread.getLogger())
+      << "Create job-file back-up" << std::flush;
+  WRITE_JOBS(jobs_, progFile_ + "~");
+
+  // UPDATE PROGRESS STATUS FILE
+  XTP_LOG(Log::error, thread.getLogger())
+      << "Export jobs to " << progFile_ << std::flush;
+  WRITE_JOBS(jobs_, progFile_);
+  store_.JobFileWritten();
+
+  this->ReleaseProgFile(thread);
+}
+
 template <typename JobContainer>
 void ProgObserver<JobContainer>::LockProgFile(QMThread &thread) {
   flock_ = std::unique_ptr<boost::interprocess::file_lock>(
@@ -279,8 +306,18 @@ void ProgObserver<JobContainer>::InitFromProgFile(std::string progFile,
 
   // ... Load new, set availability bool
   jobs_ = LOAD_JOBS(progFile);
-  metajit_ = jobs_.begin();
-  WRITE_JOBS(jobs_, progFile + "~");
+  order_.resize(jobs_.size());
+  std::iota(order_.begin(), order_.end(), 0);
+  rank_ = order_;
+  metapos_ = 0;
+  if (store_.Open(progFile, jobs_)) {
+    XTP_LOG(Log::error, thread.getLogger())
+        << "Created job store " << JobStore::StoreName(progFile) << std::flush;
+    WRITE_JOBS(jobs_, progFile + "~");
+  } else {
+    XTP_LOG(Log::error, thread.getLogger())
+        << "Joined job store " << JobStore::StoreName(progFile) << std::flush;
+  }
   XTP_LOG(Log::error, thread.getLogger())
       << "Registered " << jobs_.size() << " jobs." << std::flush;
   if (jobs_.size() > 0) {
@@ -310,6 +347,22 @@ void ProgObserver<JobContainer>::InitFromProgFile(std::string progFile,
   return;
 }
 
+template <typename JobContainer>
+void ProgObserver<JobContainer>::OrderJobs(
+    const std::function<double(const Job &)> &cost) {
+  std::vector<double> costs;
+  costs.reserve(jobs_.size());
+  for (const Job &job : jobs_) {
+    costs.push_back(cost(job));
+  }
+  std::stable_sort(order_.begin(), order_.end(),
+                   [&costs](Index a, Index b) { return costs[a] > costs[b]; });
+  for (Index pos = 0; pos < Index(order_.size()); pos++) {
+    rank_[order_[pos]] = pos;
+  }
+  metapos_ = 0;
+}
+
 // REGISTER
 template class ProgObserver<std::vector<Job> >;
 
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Standard includes
+#include <algorithm>
+#include <cmath>
+
+// Local VOTCA includes
+#include "votca/xtp/segmentcells.h"
+
+namespace votca {
+namespace xtp {
+
+SegmentCells::SegmentCells(const Eigen::Matrix3d& box,
+                           const std::vector<Segment*>& segs, double range) {
+  // more cells than segments do not pay off
+  double maxcells = std::max(1.0, 2.0 * std::cbrt(double(segs.size())));
+  double volume = std::abs(box.determinant());
+  for (Index d = 0; d < 3; d++) {
+    // distance between the faces spanned by the other two box vectors
+    double width =
+        volume / box.col((d + 1) % 3).cross(box.col((d + 2) % 3)).norm();
+    ncells_[d] = std::max(Index(1), Index(std::min(width / range, maxcells)));
+  }
+  cells_.resize(ncells_[0] * ncells_[1] * ncells_[2]);
+
+  Eigen::Matrix3d inverse = box.inverse();
+  cell_of_segment_.reserve(segs.size());
+  for (Index i = 0; i < Index(segs.size()); i++) {
+    Eigen::Vector3d frac = inverse * segs[i]->getPos();
+    std::array<Index, 3> cell;
+    for (Index d = 0; d < 3; d++) {
+      double wrapped = frac[d] - std::floor(frac[d]);
+      cell[d] = std::min(Index(wrapped * double(ncells_[d])), ncells_[d] - 1);
+    }
+    Index index = CellIndex(cell);
+    cells_[index].push_back(i);
+    cell_of_segment_.push_back(index);
+  }
+}
+
+std::vector<Index> SegmentCells::Neighbours(Index cell) const {
+  std::array<Index, 3> c = {cell / (ncells_[1] * ncells_[2]),
+                            (cell / ncells_[2]) % ncells_[1],
+                            cell % ncells_[2]};
+  std::vector<Index> neighbours;
+  for (Index x = -1; x <= 1; x++) {
+    for (Index y = -1; y <= 1; y++) {
+      for (Index z = -1; z <= 1; z++) {
+        std::array<Index, 3> n = {Wrap(c[0] + x, 0), Wrap(c[1] + y, 1),
+                                  Wrap(c[2] + z, 2)};
+        neighbours.push_back(CellIndex(n));
+      }
+    }
+  }
+  // with fewer than three cells in a direction, neighbours coincide
+  std::sort(neighbours.begin(), neighbours.end());
+  neighbours.erase(std::unique(neighbours.begin(), neighbours.end()),
+                   neighbours.end());
+  return neighbours;
+}
+
+}  // namespace xtp
+}  // namespace votca
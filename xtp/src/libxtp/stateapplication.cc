@@ -59,6 +59,12 @@ void StateApplication::execute() {
   // STATESAVER & PROGRESS OBSERVER
   std::string statefile = OptionsMap()["file"].as<std::string>();
   StateSaver statsav(statefile);
+  // one handle for all frames, read only runs can share the file with other
+  // processes, a writing run keeps the exclusive lock until all frames are
+  // evaluated
+  bool write = save && savetoStateFile();
+  statsav.BeginSession(write ? CheckpointAccessLevel::MODIFY
+                             : CheckpointAccessLevel::READ);
   std::vector<Index> frames = statsav.getFrames();
   if (frames.empty()) {
     throw std::runtime_error("Statefile " + statefile + " not found.");
@@ -88,12 +94,13 @@ void StateApplication::execute() {
     std::cout << "Evaluating frame " << frames[i] << std::endl;
     Topology top = statsav.ReadFrame(frames[i]);
     EvaluateFrame(top);
-    if (save && savetoStateFile()) {
+    if (write) {
       statsav.WriteFrame(top);
     } else {
       std::cout << "Changes have not been written to state file." << std::endl;
     }
   }
+  statsav.EndSession();
 }
 
 }  // namespace xtp
@@ -17,6 +17,10 @@
  *
  */
 
+// Standard includes
+#include <algorithm>
+#include <iostream>
+
 // Third party includes
 #include <boost/interprocess/sync/file_lock.hpp>
 
@@ -30,8 +34,77 @@
 namespace votca {
 namespace xtp {
 
-std::vector<Index> StateSaver::getFrames() const {
-  CheckpointFile cpf(hdf5file_, CheckpointAccessLevel::READ);
+StateSaver::~StateSaver() {
+  if (session_) {
+    try {
+      EndSession();
+    } catch (std::runtime_error& error) {
+      std::cerr << "Could not close statefile " << hdf5file_ << ": "
+                << error.what() << std::endl;
+    }
+  }
+}
+
+void StateSaver::BeginSession(CheckpointAccessLevel access) {
+  if (session_) {
+    throw std::runtime_error("Statefile " + hdf5file_ +
+                             " has already an open session.");
+  }
+  // only CREATE sessions may touch the disk before the file is known to exist
+  if (access == CheckpointAccessLevel::CREATE) {
+    std::cout << "Creating statefile " << hdf5file_ << std::endl;
+    CheckpointFile cpf(hdf5file_, CheckpointAccessLevel::CREATE);
+  } else if (!tools::filesystem::FileExists(hdf5file_)) {
+    throw std::runtime_error("Statefile " + hdf5file_ + " does not exist.");
+  }
+
+  session_lock_ =
+      std::make_unique<boost::interprocess::file_lock>(hdf5file_.c_str());
+  if (access == CheckpointAccessLevel::READ) {
+    // readers only exclude writers
+    session_lock_->lock_sharable();
+    session_ = std::make_unique<CheckpointFile>(hdf5file_,
+                                                CheckpointAccessLevel::READ);
+  } else {
+    session_lock_->lock();
+    session_ = std::make_unique<CheckpointFile>(hdf5file_,
+                                                CheckpointAccessLevel::MODIFY);
+  }
+  session_access_ = access;
+  session_frames_ = ReadFrames(*session_);
+  session_frames_changed_ = false;
+}
+
+void StateSaver::EndSession() {
+  if (!session_) {
+    return;
+  }
+  if (session_frames_changed_) {
+    WriteFrames(*session_, session_frames_);
+    session_frames_changed_ = false;
+  }
+  // closes the file before other processes may open it
+  session_ = nullptr;
+  if (session_access_ == CheckpointAccessLevel::READ) {
+    session_lock_->unlock_sharable();
+  } else {
+    session_lock_->unlock();
+  }
+  session_lock_ = nullptr;
+}
+
+void StateSaver::WriteFrames(CheckpointFile& cpf,
+                             const std::vector<Index>& frames) const {
+  // an existing dataset keeps its old size, so a longer index is rewritten
+  H5::H5File handle = cpf.getHandle();
+  if (H5Lexists(handle.getId(), "frames", H5P_DEFAULT) > 0) {
+    handle.unlink("frames");
+  }
+  CheckpointWriter w = cpf.getWriter();
+  w(frames, "frames");
+}
+
+std::vector<Index> StateSaver::ReadFrames(CheckpointFile& cpf) const {
   CheckpointReader r = cpf.getReader();
   std::vector<Index> frames = std::vector<Index>{};
   try {
@@ -41,27 +114,57 @@ std::vector<Index> StateSaver::getFrames() const {
   }
   return frames;
 }
+
+std::vector<Index> StateSaver::getFrames() const {
+  if (session_) {
+    return session_frames_;
+  }
+  CheckpointFile cpf(hdf5file_, CheckpointAccessLevel::READ);
+  return ReadFrames(cpf);
+}
+
 void StateSaver::WriteFrame(const Topology& top) {
+  if (session_) {
+    if (session_access_ == CheckpointAccessLevel::READ) {
+      throw std::runtime_error("Statefile " + hdf5file_ +
+                               " is opened read only.");
+    }
+    if (!TopStepisinFrames(top.getStep())) {
+      session_frames_.push_back(top.getStep());
+      session_frames_changed_ = true;
+      std::cout << "Frame with id " << top.getStep() << " was not in statefile "
+                << hdf5file_ << " ,adding it now." << std::endl;
+    }
+    CheckpointWriter w =
+        session_->getWriter("/frame_" + std::to_string(top.getStep()));
+    top.WriteToCpt(w);
+    std::cout << "Wrote MD topology (step = " << top.getStep()
+              << ", time = " << top.getTime() << ") to " << hdf5file_
+              << std::endl;
+    return;
+  }
+
   if (!tools::filesystem::FileExists(hdf5file_)) {
     std::cout << "Creating statefile " << hdf5file_ << std::endl;
     CheckpointFile cpf(hdf5file_, CheckpointAccessLevel::CREATE);
   }
   boost::interprocess::file_lock flock(hdf5file_.c_str());
   flock.lock();
-  if (!TopStepisinFrames(top.getStep())) {
-    std::vector<Index> frames = this->getFrames();
-    frames.push_back(top.getStep());
+  {
+    // one handle for the frame index and the topology
     CheckpointFile cpf(hdf5file_, CheckpointAccessLevel::MODIFY);
-    CheckpointWriter w = cpf.getWriter();
-    w(frames, "frames");
-    std::cout << "Frame with id " << top.getStep() << " was not in statefile "
-              << hdf5file_ << " ,adding it now." << std::endl;
+    std::vector<Index> frames = ReadFrames(cpf);
+    if (std::find(frames.begin(), frames.end(), top.getStep()) ==
+        frames.end()) {
+      frames.push_back(top.getStep());
+      WriteFrames(cpf, frames);
+      std::cout << "Frame with id " << top.getStep() << " was not in statefile "
+                << hdf5file_ << " ,adding it now." << std::endl;
+    }
+    CheckpointWriter w =
+        cpf.getWriter("/frame_" + std::to_string(top.getStep()));
+    top.WriteToCpt(w);
   }
-
-  CheckpointFile cpf(hdf5file_, CheckpointAccessLevel::MODIFY);
-  CheckpointWriter w = cpf.getWriter("/frame_" + std::to_string(top.getStep()));
-  top.WriteToCpt(w);
-
   flock.unlock();
 
   std::cout << "Wrote MD topology (step = " << top.getStep()
@@ -74,29 +177,48 @@ void StateSaver::WriteFrame(const Topology& top) {
 }
 
 Topology StateSaver::ReadFrame(Index frameid) const {
-  if (!tools::filesystem::FileExists(hdf5file_)) {
-    throw std::runtime_error("Statefile " + hdf5file_ + " does not exist.");
-  }
   std::cout << "Import MD Topology (i.e. frame " << frameid << ")"
             << " from " << hdf5file_ << std::endl;
   std::cout << "...";
-  boost::interprocess::file_lock flock(hdf5file_.c_str());
-  flock.lock();
-  if (!TopStepisinFrames(frameid)) {
-    throw std::runtime_error("Frame with id " + std::to_string(frameid) +
-                             " is not in statefile.");
+  Topology top;
+  if (session_) {
+    if (!TopStepisinFrames(frameid)) {
+      throw std::runtime_error("Frame with id " + std::to_string(frameid) +
+                               " is not in statefile.");
+    }
+    CheckpointReader r =
+        session_->getReader("/frame_" + std::to_string(frameid));
+    top.ReadFromCpt(r);
+    std::cout << ". " << std::endl;
+    return top;
   }
 
-  CheckpointFile cpf(hdf5file_, CheckpointAccessLevel::READ);
-  CheckpointReader r = cpf.getReader("/frame_" + std::to_string(frameid));
-  Topology top;
-  top.ReadFromCpt(r);
-  flock.unlock();
+  if (!tools::filesystem::FileExists(hdf5file_)) {
+    throw std::runtime_error("Statefile " + hdf5file_ + " does not exist.");
+  }
+  boost::interprocess::file_lock flock(hdf5file_.c_str());
+  // readers only exclude writers
+  flock.lock_sharable();
+  {
+    CheckpointFile cpf(hdf5file_, CheckpointAccessLevel::READ);
+    std::vector<Index> frames = ReadFrames(cpf);
+    if (std::find(frames.begin(), frames.end(), frameid) == frames.end()) {
+      throw std::runtime_error("Frame with id " + std::to_string(frameid) +
+                               " is not in statefile.");
+    }
+    CheckpointReader r = cpf.getReader("/frame_" + std::to_string(frameid));
+    top.ReadFromCpt(r);
+  }
+  flock.unlock_sharable();
   std::cout << ". " << std::endl;
   return top;
 }
 
 bool StateSaver::TopStepisinFrames(Index frameid) const {
+  if (session_) {
+    return std::find(session_frames_.begin(), session_frames_.end(), frameid) !=
+           session_frames_.end();
+  }
   std::vector<Index> frames = this->getFrames();
   return std::find(frames.begin(), frames.end(), frameid) != frames.end();
 }
@@ -0,0 +1,196 @@
+/*
+ *            Copyright 2009-2021 The VOTCA Development Team
+ *                       (http://www.votca.org)
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License")
+ *
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *              http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Standard includes
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <tuple>
+
+// Local VOTCA includes
+#include "votca/xtp/tholeblockcache.h"
+
+namespace votca {
+namespace xtp {
+
+namespace {
+// column index and upper triangle of one block
+constexpr double bytes_per_block = sizeof(Index) + 6 * sizeof(double);
+// resolution of the distance histogram, which bounds the candidate list
+constexpr Index histogram_bins = 4096;
+}  // namespace
+
+TholeBlockCache::TholeBlockCache(const eeInteractor& interactor,
+                                 const std::vector<const PolarSite*>& sites,
+                                 double cutoff, double memory_mb) {
+  const Index nsites = Index(sites.size());
+  const Index all_pairs = nsites * (nsites - 1) / 2;
+  const Index max_pairs =
+      Index(memory_mb * 1e6 / bytes_per_block) / 2;  // both triangles
+
+  cutoff2_ = cutoff * cutoff;
+  // only pairs up to the bin in which the budget runs out are collected
+  double limit2 = cutoff2_;
+  if (all_pairs > max_pairs) {
+    limit2 = BudgetLimit(sites, cutoff2_, max_pairs);
+  }
+  std::vector<Candidate> pairs = CollectPairs(sites, limit2);
+  cutoff2_ = limit2;
+  if (Index(pairs.size()) > max_pairs) {
+    // the closest max_pairs pairs, ties at the new cutoff are left out
+    std::nth_element(pairs.begin(), pairs.begin() + max_pairs, pairs.end(),
+                     [](const Candidate& a, const Candidate& b) {
+                       return a.distance2 < b.distance2;
+                     });
+    cutoff2_ = pairs[max_pairs].distance2;
+    pairs.erase(std::remove_if(pairs.begin(), pairs.end(),
+                               [this](const Candidate& pair) {
+                                 return pair.distance2 >= cutoff2_;
+                               }),
+                pairs.end());
+  }
+  complete_ = (Index(pairs.size()) == all_pairs);
+  std::sort(pairs.begin(), pairs.end(),
+            [](const Candidate& a, const Candidate& b) {
+              return std::tie(a.site1, a.site2) < std::tie(b.site1, b.site2);
+            });
+
+  // every pair is stored in both rows, in the sorted order the columns of a
+  // row are ascending
+  row_begin_ = std::vector<Index>(nsites + 1, 0);
+  for (const Candidate& pair : pairs) {
+    row_begin_[pair.site1 + 1]++;
+    row_begin_[pair.site2 + 1]++;
+  }
+  for (Index i = 0; i < nsites; i++) {
+    row_begin_[i + 1] += row_begin_[i];
+  }
+  column_.resize(row_begin_.back());
+  blocks_.resize(6 * row_begin_.back());
+  std::vector<Index> next(row_begin_.begin(), row_begin_.end() - 1);
+  std::vector<std::array<Index, 2>> position(pairs.size());
+  for (std::size_t p = 0; p < pairs.size(); p++) {
+    position[p] = {next[pairs[p].site1]++, next[pairs[p].site2]++};
+    column_[position[p][0]] = pairs[p].site2;
+    column_[position[p][1]] = pairs[p].site1;
+  }
+
+#pragma omp parallel for schedule(dynamic, 256)
+  for (Index p = 0; p < Index(pairs.size()); p++) {
+    // the block is symmetric and the same for both orders of the sites
+    Eigen::Matrix3d block = interactor.FillTholeInteraction(
+        *sites[pairs[p].site1], *sites[pairs[p].site2]);
+    for (Index k : position[p]) {
+      double* b = &blocks_[6 * k];
+      b[0] = block(0, 0);
+      b[1] = block(0, 1);
+      b[2] = block(0, 2);
+      b[3] = block(1, 1);
+      b[4] = block(1, 2);
+      b[5] = block(2, 2);
+    }
+  }
+}
+
+double TholeBlockCache::BudgetLimit(const std::vector<const PolarSite*>& sites,
+                                    double cutoff2, Index max_pairs) const {
+  const Index nsites = Index(sites.size());
+  const double bin_width = cutoff2 / double(histogram_bins);
+  std::vector<Index> histogram(histogram_bins, 0);
+#pragma omp parallel
+  {
+    std::vector<Index> thread_histogram(histogram_bins, 0);
+#pragma omp for schedule(dynamic, 32)
+    for (Index i = 0; i < nsites; i++) {
+      const Eigen::Vector3d& pos = sites[i]->getPos();
+      for (Index j = i + 1; j < nsites; j++) {
+        double distance2 = (sites[j]->getPos() - pos).squaredNorm();
+        if (distance2 < cutoff2) {
+          thread_histogram[std::min(Index(distance2 / bin_width),
+                                    histogram_bins - 1)]++;
+        }
+      }
+    }
+#pragma omp critical
+    {
+      for (Index bin = 0; bin < histogram_bins; bin++) {
+        histogram[bin] += thread_histogram[bin];
+      }
+    }
+  }
+  Index count = 0;
+  for (Index bin = 0; bin < histogram_bins - 1; bin++) {
+    count += histogram[bin];
+    if (count > max_pairs) {
+      return double(bin + 1) * bin_width;
+    }
+  }
+  return cutoff2;
+}
+
+std::vector<TholeBlockCache::Candidate> TholeBlockCache::CollectPairs(
+    const std::vector<const PolarSite*>& sites, double cutoff2) const {
+  const Index nsites = Index(sites.size());
+  std::vector<Candidate> pairs;
+#pragma omp parallel
+  {
+    std::vector<Candidate> thread_pairs;
+#pragma omp for schedule(dynamic, 32)
+    for (Index i = 0; i < nsites; i++) {
+      const Eigen::Vector3d& pos = sites[i]->getPos();
+      for (Index j = i + 1; j < nsites; j++) {
+        double distance2 = (sites[j]->getPos() - pos).squaredNorm();
+        if (distance2 < cutoff2) {
+          thread_pairs.push_back({i, j, distance2});
+        }
+      }
+    }
+#pragma omp critical
+    { pairs.insert(pairs.end(), thread_pairs.begin(), thread_pairs.end()); }
+  }
+  return pairs;
+}
+
+double TholeBlockCache::MemoryMB() const {
+  return double(NumberOfBlocks()) * bytes_per_block * 1e-6;
+}
+
+void TholeBlockCache::Multiply(const Eigen::VectorXd& v,
+                               Eigen::VectorXd& result) const {
+  const Index nsites = NumberOfSites();
+#pragma omp parallel for schedule(dynamic, 64)
+  for (Index i = 0; i < nsites; i++) {
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+    for (Index k = row_begin_[i]; k < row_begin_[i + 1]; k++) {
+      const double* b = &blocks_[6 * k];
+      const double* vj = v.data() + 3 * column_[k];
+      x += b[0] * vj[0] + b[1] * vj[1] + b[2] * vj[2];
+      y += b[1] * vj[0] + b[3] * vj[1] + b[4] * vj[2];
+      z += b[2] * vj[0] + b[4] * vj[1] + b[5] * vj[2];
+    }
+    result(3 * i) += x;
+    result(3 * i + 1) += y;
+    result(3 * i + 2) += z;
+  }
+}
+
+}  // namespace xtp
+}  // namespace votca
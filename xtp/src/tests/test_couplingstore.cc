@@ -0,0 +1,86 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE couplingstore_test
+
+// Standard includes
+#include <fstream>
+#include <vector>
+
+// Third party includes
+#include <boost/test/unit_test.hpp>
+
+// Local VOTCA includes
+#include "votca/xtp/couplingstore.h"
+
+using namespace votca::xtp;
+using votca::Index;
+
+BOOST_AUTO_TEST_SUITE(couplingstore_test)
+
+CouplingStore::Coupling MakeCoupling(Index segA, Index segB, Index state,
+                                     double j) {
+  CouplingStore::Coupling coupling;
+  coupling.segA = segA;
+  coupling.segB = segB;
+  coupling.type = 1;
+  coupling.padding = 0;
+  coupling.stateA = state;
+  coupling.stateB = state + 1;
+  coupling.j = j;
+  return coupling;
+}
+
+BOOST_AUTO_TEST_CASE(append_and_read) {
+  std::string job_file = "couplingstore_jobs.xml";
+  CouplingStore store(job_file);
+  store.Remove();
+  BOOST_CHECK(!store.exists());
+
+  store.Append({});
+  BOOST_CHECK(!store.exists());
+
+  store.Append({MakeCoupling(0, 1, 0, 0.5), MakeCoupling(0, 1, 1, -0.25)});
+  // a second writer appends to the same file
+  CouplingStore(job_file).Append({MakeCoupling(2, 5, 0, 1e-3)});
+  BOOST_CHECK(store.exists());
+
+  std::vector<CouplingStore::Coupling> couplings = store.ReadAll();
+  BOOST_REQUIRE_EQUAL(couplings.size(), 3);
+  BOOST_CHECK_EQUAL(couplings[0].segA, 0);
+  BOOST_CHECK_EQUAL(couplings[0].segB, 1);
+  BOOST_CHECK_EQUAL(couplings[1].stateA, 1);
+  BOOST_CHECK_EQUAL(couplings[1].stateB, 2);
+  BOOST_CHECK_EQUAL(couplings[1].j, -0.25);
+  BOOST_CHECK_EQUAL(couplings[2].segA, 2);
+  BOOST_CHECK_EQUAL(couplings[2].segB, 5);
+  BOOST_CHECK_EQUAL(couplings[2].type, 1);
+  BOOST_CHECK_EQUAL(couplings[2].j, 1e-3);
+
+  // a partial record is not silently dropped
+  {
+    std::ofstream out(CouplingStore::StoreName(job_file),
+                      std::ios::out | std::ios::app | std::ios::binary);
+    out << "x";
+  }
+  BOOST_CHECK_THROW(store.ReadAll(), std::runtime_error);
+
+  store.Remove();
+  BOOST_CHECK(!store.exists());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -114,4 +114,195 @@ BOOST_AUTO_TEST_CASE(dipoledipoleinteraction_test) {
   }
 }
 
+// a cubic lattice of molecules with three sites each
+std::vector<PolarSegment> Lattice(Index n) {
+  std::vector<PolarSegment> segs;
+  Index id = 0;
+  for (Index x = 0; x < n; x++) {
+    for (Index y = 0; y < n; y++) {
+      for (Index z = 0; z < n; z++) {
+        PolarSegment seg("mol", id);
+        Eigen::Vector3d center(9.0 * double(x), 9.0 * double(y),
+                               9.0 * double(z));
+        seg.push_back(PolarSite(3 * id, "C", center));
+        seg.push_back(
+            PolarSite(3 * id + 1, "H", center + Eigen::Vector3d(2.0, 0, 0)));
+        seg.push_back(
+            PolarSite(3 * id + 2, "H", center + Eigen::Vector3d(0, 2.0, 0.5)));
+        segs.push_back(seg);
+        id++;
+      }
+    }
+  }
+  return segs;
+}
+
+Eigen::VectorXd TestDipoles(Index size) {
+  Eigen::VectorXd dipoles = Eigen::VectorXd::Zero(size);
+  for (Index i = 0; i < size; i++) {
+    dipoles(i) = std::sin(0.37 * double(i)) + 0.2;
+  }
+  return dipoles;
+}
+
+BOOST_AUTO_TEST_CASE(dipoledipoleinteraction_tiles) {
+  eeInteractor interactor(0.39);
+  // different numbers of tiles, also odd ones
+  for (Index nsegs : {1, 7, 15, 64, 125}) {
+    std::vector<PolarSegment> lattice = Lattice(5);
+    std::vector<PolarSegment> segs(lattice.begin(), lattice.begin() + nsegs);
+    DipoleDipoleInteraction dipdip(interactor, segs);
+    Eigen::VectorXd dipoles = TestDipoles(dipdip.rows());
+
+    const std::vector<const PolarSite*>& sites = dipdip.Sites();
+    Eigen::VectorXd ref = Eigen::VectorXd::Zero(dipdip.rows());
+    for (Index i = 0; i < Index(sites.size()); i++) {
+      ref.segment<3>(3 * i) += sites[i]->getPInv() * dipoles.segment<3>(3 * i);
+      for (Index j = 0; j < Index(sites.size()); j++) {
+        if (i != j) {
+          ref.segment<3>(3 * i) +=
+              interactor.FillTholeInteraction(*sites[i], *sites[j]) *
+              dipoles.segment<3>(3 * j);
+        }
+      }
+    }
+    BOOST_CHECK((dipdip * dipoles).isApprox(ref, 1e-12));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(dipoledipoleinteraction_tree) {
+  std::vector<PolarSegment> segs = Lattice(8);
+  eeInteractor interactor(0.39);
+  DipoleDipoleInteraction direct(interactor, segs);
+  DipoleDipoleInteraction tree(interactor, segs);
+  tree.UseTree(0.3);
+
+  Eigen::VectorXd dipoles = TestDipoles(direct.rows());
+  Eigen::VectorXd ref = direct * dipoles;
+  Eigen::VectorXd result = tree * dipoles;
+  double rel_error = (result - ref).norm() / ref.norm();
+  BOOST_CHECK_LT(rel_error, 5e-3);
+
+  // a finer tree is more accurate
+  DipoleDipoleInteraction fine(interactor, segs);
+  fine.UseTree(0.1);
+  Eigen::VectorXd fine_result = fine * dipoles;
+  double fine_error = (fine_result - ref).norm() / ref.norm();
+  BOOST_CHECK_LT(fine_error, 2e-4);
+  BOOST_CHECK_LT(fine_error, rel_error);
+
+  BOOST_CHECK_THROW(tree.UseTree(1.5), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(dipoledipoleinteraction_tree_damping) {
+  // a cube of sites close enough to the target to be a far field box if
+  // only the stiff sites were considered, but one very polarisable site is
+  // still damped
+  PolarSegment target("target", 0);
+  target.push_back(PolarSite(0, "C", Eigen::Vector3d::Zero()));
+  PolarSegment cube("cube", 1);
+  Index id = 1;
+  for (Index x = 0; x < 3; x++) {
+    for (Index y = 0; y < 3; y++) {
+      for (Index z = 0; z < 3; z++) {
+        Eigen::Vector3d pos =
+            Eigen::Vector3d(6.0, 0.0, 0.0) +
+            0.4 * Eigen::Vector3d(double(x - 1), double(y - 1), double(z - 1));
+        cube.push_back(PolarSite(id, "C", pos));
+        id++;
+      }
+    }
+  }
+  target[0].setpolarization(Eigen::Matrix3d::Identity());
+  for (PolarSite& site : cube) {
+    site.setpolarization(Eigen::Matrix3d::Identity());
+  }
+  Index soft = 13;
+  cube[soft].setpolarization(1e4 * Eigen::Matrix3d::Identity());
+  std::vector<PolarSegment> segs = {target, cube};
+
+  eeInteractor interactor(0.39);
+  DipoleDipoleInteraction direct(interactor, segs);
+  DipoleDipoleInteraction tree(interactor, segs);
+  tree.UseTree(0.3);
+  // only the polarisable site carries a dipole, its field at the target is
+  // well inside the Thole damping
+  Eigen::VectorXd dipoles = Eigen::VectorXd::Zero(direct.rows());
+  dipoles.segment<3>(3 * (soft + 1)) = Eigen::Vector3d(0.3, -1.0, 0.5);
+  Eigen::Vector3d ref = (direct * dipoles).segment<3>(0);
+  Eigen::Vector3d result = (tree * dipoles).segment<3>(0);
+  BOOST_CHECK(result.isApprox(ref, 1e-10));
+}
+
+BOOST_AUTO_TEST_CASE(dipoledipoleinteraction_tree_cg) {
+  std::vector<PolarSegment> segs = Lattice(8);
+  eeInteractor interactor(0.39);
+  DipoleDipoleInteraction direct(interactor, segs);
+  DipoleDipoleInteraction tree(interactor, segs);
+  tree.UseTree(0.3);
+
+  // the far field of every site is chosen on its own, the operator has to
+  // be symmetric nevertheless
+  Eigen::VectorXd x = TestDipoles(direct.rows());
+  Eigen::VectorXd y = Eigen::VectorXd::Zero(direct.rows());
+  for (Index i = 0; i < y.size(); i++) {
+    y(i) = std::cos(0.11 * double(i) * double(i));
+  }
+  double xAy = x.dot(tree * y);
+  double yAx = y.dot(tree * x);
+  BOOST_CHECK_LT(std::abs(xAy - yAx), 1e-10 * std::abs(xAy));
+
+  // same solver as PolarRegion::CalcInducedDipolesViaPCG
+  using CG = Eigen::ConjugateGradient<DipoleDipoleInteraction,
+                                      Eigen::Lower | Eigen::Upper,
+                                      Eigen::DiagonalPreconditioner<double>>;
+  Eigen::VectorXd b = TestDipoles(direct.rows());
+  CG cg_direct;
+  cg_direct.setMaxIterations(100);
+  cg_direct.setTolerance(1e-8);
+  cg_direct.compute(direct);
+  Eigen::VectorXd ref = cg_direct.solve(b);
+  BOOST_CHECK(cg_direct.info() == Eigen::ComputationInfo::Success);
+
+  CG cg_tree;
+  cg_tree.setMaxIterations(100);
+  cg_tree.setTolerance(1e-8);
+  cg_tree.compute(tree);
+  Eigen::VectorXd result = cg_tree.solve(b);
+  BOOST_CHECK(cg_tree.info() == Eigen::ComputationInfo::Success);
+  BOOST_CHECK_LE(cg_tree.iterations(), cg_direct.iterations() + 2);
+  BOOST_CHECK_LT((result - ref).norm() / ref.norm(), 5e-3);
+}
+
+BOOST_AUTO_TEST_CASE(dipoledipoleinteraction_cache) {
+  std::vector<PolarSegment> segs = Lattice(4);
+  eeInteractor interactor(0.39);
+  DipoleDipoleInteraction direct(interactor, segs);
+  Eigen::VectorXd dipoles = TestDipoles(direct.rows());
+  Eigen::VectorXd ref = direct * dipoles;
+
+  // every pair fits
+  TholeBlockCache all(interactor, direct.Sites(), 1000.0, 100.0);
+  BOOST_CHECK(all.isComplete());
+  Index nsites = Index(direct.Sites().size());
+  BOOST_CHECK_EQUAL(all.NumberOfBlocks(), nsites * (nsites - 1));
+  DipoleDipoleInteraction cached(interactor, segs);
+  cached.UseBlockCache(all);
+  BOOST_CHECK((cached * dipoles).isApprox(ref, 1e-12));
+
+  // only the closest pairs fit, the others are computed on the fly
+  TholeBlockCache part(interactor, direct.Sites(), 1000.0, 0.5);
+  BOOST_CHECK(!part.isComplete());
+  BOOST_CHECK_LE(part.MemoryMB(), 0.5);
+  BOOST_CHECK_GT(part.NumberOfBlocks(), 0);
+  BOOST_CHECK_LT(part.Cutoff(), 1000.0);
+  DipoleDipoleInteraction partly_cached(interactor, segs);
+  partly_cached.UseBlockCache(part);
+  BOOST_CHECK((partly_cached * dipoles).isApprox(ref, 1e-12));
+
+  std::vector<PolarSegment> other = Lattice(2);
+  DipoleDipoleInteraction wrong(interactor, other);
+  BOOST_CHECK_THROW(wrong.UseBlockCache(part), std::runtime_error);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
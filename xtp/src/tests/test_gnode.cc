@@ -18,10 +18,6 @@
 #define BOOST_TEST_MODULE gnode_test
 
 // Standard includes
-#include <cstdio>
-#include <cstdlib>
-#include <ctime>
-#include <iostream>
 #include <vector>
 
 // Third party includes
@@ -36,7 +32,7 @@ using namespace votca::xtp;
 using namespace votca;
 BOOST_AUTO_TEST_SUITE(gnode_test)
 
-BOOST_AUTO_TEST_CASE(chosen_id_test) {
+BOOST_AUTO_TEST_CASE(events_test) {
 
   QMStateType electron = QMStateType::Electron;
 
@@ -46,73 +42,30 @@ BOOST_AUTO_TEST_CASE(chosen_id_test) {
     dests.push_back(GNode(seg, electron, true));
   }
   Segment seg("one", 6);
-  GNode g(seg, electron, true);
+  GNode g(seg, electron, false);
+  BOOST_CHECK(!g.isInjectable());
+  BOOST_CHECK_EQUAL(g.getId(), 6);
   g.AddEvent(&dests[0], Eigen::Vector3d::Zero(), 10);
-  g.AddEvent(&dests[1], Eigen::Vector3d::Zero(), 20);
+  g.AddEvent(&dests[1], Eigen::Vector3d::UnitX(), 20);
   g.AddEvent(&dests[2], Eigen::Vector3d::Zero(), 15);
   g.AddEvent(&dests[3], Eigen::Vector3d::Zero(), 18);
   g.AddEvent(&dests[4], Eigen::Vector3d::Zero(), 12);
   g.AddEvent(&dests[5], Eigen::Vector3d::Zero(), 25);
+  BOOST_CHECK(!g.canDecay());
+  g.AddDecayEvent(50);
+  BOOST_CHECK(g.canDecay());
   g.InitEscapeRate();
-  g.MakeHuffTree();
-  BOOST_CHECK_EQUAL(g.findHoppingDestination(0.55)->getDestination()->getId(),
-                    0);
-  BOOST_CHECK_EQUAL(g.findHoppingDestination(0.85)->getDestination()->getId(),
-                    1);
-  BOOST_CHECK_EQUAL(g.findHoppingDestination(0.25)->getDestination()->getId(),
-                    2);
-  BOOST_CHECK_EQUAL(g.findHoppingDestination(0.15)->getDestination()->getId(),
-                    3);
-  BOOST_CHECK_EQUAL(g.findHoppingDestination(0.35)->getDestination()->getId(),
-                    4);
-  BOOST_CHECK_EQUAL(g.findHoppingDestination(0.65)->getDestination()->getId(),
-                    5);
-}
-
-BOOST_AUTO_TEST_CASE(count_test) {
-  QMStateType electron = QMStateType::Electron;
-
-  std::vector<GNode> dests;
-  for (Index i = 0; i < 11; i++) {
-    Segment seg("one", i);
-    dests.push_back(GNode(seg, electron, true));
-  }
-  Segment seg("one", 12);
-  GNode g(seg, electron, true);
-
-  g.AddEvent(&dests[0], Eigen::Vector3d::Zero(), 15);
-  g.AddEvent(&dests[1], Eigen::Vector3d::Zero(), 9);
-  g.AddEvent(&dests[2], Eigen::Vector3d::Zero(), 11);
-  g.AddEvent(&dests[3], Eigen::Vector3d::Zero(), 8);
-  g.AddEvent(&dests[4], Eigen::Vector3d::Zero(), 12);
-  g.AddEvent(&dests[5], Eigen::Vector3d::Zero(), 7);
-  g.AddEvent(&dests[6], Eigen::Vector3d::Zero(), 13);
-  g.AddEvent(&dests[7], Eigen::Vector3d::Zero(), 6);
-  g.AddEvent(&dests[8], Eigen::Vector3d::Zero(), 14);
-  g.AddEvent(&dests[9], Eigen::Vector3d::Zero(), 5);
-  g.AddEvent(&dests[10], Eigen::Vector3d::Zero(), 100);
+  BOOST_CHECK_CLOSE(g.getEscapeRate(), 150.0, 1e-12);
 
-  g.InitEscapeRate();
-  g.MakeHuffTree();
-  std::vector<Index> count(11, 0);
-  double d = 0;
-  while (d < 1) {
-    GLink* L = g.findHoppingDestination(d);
-    Index ind = L->getDestination()->getId();
-    count[ind]++;
-    d += 0.000001;
+  const std::vector<GLink>& events = g.Events();
+  BOOST_REQUIRE_EQUAL(events.size(), 7);
+  for (Index i = 0; i < 6; i++) {
+    BOOST_CHECK_EQUAL(events[i].getDestination()->getId(), i);
+    BOOST_CHECK(!events[i].isDecayEvent());
   }
-
-  BOOST_CHECK_EQUAL(count[0], 75000);
-  BOOST_CHECK_EQUAL(count[1], 45000);
-  BOOST_CHECK_EQUAL(count[2], 55000);
-  BOOST_CHECK_EQUAL(count[3], 40000);
-  BOOST_CHECK_EQUAL(count[4], 60000);
-  BOOST_CHECK_EQUAL(count[5], 35000);
-  BOOST_CHECK_EQUAL(count[6], 65000);
-  BOOST_CHECK_EQUAL(count[7], 30000);
-  BOOST_CHECK_EQUAL(count[8], 70000);
-  BOOST_CHECK_EQUAL(count[9], 25001);
-  BOOST_CHECK_EQUAL(count[10], 499999);
+  BOOST_CHECK_CLOSE(events[1].getRate(), 20.0, 1e-12);
+  BOOST_CHECK(events[1].getDeltaR().isApprox(Eigen::Vector3d::UnitX()));
+  BOOST_CHECK(events[6].isDecayEvent());
 }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE jobstore_test
+
+// Standard includes
+#include <map>
+#include <vector>
+
+// Third party includes
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+// Local VOTCA includes
+#include "votca/xtp/jobstore.h"
+
+using namespace votca::xtp;
+using votca::Index;
+
+BOOST_AUTO_TEST_SUITE(jobstore_test)
+
+std::vector<Job> CreateJobs(Index njobs) {
+  std::vector<Job> jobs;
+  for (Index i = 0; i < njobs; i++) {
+    votca::tools::Property input;
+    input.add("input", "").add("segment", std::to_string(i));
+    jobs.push_back(Job(i + 1, "seg", input, Job::AVAILABLE));
+  }
+  return jobs;
+}
+
+BOOST_AUTO_TEST_CASE(claim_and_complete) {
+  std::string job_file = "jobstore_jobs.xml";
+  std::vector<Job> jobs = CreateJobs(5);
+  WRITE_JOBS(jobs, job_file);
+
+  JobStore store;
+  BOOST_CHECK(store.Open(job_file, LOAD_JOBS(job_file)));
+  BOOST_CHECK_EQUAL(store.size(), 5);
+  BOOST_CHECK_EQUAL(store.Cursor(), 0);
+
+  // a second process joins the same store
+  std::vector<Job> other_jobs = LOAD_JOBS(job_file);
+  JobStore other;
+  BOOST_CHECK(!other.Open(job_file, other_jobs));
+
+  jobs[1].setStatus(Job::ASSIGNED);
+  jobs[1].setHost("node1:42");
+  store.WriteStatus(1, jobs[1]);
+  store.AdvanceCursor(2);
+  other.Read(1, other_jobs[1]);
+  BOOST_CHECK(other_jobs[1].isAssigned());
+  BOOST_CHECK_EQUAL(other_jobs[1].getHost(), "node1:42");
+  BOOST_CHECK_EQUAL(other.Cursor(), 2);
+  other.AdvanceCursor(1);
+  BOOST_CHECK_EQUAL(store.Cursor(), 2);
+
+  Job::JobResult result;
+  result.setStatus(Job::COMPLETE);
+  result.setOutput("done");
+  jobs[1].UpdateFromResult(result);
+  store.WriteResult(1, jobs[1]);
+
+  // export as it is done at the end of a run
+  std::vector<Job> exported = LOAD_JOBS(job_file);
+  other.ReadAll(exported);
+  BOOST_CHECK(exported[0].isAvailable());
+  BOOST_CHECK(exported[1].isComplete());
+  BOOST_CHECK(exported[1].hasOutput());
+  BOOST_CHECK_EQUAL(exported[1].getOutput().as<std::string>(), "done");
+  WRITE_JOBS(exported, job_file);
+  other.JobFileWritten();
+
+  std::map<Index, Job::JobStatus> status = JobStore::ReadStatus(job_file);
+  BOOST_CHECK_EQUAL(status.size(), 5);
+  BOOST_CHECK_EQUAL(status[1], Job::AVAILABLE);
+  BOOST_CHECK_EQUAL(status[2], Job::COMPLETE);
+
+  JobStore reopened;
+  BOOST_CHECK(!reopened.Open(job_file, LOAD_JOBS(job_file)));
+
+  // a job file changed by someone else starts a new store
+  boost::filesystem::last_write_time(
+      job_file, boost::filesystem::last_write_time(job_file) + 10);
+  std::vector<Job> imported = LOAD_JOBS(job_file);
+  BOOST_CHECK(JobStore::ReadStatus(job_file).empty());
+  JobStore renewed;
+  BOOST_CHECK(renewed.Open(job_file, imported));
+  BOOST_CHECK_EQUAL(renewed.Cursor(), 0);
+  renewed.Read(1, imported[1]);
+  BOOST_CHECK(imported[1].isComplete());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
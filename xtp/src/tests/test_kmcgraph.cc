@@ -0,0 +1,80 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE kmcgraph_test
+
+// Standard includes
+#include <vector>
+
+// Third party includes
+#include <boost/test/unit_test.hpp>
+
+// Local VOTCA includes
+#include "votca/xtp/kmcgraph.h"
+
+using namespace votca::xtp;
+using votca::Index;
+
+BOOST_AUTO_TEST_SUITE(kmcgraph_test)
+
+BOOST_AUTO_TEST_CASE(layout_and_sampling) {
+  QMStateType electron = QMStateType::Electron;
+
+  std::vector<GNode> nodes;
+  for (Index i = 0; i < 7; i++) {
+    Segment seg("one", i);
+    nodes.push_back(GNode(seg, electron, i != 3));
+  }
+  std::vector<double> rates = {10, 20, 15, 18, 12, 25};
+  for (Index i = 0; i < 6; i++) {
+    nodes[6].AddEvent(&nodes[i], Eigen::Vector3d::UnitX() * double(i),
+                      rates[i]);
+  }
+  nodes[6].AddDecayEvent(50);
+  nodes[0].AddEvent(&nodes[6], Eigen::Vector3d::UnitY(), 3);
+
+  KMCGraph graph(nodes);
+  BOOST_CHECK_EQUAL(graph.size(), 7);
+  BOOST_CHECK(!graph.isInjectable(3));
+  BOOST_CHECK_EQUAL(graph.EventsEnd(0) - graph.EventsBegin(0), 1);
+  BOOST_CHECK_EQUAL(graph.EventsBegin(1), graph.EventsEnd(1));
+  BOOST_CHECK_EQUAL(graph.Destination(graph.EventsBegin(0)), 6);
+  BOOST_CHECK_CLOSE(graph.EscapeRate(6), 150.0, 1e-12);
+
+  Index begin = graph.EventsBegin(6);
+  BOOST_CHECK_EQUAL(graph.EventsEnd(6) - begin, 7);
+  BOOST_CHECK_EQUAL(graph.Destination(begin + 4), 4);
+  BOOST_CHECK(graph.DeltaR(begin + 4).isApprox(4 * Eigen::Vector3d::UnitX()));
+  BOOST_CHECK(graph.isDecayEvent(begin + 6));
+
+  // a fine grid over u samples every event with its probability
+  Index nsamples = 150000;
+  std::vector<double> counts(7, 0.0);
+  for (Index k = 0; k < nsamples; k++) {
+    double u = (double(k) + 0.5) / double(nsamples);
+    Index event = graph.SampleEvent(6, u);
+    BOOST_REQUIRE(event >= begin && event < graph.EventsEnd(6));
+    counts[event - begin] += 1.0;
+  }
+  for (Index i = 0; i < 7; i++) {
+    double expected = graph.Rate(begin + i) / graph.EscapeRate(6);
+    BOOST_CHECK_CLOSE(counts[i] / double(nsamples), expected, 0.1);
+  }
+  BOOST_CHECK_EQUAL(graph.SampleEvent(0, 0.999999), graph.EventsBegin(0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE kmcreplica_test
+
+// Standard includes
+#include <vector>
+
+// Third party includes
+#include <boost/test/unit_test.hpp>
+
+// Local VOTCA includes
+#include "votca/xtp/kmcreplica.h"
+
+using namespace votca::xtp;
+using votca::Index;
+
+BOOST_AUTO_TEST_SUITE(kmcreplica_test)
+
+BOOST_AUTO_TEST_CASE(shared_graph) {
+  QMStateType electron = QMStateType::Electron;
+
+  std::vector<GNode> nodes;
+  for (Index i = 0; i < 3; i++) {
+    Segment seg("one", i);
+    nodes.push_back(GNode(seg, electron, true));
+  }
+  Eigen::Vector3d dr = Eigen::Vector3d::UnitX();
+  nodes[0].AddEvent(&nodes[1], dr, 10);
+  nodes[1].AddEvent(&nodes[2], dr, 20);
+  nodes[1].AddEvent(&nodes[0], -dr, 5);
+  nodes[2].AddEvent(&nodes[1], -dr, 40);
+  KMCGraph graph(nodes);
+
+  KMCReplica first(0, 1, graph);
+  KMCReplica second(1, 2, graph);
+  first.Carriers().push_back(Chargecarrier(0));
+  first.PlaceCarrier(first.Carriers()[0], 0);
+  first.InitEscapeRates();
+  second.Carriers().push_back(Chargecarrier(0));
+  second.PlaceCarrier(second.Carriers()[0], 2);
+  second.InitEscapeRates();
+
+  BOOST_CHECK(first.isOccupied(0));
+  BOOST_CHECK(!second.isOccupied(0));
+  BOOST_CHECK_CLOSE(first.TotalEscapeRate(), 10.0, 1e-12);
+  BOOST_CHECK_CLOSE(second.TotalEscapeRate(), 40.0, 1e-12);
+
+  first.Advance(0.5);
+  first.UpdateOccupationTime(0.5);
+  first.JumpCarrier(first.Carriers()[0], graph.EventsBegin(0));
+  BOOST_CHECK(!first.isOccupied(0));
+  BOOST_CHECK(first.isOccupied(1));
+  BOOST_CHECK_CLOSE(first.TotalEscapeRate(), 25.0, 1e-12);
+  BOOST_CHECK(first.Carriers()[0].get_dRtravelled().isApprox(dr, 1e-12));
+  BOOST_CHECK_EQUAL(first.Steps(), 1);
+  BOOST_CHECK_CLOSE(first.OccupationTime(0), 0.5, 1e-12);
+
+  // the other replica is untouched
+  BOOST_CHECK(second.isOccupied(2));
+  BOOST_CHECK(!second.isOccupied(1));
+  BOOST_CHECK_EQUAL(second.OccupationTime(0), 0.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE neighborlist_test
+
+// Standard includes
+#include <memory>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+// Third party includes
+#include <boost/test/unit_test.hpp>
+
+// VOTCA includes
+#include <votca/tools/constants.h>
+
+// Local VOTCA includes
+#include "votca/xtp/calculatorfactory.h"
+#include "votca/xtp/segmentcells.h"
+#include "votca/xtp/topology.h"
+
+using namespace votca::xtp;
+using votca::Index;
+
+BOOST_AUTO_TEST_SUITE(neighborlist_test)
+
+using PairSet = std::set<std::pair<Index, Index>>;
+
+// single atom segments at random positions in the box
+Topology RandomTopology(const Eigen::Matrix3d& box, Index nsegs) {
+  Topology top;
+  top.setBox(box);
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+  for (Index i = 0; i < nsegs; i++) {
+    Eigen::Vector3d frac(dist(gen), dist(gen), dist(gen));
+    Segment& seg = top.AddSegment("A");
+    seg.push_back(Atom(i, "C", box * frac));
+  }
+  return top;
+}
+
+PairSet BruteForcePairs(const Topology& top, double range) {
+  PairSet pairs;
+  const std::vector<Segment>& segs = top.Segments();
+  for (Index i = 0; i < Index(segs.size()); i++) {
+    for (Index j = i + 1; j < Index(segs.size()); j++) {
+      if (top.PbShortestConnect(segs[i].getPos(), segs[j].getPos()).norm() <
+          range) {
+        pairs.insert({i, j});
+      }
+    }
+  }
+  return pairs;
+}
+
+PairSet CellPairs(Topology& top, double range) {
+  std::vector<Segment*> segs;
+  for (Segment& seg : top.Segments()) {
+    segs.push_back(&seg);
+  }
+  SegmentCells cells(top.getBox(), segs, range);
+  PairSet pairs;
+  for (Index i = 0; i < Index(segs.size()); i++) {
+    for (Index cell : cells.Neighbours(cells.CellOf(i))) {
+      for (Index j : cells.Segments(cell)) {
+        if (j > i &&
+            top.PbShortestConnect(segs[i]->getPos(), segs[j]->getPos()).norm() <
+                range) {
+          pairs.insert({i, j});
+        }
+      }
+    }
+  }
+  return pairs;
+}
+
+BOOST_AUTO_TEST_CASE(cells_orthorhombic) {
+  Eigen::Matrix3d box = Eigen::Vector3d(40, 50, 60).asDiagonal();
+  Topology top = RandomTopology(box, 400);
+  double range = 9.0;
+  PairSet ref = BruteForcePairs(top, range);
+  BOOST_CHECK(!ref.empty());
+  BOOST_CHECK(CellPairs(top, range) == ref);
+}
+
+BOOST_AUTO_TEST_CASE(cells_triclinic) {
+  Eigen::Matrix3d box;
+  box << 40, 12, -8, 0, 45, 10, 0, 0, 50;
+  Topology top = RandomTopology(box, 400);
+  double range = 9.0;
+  PairSet ref = BruteForcePairs(top, range);
+  BOOST_CHECK(!ref.empty());
+  BOOST_CHECK(CellPairs(top, range) == ref);
+}
+
+BOOST_AUTO_TEST_CASE(cells_few_cells) {
+  // with two cells in a direction the cells below and above coincide
+  Eigen::Matrix3d box = Eigen::Vector3d(20, 20, 35).asDiagonal();
+  Topology top = RandomTopology(box, 100);
+  for (double range : {9.0, 9.9}) {
+    std::vector<Segment*> segs;
+    for (Segment& seg : top.Segments()) {
+      segs.push_back(&seg);
+    }
+    SegmentCells cells(box, segs, range);
+    BOOST_CHECK_EQUAL(cells.NumberOfCells(0), 2);
+    BOOST_CHECK_EQUAL(cells.NumberOfCells(2), 3);
+    BOOST_CHECK(CellPairs(top, range) == BruteForcePairs(top, range));
+  }
+  Eigen::Matrix3d small = Eigen::Vector3d(12, 12, 12).asDiagonal();
+  Topology smalltop = RandomTopology(small, 30);
+  std::vector<Segment*> segs;
+  for (Segment& seg : smalltop.Segments()) {
+    segs.push_back(&seg);
+  }
+  SegmentCells cells(small, segs, 5.5);
+  BOOST_CHECK_EQUAL(cells.NumberOfCells(0), 2);
+  BOOST_CHECK_EQUAL(cells.Neighbours(0).size(), 8);
+  BOOST_CHECK(CellPairs(smalltop, 5.5) == BruteForcePairs(smalltop, 5.5));
+}
+
+BOOST_AUTO_TEST_CASE(evaluate) {
+  Calculatorfactory::RegisterAll();
+  Eigen::Matrix3d box;
+  box << 40, 12, -8, 0, 45, 10, 0, 0, 50;
+  double cutoff = 0.5;  // nm
+  PairSet ref;
+  std::vector<std::vector<std::pair<Index, Index>>> lists;
+  for (Index nthreads : {1, 4}) {
+    Topology top = RandomTopology(box, 400);
+    ref = BruteForcePairs(top, cutoff * votca::tools::conv::nm2bohr);
+    std::unique_ptr<QMCalculator> nblist = Calculators().Create("neighborlist");
+    votca::tools::Property options;
+    options.add("constant", std::to_string(cutoff));
+    nblist->setnThreads(nthreads);
+    nblist->Initialize(options);
+    nblist->EvaluateFrame(top);
+
+    std::vector<std::pair<Index, Index>> pairs;
+    for (Index i = 0; i < top.NBList().size(); i++) {
+      const QMPair* pair = top.NBList()[i];
+      BOOST_CHECK_EQUAL(pair->getId(), i);
+      pairs.push_back({pair->Seg1()->getId(), pair->Seg2()->getId()});
+    }
+    BOOST_CHECK(PairSet(pairs.begin(), pairs.end()) == ref);
+    lists.push_back(pairs);
+  }
+  BOOST_CHECK(!ref.empty());
+  // the pair ids do not depend on the number of threads
+  BOOST_CHECK(lists[0] == lists[1]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE ratetree_test
+
+// Standard includes
+#include <vector>
+
+// Third party includes
+#include <boost/test/unit_test.hpp>
+
+// Local VOTCA includes
+#include "votca/xtp/ratetree.h"
+
+using namespace votca::xtp;
+using votca::Index;
+
+BOOST_AUTO_TEST_SUITE(ratetree_test)
+
+// the linear search the tree replaces
+Index LinearFind(const std::vector<double>& rates, double u) {
+  double total = 0.0;
+  for (double rate : rates) {
+    total += rate;
+  }
+  for (Index i = 0; i < Index(rates.size()); i++) {
+    u -= rates[i] / total;
+    if (u <= 0) {
+      return i;
+    }
+  }
+  return Index(rates.size()) - 1;
+}
+
+BOOST_AUTO_TEST_CASE(find_and_update) {
+  std::vector<double> rates = {1.0, 0.0, 3.0, 2.0, 0.5, 4.0, 1.5};
+  RateTree tree;
+  tree.Initialize(rates);
+  BOOST_CHECK_CLOSE(tree.TotalRate(), 12.0, 1e-12);
+  BOOST_CHECK_CLOSE(tree.PartialSum(3), 4.0, 1e-12);
+
+  for (Index step = 1; step <= 100; step++) {
+    double u = double(step) / 100.0 - 0.003;
+    BOOST_CHECK_EQUAL(tree.Find(u), LinearFind(rates, u));
+  }
+  BOOST_CHECK_EQUAL(tree.Find(1.0), 6);
+
+  // more updates than events, so the tree is rebuilt in between
+  for (Index i = 0; i < 20; i++) {
+    Index event = (3 * i) % Index(rates.size());
+    rates[event] = 0.25 * double(i % 5);
+    tree.setRate(event, rates[event]);
+    double total = 0.0;
+    for (double rate : rates) {
+      total += rate;
+    }
+    BOOST_CHECK_CLOSE(tree.TotalRate(), total, 1e-10);
+    for (Index step = 1; step <= 20; step++) {
+      double u = double(step) / 20.0 - 0.01;
+      BOOST_CHECK_EQUAL(tree.Find(u), LinearFind(rates, u));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(single_event) {
+  RateTree tree;
+  tree.Initialize({2.0});
+  BOOST_CHECK_EQUAL(tree.Find(0.5), 0);
+  tree.setRate(0, 5.0);
+  BOOST_CHECK_CLOSE(tree.TotalRate(), 5.0, 1e-12);
+  BOOST_CHECK_THROW(tree.setRate(1, 1.0), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2009-2021 The VOTCA Development Team (http://www.votca.org)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE statesaver_test
+
+// Standard includes
+#include <vector>
+
+// Third party includes
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+// Local VOTCA includes
+#include "votca/xtp/statesaver.h"
+
+using namespace votca::xtp;
+using votca::Index;
+
+BOOST_AUTO_TEST_SUITE(statesaver_test)
+
+Topology CreateTopology(Index step) {
+  Topology top;
+  top.setStep(step);
+  top.setTime(0.5 * double(step));
+  top.setBox(10 * Eigen::Matrix3d::Identity());
+  Segment& seg = top.AddSegment("seg");
+  seg.push_back(Atom(0, "C", Eigen::Vector3d(1.0, 2.0, double(step))));
+  return top;
+}
+
+BOOST_AUTO_TEST_CASE(missing_file) {
+  std::string state_file = "statesaver_missing.hdf5";
+  boost::filesystem::remove(state_file);
+
+  StateSaver statsav(state_file);
+  BOOST_CHECK_THROW(statsav.BeginSession(CheckpointAccessLevel::MODIFY),
+                    std::runtime_error);
+  BOOST_CHECK_THROW(statsav.BeginSession(CheckpointAccessLevel::READ),
+                    std::runtime_error);
+  BOOST_CHECK(!statsav.hasSession());
+  // a failed session must not leave a state file behind
+  BOOST_CHECK(!boost::filesystem::exists(state_file));
+}
+
+BOOST_AUTO_TEST_CASE(create_modify_read) {
+  std::string state_file = "statesaver_session.hdf5";
+  boost::filesystem::remove(state_file);
+
+  StateSaver statsav(state_file);
+  statsav.BeginSession(CheckpointAccessLevel::CREATE);
+  BOOST_CHECK(statsav.hasSession());
+  BOOST_CHECK_THROW(statsav.BeginSession(CheckpointAccessLevel::READ),
+                    std::runtime_error);
+  statsav.WriteFrame(CreateTopology(3));
+  statsav.WriteFrame(CreateTopology(7));
+  // the frame index is only kept in memory until the session ends
+  BOOST_CHECK_EQUAL(statsav.getFrames().size(), 2);
+  BOOST_CHECK_EQUAL(statsav.ReadFrame(7).getStep(), 7);
+  statsav.EndSession();
+  BOOST_CHECK(!statsav.hasSession());
+
+  StateSaver other(state_file);
+  std::vector<Index> frames = other.getFrames();
+  BOOST_REQUIRE_EQUAL(frames.size(), 2);
+  BOOST_CHECK_EQUAL(frames[0], 3);
+  BOOST_CHECK_EQUAL(frames[1], 7);
+
+  // modify an existing frame and add a new one
+  other.BeginSession(CheckpointAccessLevel::MODIFY);
+  Topology top = other.ReadFrame(3);
+  top.setTime(42.0);
+  other.WriteFrame(top);
+  other.WriteFrame(CreateTopology(9));
+  other.EndSession();
+
+  // several readers may share the file
+  StateSaver reader1(state_file);
+  StateSaver reader2(state_file);
+  reader1.BeginSession(CheckpointAccessLevel::READ);
+  reader2.BeginSession(CheckpointAccessLevel::READ);
+  BOOST_CHECK_EQUAL(reader1.getFrames().size(), 3);
+  BOOST_CHECK_EQUAL(reader2.getFrames().size(), 3);
+  Topology read = reader1.ReadFrame(3);
+  BOOST_CHECK_CLOSE(read.getTime(), 42.0, 1e-9);
+  BOOST_CHECK_EQUAL(read.Segments().size(), 1);
+  BOOST_CHECK_CLOSE(reader2.ReadFrame(9).getSegment(0)[0].getPos().z(), 9.0,
+                    1e-9);
+  BOOST_CHECK_THROW(reader1.ReadFrame(5), std::runtime_error);
+  BOOST_CHECK_THROW(reader1.WriteFrame(CreateTopology(5)), std::runtime_error);
+  reader1.EndSession();
+  reader2.EndSession();
+
+  // without a session every call opens the file on its own
+  StateSaver single(state_file);
+  single.WriteFrame(CreateTopology(11));
+  BOOST_CHECK_EQUAL(single.getFrames().size(), 4);
+  BOOST_CHECK_EQUAL(single.ReadFrame(11).getStep(), 11);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -28,6 +28,7 @@
 #include "votca/xtp/vxc_grid.h"
 #include <libint2/initialize.h>
 using namespace votca::xtp;
+using namespace votca;
 using namespace std;
 
 BOOST_AUTO_TEST_SUITE(vxc_grid_test)
@@ -59,4 +60,33 @@ BOOST_AUTO_TEST_CASE(vxc_grid_build) {
   libint2::finalize();
 }
 
+BOOST_AUTO_TEST_CASE(ao_values_on_grid) {
+  libint2::initialize();
+  QMMolecule mol("none", 0);
+
+  mol.LoadFromFile(std::string(XTP_TEST_DATA_FOLDER) +
+                   "/vxc_grid/molecule.xyz");
+  AOBasis aobasis = CreateBasis(mol);
+
+  Vxc_Grid grid;
+  grid.GridSetup("medium", mol, aobasis);
+
+  for (Index i = 0; i < grid.getBoxesSize(); i++) {
+    const GridBox& box = grid[i];
+    GridBox::AOValuesOnGrid ao = box.CalcAOValuesOnGrid();
+    BOOST_REQUIRE_EQUAL(ao.values.rows(), box.size());
+    BOOST_REQUIRE_EQUAL(ao.values.cols(), box.Matrixsize());
+    for (Index p = 0; p < box.size(); p++) {
+      AOShell::AOValues ref = box.CalcAOValues(box.getGridPoints()[p]);
+      BOOST_CHECK(ao.values.row(p).transpose().isApprox(ref.values, 1e-12));
+      for (Index k = 0; k < 3; k++) {
+        BOOST_CHECK(ao.derivatives[k].row(p).transpose().isApprox(
+            ref.derivatives.col(k), 1e-12));
+      }
+    }
+  }
+
+  libint2::finalize();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
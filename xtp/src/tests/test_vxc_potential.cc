@@ -88,4 +88,39 @@ BOOST_AUTO_TEST_CASE(vxc_test) {
   libint2::finalize();
 }
 
+BOOST_AUTO_TEST_CASE(vxc_ao_cache) {
+  libint2::initialize();
+  QMMolecule mol("none", 0);
+
+  mol.LoadFromFile(std::string(XTP_TEST_DATA_FOLDER) +
+                   "/vxc_potential/molecule.xyz");
+  AOBasis aobasis = CreateBasis(mol);
+
+  Eigen::MatrixXd dmat = DMat();
+  Vxc_Grid grid;
+  grid.GridSetup("medium", mol, aobasis);
+  Vxc_Potential<Vxc_Grid> num(grid);
+  num.setXCfunctional("XC_GGA_X_PBE XC_GGA_C_PBE");
+  Mat_p_Energy ref = num.IntegrateVXC(dmat);
+
+  // only part of the boxes fit
+  num.SetupAOCache(5, false);
+  BOOST_CHECK(num.CachedBoxes() > 0);
+  BOOST_CHECK(num.CachedBoxes() < grid.getBoxesSize());
+  BOOST_CHECK(num.AOCacheMB() <= 5);
+  for (int iter = 0; iter < 2; iter++) {
+    Mat_p_Energy cached = num.IntegrateVXC(dmat);
+    BOOST_CHECK_CLOSE(cached.energy(), ref.energy(), 1e-10);
+    BOOST_CHECK(cached.matrix().isApprox(ref.matrix(), 1e-10));
+  }
+
+  num.SetupAOCache(1000, true);
+  BOOST_CHECK_EQUAL(num.CachedBoxes(), grid.getBoxesSize());
+  Mat_p_Energy single = num.IntegrateVXC(dmat);
+  BOOST_CHECK_CLOSE(single.energy(), ref.energy(), 1e-4);
+  BOOST_CHECK(single.matrix().isApprox(ref.matrix(), 1e-5));
+
+  libint2::finalize();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
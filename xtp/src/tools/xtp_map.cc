@@ -280,6 +280,8 @@ void XtpMap::Run() {
   }
 
   XTP::StateSaver statsav(statefile);
+  // keeps the file open and writes the frame index once
+  statsav.BeginSession(XTP::CheckpointAccessLevel::CREATE);
   votca::Index laststep =
       -1;  // for some formats no step is given out so we check if the step
   for (votca::Index saved = 0; hasFrame && saved < nFrames;
@@ -291,6 +293,7 @@ void XtpMap::Run() {
     XTP::Topology qmtopol = md2qm.map(mdtopol);
     statsav.WriteFrame(qmtopol);
   }
+  statsav.EndSession();
 }
 
 void XtpMap::ShowHelpText(std::ostream& out) {